@@ -14,6 +14,9 @@ enum VmafLogLevel {
 enum VmafOutputFormat {
     VMAF_OUTPUT_FORMAT_NONE = 0,
     VMAF_OUTPUT_FORMAT_XML,
+    VMAF_OUTPUT_FORMAT_JSON,
+    VMAF_OUTPUT_FORMAT_CSV,
+    VMAF_OUTPUT_FORMAT_BINARY,
 };
 
 enum VmafPoolingMethod {
@@ -25,12 +28,49 @@ enum VmafPoolingMethod {
 
 typedef struct VmafConfiguration {
     enum VmafLogLevel log_level;
+    // when > 1, ADM and VIF split every picture in horizontal stripes
+    // extracted on this many threads, with identical scores
     unsigned n_threads;
     unsigned n_subsample;
+    // preview mode: 2 or 4 computes the multi-scale features (ADM, VIF)
+    // from pictures decimated by this factor and estimates the finer scales,
+    // 0 (or 1) for full resolution scores
+    unsigned preview;
+    // adaptive temporal subsampling: when > 1, spatial features are only
+    // extracted for pictures picked by motion, scene cuts and distortion
+    // changes, at most this many pictures apart. Skipped pictures get
+    // interpolated scores. Not combinable with n_subsample.
+    unsigned adaptive_subsample;
 } VmafConfiguration;
 
 typedef struct VmafContext VmafContext;
 
+typedef struct VmafPoolAccumulator VmafPoolAccumulator;
+
+typedef struct VmafFeatureScore {
+    const char *name;
+    double value;
+} VmafFeatureScore;
+
+typedef struct VmafFrameScore {
+    unsigned index;
+    double score;
+    VmafFeatureScore *feature; // features required by the model, model order
+    unsigned n_features;
+} VmafFrameScore;
+
+typedef void (*VmafScoreCallback)(void *user_data,
+                                  const VmafFrameScore *frame_score);
+
+typedef struct VmafBootstrapScore {
+    double score;
+    double bagging_score;
+    double stddev;
+    struct {
+        double lo, hi;
+    } ci95;
+} VmafBootstrapScore;
+
 /**
  * Allocate and open a VMAF instance.
  *
@@ -102,12 +142,15 @@ int vmaf_import_feature_score(VmafContext *vmaf, char *feature_name,
  * `vmaf_use_features_from_model()` and/or `vmaf_use_feature()`.
  * `VmafContext` will take ownership of both `VmafPicture`s (`ref` and `dist`)
  * and `vmaf_picture_unref()`.
+ * When there are no more pictures, call once with `ref` and `dist` set to
+ * NULL to flush: temporal feature extractors emit their delayed scores and
+ * any pending score callbacks are invoked.
  *
  * @param vmaf  The VMAF context allocated with `vmaf_init()`.
  *
- * @param ref   Reference picture.
+ * @param ref   Reference picture, or NULL to flush.
  *
- * @param dist  Distorted picture.
+ * @param dist  Distorted picture, or NULL to flush.
  *
  * @param index Picture index.
  *
@@ -118,7 +161,150 @@ int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
                        unsigned index);
 
 /**
- * Predict VMAF score at specific index.
+ * Use a reference cache file: reference-only intermediates (e.g. `motion2`
+ * scores, ADM CSF denominators) are read from `path` if it exists and
+ * reused for every leading picture which is identical to the run that wrote
+ * it, so that later runs against the same reference only compute the work
+ * which depends on the distorted pictures. A truncated or corrupt file is
+ * used as an empty cache. `path` is replaced with the intermediates of
+ * this run when flushing, through a temporary file renamed over it.
+ * Must be called before the first picture is read, pictures have to be
+ * read in order.
+ *
+ * @param vmaf The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param path Path of the cache file.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_use_reference_cache(VmafContext *vmaf, const char *path);
+
+/**
+ * Use a feature cache directory: per-picture scores of versioned, non-temporal
+ * feature extractors are looked up by the content hashes of the reference and
+ * distorted pictures, so that pictures scored by any previous run (e.g. a
+ * re-encode which only changed part of a clip) are not extracted again.
+ * Scores of new pictures are appended to one file per extractor and version
+ * when flushing, temporal extractors (e.g. `motion`) are always extracted.
+ * Must be called before the first picture is read.
+ *
+ * @param vmaf The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param dir  Existing directory of the cache files.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_use_feature_cache(VmafContext *vmaf, const char *dir);
+
+/**
+ * Register an additional distorted stream which shares the reference of
+ * `vmaf`, e.g. one of several encodes of the same source. Reference side
+ * computation (reference decomposition, filtering, `motion2`) is then done
+ * once per reference picture for all distorted streams, see
+ * `vmaf_read_pictures_multi()`.
+ * The stream uses the feature extractors registered with `vmaf`, and holds
+ * its own feature scores: use it like any other `VmafContext` for scores,
+ * score callbacks and output. Pictures can only be read via `vmaf`.
+ * Streams must be registered before the first picture is read, they are
+ * flushed with `vmaf` and freed by `vmaf_close()` on `vmaf`.
+ *
+ * @param vmaf   The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param stream $stream will be set to the allocated stream context.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_register_distorted_stream(VmafContext *vmaf, VmafContext **stream);
+
+/**
+ * Read a reference picture and one distorted picture per stream, like
+ * `vmaf_read_pictures()`. `dist[0]` belongs to `vmaf` itself and
+ * `dist[i]` to the i-th stream registered via
+ * `vmaf_register_distorted_stream()`. `VmafContext` will take ownership of
+ * all `VmafPicture`s and `vmaf_picture_unref()`.
+ * Temporal feature extractors must support sharing their state across
+ * distorted streams, otherwise -EINVAL is returned.
+ * Flush with `vmaf_read_pictures()`.
+ *
+ * @param vmaf   The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param ref    Reference picture.
+ *
+ * @param dist   Distorted pictures.
+ *
+ * @param n_dist Number of distorted pictures, 1 + number of streams.
+ *
+ * @param index  Picture index.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_read_pictures_multi(VmafContext *vmaf, VmafPicture *ref,
+                             VmafPicture **dist, unsigned n_dist,
+                             unsigned index);
+
+/**
+ * Register a callback which is invoked for every picture index as soon as
+ * all features required by `model` are available for that index, i.e.
+ * without waiting for the end of the stream. Indices are delivered in order.
+ * Since some temporal features are only available one picture later
+ * (e.g. `motion2`), the last index is delivered when flushing with
+ * `vmaf_read_pictures()`. Callbacks run on the thread calling
+ * `vmaf_read_pictures()`.
+ *
+ * @param vmaf      The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param model     Opaque model context, features should be registered via
+ *                  `vmaf_use_features_from_model()`.
+ *
+ * @param callback  Callback, receives `user_data` and the frame score.
+ *                  `frame_score` is only valid for the duration of the call.
+ *
+ * @param user_data Opaque pointer passed to `callback`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_register_score_callback(VmafContext *vmaf, VmafModel *model,
+                                 VmafScoreCallback callback, void *user_data);
+
+/**
+ * Register an output file which is written incrementally: every picture
+ * index is written as soon as all features of the registered feature
+ * extractors (and of `model`, if any) are available for it, so that scores
+ * need not be retained until the end of the stream. Indices are written in
+ * order. The output is completed when flushing with `vmaf_read_pictures()`,
+ * remaining incomplete pictures are written with the features available.
+ * Only one output may be registered per context.
+ *
+ * @param vmaf    The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param outfile Output file, previously `fopen()`'d by calling application.
+ *                Must remain open until the context is flushed or closed.
+ *
+ * @param fmt     Output file format. See `enum VmafOutputFormat` for options.
+ *                With `VMAF_OUTPUT_FORMAT_CSV`, the columns are the features
+ *                available when the first picture is written.
+ *                `VMAF_OUTPUT_FORMAT_BINARY` is columnar and can not be
+ *                streamed, use `vmaf_write_output()` instead.
+ *
+ * @param model   Opaque model context, the predicted score of every picture
+ *                is written alongside its features. May be NULL.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_register_output(VmafContext *vmaf, FILE *outfile,
+                         enum VmafOutputFormat fmt, VmafModel *model);
+
+/**
+ * Predict VMAF score at specific index. Scores are predicted once per model
+ * and picture. The scores of the model passed to `vmaf_register_output()`,
+ * or else of the first model scored, are also written as `vmaf` by
+ * `vmaf_write_output()`.
  *
  * @param vmaf   The VMAF context allocated with `vmaf_init()`.
  *
@@ -134,6 +320,29 @@ int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
 int vmaf_score_at_index(VmafContext *vmaf, VmafModel *model, double *score,
                         unsigned index);
 
+/**
+ * Predict VMAF score and bootstrap confidence interval at specific index.
+ * Only supported for bootstrap models (e.g. `vmaf_b_v0.6.3.pkl`), whose
+ * sub-models are evaluated in a single batched pass.
+ * Scores are predicted once per model and picture. Per-frame
+ * `vmaf_bagging`, `vmaf_stddev`, `vmaf_ci95_low` and `vmaf_ci95_high` of
+ * the first model scored this way are also made available to
+ * `vmaf_write_output()`.
+ *
+ * @param vmaf   The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param model  Opaque model context, loaded from a bootstrap model.
+ *
+ * @param score  Predicted score, bagging score, stddev and 95% CI.
+ *
+ * @param index  Picture index.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_score_at_index_bootstrap(VmafContext *vmaf, VmafModel *model,
+                                  VmafBootstrapScore *score, unsigned index);
+
 /**
  * Predict pooled VMAF score for a specific interval.
  *
@@ -156,6 +365,87 @@ int vmaf_score_pooled(VmafContext *vmaf, VmafModel *model,
                       enum VmafPoolingMethod pool_method, double *score,
                       unsigned index_low, unsigned index_high);
 
+/**
+ * Allocate a streaming pooling accumulator.
+ * Scores are appended one at a time, e.g. as each frame is scored with
+ * `vmaf_score_at_index()`. Pooled statistics are available at any point,
+ * without retaining per-frame scores.
+ *
+ * @param acc The accumulator to allocate.
+ *            Should be cleaned up with `vmaf_pool_accumulator_destroy()`.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_pool_accumulator_init(VmafPoolAccumulator **acc);
+
+/**
+ * Append a score to a pooling accumulator.
+ *
+ * @param acc   Accumulator allocated with `vmaf_pool_accumulator_init()`.
+ *
+ * @param score Score to append, must be finite.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_pool_accumulator_append(VmafPoolAccumulator *acc, double score);
+
+/**
+ * Merge the scores of one pooling accumulator into another,
+ * e.g. to combine accumulators of several shards of the same video.
+ * The result is identical to appending all scores to a single accumulator.
+ *
+ * @param dst Accumulator to merge into.
+ *
+ * @param src Accumulator to merge from, left unchanged.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_pool_accumulator_merge(VmafPoolAccumulator *dst,
+                                const VmafPoolAccumulator *src);
+
+/**
+ * Get the pooled score of all appended scores.
+ *
+ * @param acc          Accumulator allocated with `vmaf_pool_accumulator_init()`.
+ *
+ * @param pool_method  Temporal pooling method to use.
+ *
+ * @param score        Pooled score.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_pool_accumulator_get(VmafPoolAccumulator *acc,
+                              enum VmafPoolingMethod pool_method,
+                              double *score);
+
+/**
+ * Get a percentile of all appended scores, e.g. 1, 5 or 10 for low
+ * percentile pooling, 50 for the median.
+ * Percentiles are estimated with a relative error of at most 0.1%.
+ *
+ * @param acc        Accumulator allocated with `vmaf_pool_accumulator_init()`.
+ *
+ * @param percentile Percentile in [0, 100].
+ *
+ * @param score      Estimated percentile.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_pool_accumulator_get_percentile(VmafPoolAccumulator *acc,
+                                         double percentile, double *score);
+
+/**
+ * Free a pooling accumulator.
+ *
+ * @param acc Accumulator allocated with `vmaf_pool_accumulator_init()`.
+ */
+void vmaf_pool_accumulator_destroy(VmafPoolAccumulator *acc);
+
 /**
  * Close a VMAF instance and free all associated memory.
  *
@@ -174,6 +464,9 @@ int vmaf_close(VmafContext *vmaf);
  * @param logfile Output file, previously `fopen()`'d by calling application.
  *
  * @param fmt     Output file format. See `enum VmafOutputFormat` for options.
+ *                `VMAF_OUTPUT_FORMAT_BINARY` writes the columnar binary
+ *                feature log, one contiguous float64 array per feature.
+ *                The file should be opened in binary mode.
  *
  *
  * @return 0 on success, or < 0 (a negative errno code) on error.
@@ -181,6 +474,54 @@ int vmaf_close(VmafContext *vmaf);
 int vmaf_write_output(VmafContext *vmaf, FILE *logfile,
                       enum VmafOutputFormat fmt);
 
+/**
+ * Write the feature scores of a picture index interval as a partial result.
+ * Useful when a video is split into temporal shards which are processed
+ * separately: each shard writes a partial result, which are then combined
+ * with `vmaf_read_partial()`. Scores are written bit-exact.
+ * Temporal features depend on neighbouring pictures (e.g. `motion2`), so a
+ * shard should read one picture before and one picture after its interval.
+ *
+ * @param vmaf         The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param partial      Output file, previously `fopen()`'d by calling
+ *                     application.
+ *
+ * @param index_low    Low picture index of the interval.
+ *
+ * @param index_high   High picture index of the interval (exclusive).
+ *
+ * @param index_offset Offset added to every picture index written,
+ *                     i.e. the position of picture index 0 in the complete
+ *                     video.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_write_partial(VmafContext *vmaf, FILE *partial, unsigned index_low,
+                       unsigned index_high, unsigned index_offset);
+
+/**
+ * Import the feature scores of a partial result written with
+ * `vmaf_write_partial()`, as if imported with `vmaf_import_feature_score()`.
+ * May be called once per shard, shards must not overlap.
+ *
+ * @param vmaf       The VMAF context allocated with `vmaf_init()`.
+ *
+ * @param partial    Input file, previously `fopen()`'d by calling application.
+ *
+ * @param index_low  Low picture index covered by the partial result,
+ *                   may be NULL.
+ *
+ * @param index_high High picture index covered by the partial result
+ *                   (exclusive), may be NULL.
+ *
+ *
+ * @return 0 on success, or < 0 (a negative errno code) on error.
+ */
+int vmaf_read_partial(VmafContext *vmaf, FILE *partial, unsigned *index_low,
+                      unsigned *index_high);
+
 /**
  * Get libvmaf version.
  */
@@ -49,10 +49,163 @@ int compute_ansnr(const float *ref, const float *dis, int w, int h, int ref_stri
 int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score, double *score_num, double *score_den, double *scores);
 int compute_motion(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score);
 int compute_psnr(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score, double peak, double psnr_max);
-int compute_ssim(const float *ref, const float *cmp, int w, int h, int ref_stride, int cmp_stride, double *score, double *l_score, double *c_score, double *s_score);
-int compute_ms_ssim(const float *ref, const float *cmp, int w, int h, int ref_stride, int cmp_stride, double *score, double* l_scores, double* c_scores, double* s_scores);
+int compute_ssim_offset(const float *ref, const float *cmp, int w, int h, int ref_stride, int cmp_stride, float pixel_offset, double *score, double *l_score, double *c_score, double *s_score);
+int compute_ms_ssim_offset(const float *ref, const float *cmp, int w, int h, int ref_stride, int cmp_stride, float pixel_offset, double *score, double* l_scores, double* c_scores, double* s_scores);
 
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#define MAX(x, y) (((x) > (y)) ? (x) : (y))
+
+/*
+ * returns whether the flag of the frame index has been set,
+ * frames which have not been reached yet read as unset
+ */
+static bool frame_flag_set(DArray* flag_array, int frm_idx)
+{
+    return get_at(flag_array, frm_idx) != 0.0;
+}
+
+/*
+ * waits until a slot is free in the buffer array and assigns it to the frame index,
+ * returns NULL if the threads are stopped in the meantime
+ */
+static float* wait_free_blur_buf_slot(VMAF_THREAD_STRUCT* thread_data, BLUR_BUF_ARRAY* arr, int frm_idx)
+{
+    float *buf;
+
+    pthread_mutex_lock(&thread_data->mutex_readframe);
+    while (!(buf = get_free_blur_buf_slot(arr, frm_idx)) && !thread_data->stop_threads)
+    {
+        pthread_cond_wait(&thread_data->cond_slot_free, &thread_data->mutex_readframe);
+    }
+    pthread_mutex_unlock(&thread_data->mutex_readframe);
+
+    return buf;
+}
+
+static void release_read_slots(VMAF_THREAD_STRUCT* thread_data, int frm_idx)
+{
+    BLUR_BUF_ARRAY* arr[3] = { &thread_data->ref_buf_array, &thread_data->dis_buf_array, &thread_data->blur_buf_array };
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (get_blur_buf_reference_count(arr[i], frm_idx) > 0)
+        {
+            release_blur_buf_reference(arr[i], frm_idx);
+        }
+        release_blur_buf_slot(arr[i], frm_idx);
+    }
+}
+
+/*
+ * Reader stage: reads the frames in order ahead of the compute workers, offsets
+ * them and blurs the reference for motion, so that I/O and blurring do not
+ * serialize the workers. A frame is published once all its buffers are filled.
+ */
+void* combo_readerfunc(void* vmaf_thread_data)
+{
+    // this is our shared thread data
+    VMAF_THREAD_STRUCT* thread_data = (VMAF_THREAD_STRUCT*)vmaf_thread_data;
+
+    size_t data_sz = thread_data->data_sz;
+    int stride = thread_data->stride;
+    int w = thread_data->w;
+    int h = thread_data->h;
+    char* errmsg = thread_data->errmsg;
+    void* user_data = thread_data->user_data;
+    bool do_motion = thread_data->motion_array != NULL;
+
+    float *ref_buf;
+    float *dis_buf;
+    float *blur_buf;
+    float *temp_buf = 0;
+
+    int ret = 0;
+
+    // use temp_buf for convolution_f32_c, and fread u and v
+    if (!(temp_buf = aligned_malloc(data_sz * 2, MAX_ALIGN)))
+    {
+        sprintf(errmsg, "aligned_malloc failed for temp_buf.\n");
+        ret = 1;
+        goto fail_or_end;
+    }
+
+    for (int frm_idx = 0; ; frm_idx++)
+    {
+        // the critical section is limited to the slot bookkeeping
+        ref_buf = wait_free_blur_buf_slot(thread_data, &thread_data->ref_buf_array, frm_idx);
+        dis_buf = ref_buf ? wait_free_blur_buf_slot(thread_data, &thread_data->dis_buf_array, frm_idx) : NULL;
+        blur_buf = (dis_buf && do_motion) ? wait_free_blur_buf_slot(thread_data, &thread_data->blur_buf_array, frm_idx) : NULL;
+        if ((NULL == dis_buf) || (do_motion && (NULL == blur_buf)))
+        {
+            // stopped by a worker
+            release_read_slots(thread_data, frm_idx);
+            goto fail_or_end;
+        }
+
+        // read frame from file
+        ret = thread_data->read_frame(ref_buf, dis_buf, temp_buf, stride, user_data);
+        if (ret == 1 || ret == 2)
+        {
+            release_read_slots(thread_data, frm_idx);
+            if (ret == 2)
+            {
+                ret = 0;
+            }
+            else
+            {
+                sprintf(errmsg, "read_frame failed.\n");
+            }
+            goto fail_or_end;
+        }
+
+        // ===============================================================
+        // offset pixel by OPT_RANGE_PIXEL_OFFSET
+        // ===============================================================
+        offset_image(ref_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
+        offset_image(dis_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
+
+        // ===============================================================
+        // filter
+        // apply filtering (to eliminate effects film grain)
+        // stride input to convolution_f32_c is in terms of (sizeof(float) bytes)
+        // since stride = ALIGN_CEIL(w * sizeof(float)), stride divides sizeof(float)
+        // ===============================================================
+        if (do_motion)
+        {
+            convolution_f32_c(FILTER_5, 5, ref_buf, blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float));
+        }
+
+        // the buffers are owned by their slots from now on, until released by the workers
+        release_blur_buf_reference(&thread_data->ref_buf_array, frm_idx);
+        release_blur_buf_reference(&thread_data->dis_buf_array, frm_idx);
+        if (do_motion)
+        {
+            release_blur_buf_reference(&thread_data->blur_buf_array, frm_idx);
+        }
+
+        pthread_mutex_lock(&thread_data->mutex_readframe);
+        thread_data->frm_read = frm_idx + 1;
+        pthread_cond_broadcast(&thread_data->cond_frame_read);
+        pthread_mutex_unlock(&thread_data->mutex_readframe);
+    }
+
+fail_or_end:
+
+    aligned_free(temp_buf);
+
+    // the workers finish the frames read so far, or all stop on error
+    pthread_mutex_lock(&thread_data->mutex_readframe);
+    thread_data->read_done = 1;
+    if (ret)
+    {
+        thread_data->stop_threads = 1;
+        thread_data->ret = ret;
+    }
+    pthread_cond_broadcast(&thread_data->cond_frame_read);
+    pthread_mutex_unlock(&thread_data->mutex_readframe);
+
+    return NULL;
+}
 
 void* combo_threadfunc(void* vmaf_thread_data)
 {
@@ -60,17 +213,20 @@ void* combo_threadfunc(void* vmaf_thread_data)
     VMAF_THREAD_STRUCT* thread_data = (VMAF_THREAD_STRUCT*)vmaf_thread_data;
 
     // set the local variables from the thread shared data
-    size_t data_sz = thread_data->data_sz;
     int stride = thread_data->stride;
     double peak = thread_data->peak;
     double psnr_max = thread_data->psnr_max;
     int w = thread_data->w;
     int h = thread_data->h;
     char* errmsg = thread_data->errmsg;
-    void* user_data = thread_data->user_data;
     const char* fmt = thread_data->fmt;
     int n_subsample = thread_data->n_subsample;
 
+    // the feature groups whose output arrays are NULL are skipped
+    bool do_adm = thread_data->adm_num_array != NULL;
+    bool do_motion = thread_data->motion_array != NULL;
+    bool do_vif = thread_data->vif_array != NULL;
+
     double score = 0;
     double score2 = 0;
     double scores[4*2];
@@ -87,23 +243,11 @@ void* combo_threadfunc(void* vmaf_thread_data)
     float *dis_buf = 0;
     float *prev_blur_buf = 0;
     float *blur_buf = 0;
-    float *next_ref_buf = 0;
-    float *next_dis_buf = 0;
     float *next_blur_buf = 0;
-    float *temp_buf = 0;
 
     int ret = 0;
     bool next_frame_read;
 
-    bool offset_flag = false;
-
-    // use temp_buf for convolution_f32_c, and fread u and v
-    if (!(temp_buf = aligned_malloc(data_sz * 2, MAX_ALIGN)))
-    {
-        sprintf(errmsg, "aligned_malloc failed for temp_buf.\n");
-        goto fail_or_end;
-    }
-
     int frm_idx = -1;
 
     while (1)
@@ -111,153 +255,52 @@ void* combo_threadfunc(void* vmaf_thread_data)
 
         pthread_mutex_lock(&thread_data->mutex_readframe);
 
-        if (thread_data->stop_threads)
-        {
-            // this is the signal that another thread has reached the end of the input file, so we all quit
-            pthread_mutex_unlock(&thread_data->mutex_readframe);
-            goto fail_or_end;
-        }
-
         // the next frame
         frm_idx = thread_data->frm_idx;
         thread_data->frm_idx++;
 
-        if (frm_idx == 0)
+        // wait for the reader, motion needs the frame after the current one
+        while (!thread_data->stop_threads && !thread_data->read_done && thread_data->frm_read <= frm_idx + (do_motion ? 1 : 0))
         {
-            // Allocating the free buffers from buffer array
-            blur_buf    = get_free_blur_buf_slot(&thread_data->blur_buf_array, frm_idx);
-            ref_buf     = get_free_blur_buf_slot(&thread_data->ref_buf_array, frm_idx);
-            dis_buf     = get_free_blur_buf_slot(&thread_data->dis_buf_array, frm_idx);
-		
-            if((NULL == blur_buf) || (NULL == ref_buf) || (NULL == dis_buf))
-            {
-                thread_data->stop_threads = 1;
-                sprintf(errmsg, "No free slot found for buffer allocation.\n");
-                pthread_mutex_unlock(&thread_data->mutex_readframe);
-                goto fail_or_end;
-            }
-
-            // read frame from file
-
-            ret = thread_data->read_frame(ref_buf, dis_buf, temp_buf, stride, user_data);
-            if (ret == 1)
-            {
-                thread_data->stop_threads = 1;
-                pthread_mutex_unlock(&thread_data->mutex_readframe);
-                goto fail_or_end;
-            }
-            if (ret == 2)
-            {
-                thread_data->stop_threads = 1;
-                pthread_mutex_unlock(&thread_data->mutex_readframe);
-                goto fail_or_end;
-            }
-
-            // ===============================================================
-            // offset pixel by OPT_RANGE_PIXEL_OFFSET
-            // ===============================================================
-            offset_image(ref_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_image(dis_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-
-            // ===============================================================
-            // filter
-            // apply filtering (to eliminate effects film grain)
-            // stride input to convolution_f32_c is in terms of (sizeof(float) bytes)
-            // since stride = ALIGN_CEIL(w * sizeof(float)), stride divides sizeof(float)
-            // ===============================================================
-            convolution_f32_c(FILTER_5, 5, ref_buf, blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float));
-
-        }
-        else
-        {
-            // retrieve from buffer array
-            ref_buf     = get_blur_buf(&thread_data->ref_buf_array, frm_idx);
-            dis_buf     = get_blur_buf(&thread_data->dis_buf_array, frm_idx);
-            blur_buf    = get_blur_buf(&thread_data->blur_buf_array, frm_idx);
-
-            if((NULL == ref_buf) || (NULL == dis_buf) || (NULL == blur_buf))
-            {
-                thread_data->stop_threads = 1;
-                sprintf(errmsg, "Data not available.\n");
-                pthread_mutex_unlock(&thread_data->mutex_readframe);
-                goto fail_or_end;
-            }
+            pthread_cond_wait(&thread_data->cond_frame_read, &thread_data->mutex_readframe);
         }
 
-        // Allocate free buffer from the buffer array for next frame index
-        next_ref_buf 	= get_free_blur_buf_slot(&thread_data->ref_buf_array, frm_idx + 1);
-        next_dis_buf 	= get_free_blur_buf_slot(&thread_data->dis_buf_array, frm_idx + 1);
-        if((NULL == next_ref_buf) || (NULL == next_dis_buf))
+        if (thread_data->stop_threads || frm_idx >= thread_data->frm_read)
         {
-            thread_data->stop_threads = 1;
-            sprintf(errmsg, "No free slot found for next buffer.\n");
+            // either an error or the end of the input file was reached, so we all quit
             pthread_mutex_unlock(&thread_data->mutex_readframe);
             goto fail_or_end;
         }
+        next_frame_read = frm_idx + 1 < thread_data->frm_read;
+
+        // retrieve from buffer array, while holding the lock so that the slots
+        // can not be released by a worker on a later frame in the meantime
+        ref_buf     = get_blur_buf(&thread_data->ref_buf_array, frm_idx);
+        dis_buf     = get_blur_buf(&thread_data->dis_buf_array, frm_idx);
+        blur_buf    = do_motion ? get_blur_buf(&thread_data->blur_buf_array, frm_idx) : NULL;
+        next_blur_buf = (do_motion && next_frame_read) ? get_blur_buf(&thread_data->blur_buf_array, frm_idx + 1) : NULL;
 
-        ret = thread_data->read_frame(next_ref_buf, next_dis_buf, temp_buf, stride, user_data);
-        if (ret == 1)
+        if((NULL == ref_buf) || (NULL == dis_buf) || (do_motion && ((NULL == blur_buf) || (next_frame_read && (NULL == next_blur_buf)))))
         {
             thread_data->stop_threads = 1;
+            sprintf(errmsg, "Data not available.\n");
+            pthread_cond_broadcast(&thread_data->cond_slot_free);
             pthread_mutex_unlock(&thread_data->mutex_readframe);
+            ret = 1;
             goto fail_or_end;
         }
-        if (ret == 2)
-        {
-            thread_data->stop_threads = 1;
-            next_frame_read = false;
-        }
-        else
-        {
-            next_frame_read = true;
-        }
-
-        if (next_frame_read)
-        {
-            next_blur_buf     = get_free_blur_buf_slot(&thread_data->blur_buf_array, frm_idx + 1);
-            if(NULL == next_blur_buf)
-            {
-                thread_data->stop_threads = 1;
-                sprintf(errmsg, "No free slot found for blur buffer.\n");
-                goto fail_or_end;
-            }
-            // ===============================================================
-            // offset pixel by OPT_RANGE_PIXEL_OFFSET
-            // ===============================================================
-            offset_image(next_ref_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_image(next_dis_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-
-            // ===============================================================
-            // filter
-            // apply filtering (to eliminate effects film grain)
-            // stride input to convolution_f32_c is in terms of (sizeof(float) bytes)
-            // since stride = ALIGN_CEIL(w * sizeof(float)), stride divides sizeof(float)
-            // ===============================================================
-            convolution_f32_c(FILTER_5, 5, next_ref_buf, next_blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float));
-
-        }
 
-        // release ref and dis buffer references after blur buf computation
-        release_blur_buf_reference(&thread_data->ref_buf_array, frm_idx + 1);
-        release_blur_buf_reference(&thread_data->dis_buf_array, frm_idx + 1);
         pthread_mutex_unlock(&thread_data->mutex_readframe);
 
         dbg_printf("frame: %d, ", frm_idx);
 
         // ===============================================================
-        // for the PSNR, SSIM and MS-SSIM, offset are 0. Since in prev read
-        // step they have been offset by OPT_RANGE_PIXEL_OFFSET, now
-        // offset them back.
+        // for the PSNR, SSIM and MS-SSIM, offset are 0. The buffers have
+        // been offset by OPT_RANGE_PIXEL_OFFSET in the read step, so SSIM
+        // and MS-SSIM take the offset back while copying the buffers in.
+        // PSNR only uses the difference, in which the offset cancels.
         // ===============================================================
 
-        // offset back the buffers only if required
-        if (frm_idx % n_subsample == 0 && ( (thread_data->psnr_array != NULL) || (thread_data->ssim_array != NULL) || (thread_data->ms_ssim_array != NULL) ))
-        {
-            offset_image(ref_buf, -OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_image(dis_buf, -OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_flag = true;
-		}
-
         if (frm_idx % n_subsample == 0 && thread_data->psnr_array != NULL)
         {
             /* =========== psnr ============== */
@@ -278,7 +321,7 @@ void* combo_threadfunc(void* vmaf_thread_data)
         {
 
             /* =========== ssim ============== */
-            if ((ret = compute_ssim(ref_buf, dis_buf, w, h, stride, stride, &score, &l_score, &c_score, &s_score)))
+            if ((ret = compute_ssim_offset(ref_buf, dis_buf, w, h, stride, stride, OPT_RANGE_PIXEL_OFFSET, &score, &l_score, &c_score, &s_score)))
             {
                 sprintf(errmsg, "compute_ssim failed.\n");
                 goto fail_or_end;
@@ -292,7 +335,7 @@ void* combo_threadfunc(void* vmaf_thread_data)
         if (frm_idx % n_subsample == 0 && thread_data->ms_ssim_array != NULL)
         {
             /* =========== ms-ssim ============== */
-            if ((ret = compute_ms_ssim(ref_buf, dis_buf, w, h, stride, stride, &score, l_scores, c_scores, s_scores)))
+            if ((ret = compute_ms_ssim_offset(ref_buf, dis_buf, w, h, stride, stride, OPT_RANGE_PIXEL_OFFSET, &score, l_scores, c_scores, s_scores)))
             {
                 sprintf(errmsg, "compute_ms_ssim failed.\n");
                 goto fail_or_end;
@@ -303,19 +346,8 @@ void* combo_threadfunc(void* vmaf_thread_data)
             insert_array_at(thread_data->ms_ssim_array, score, frm_idx);
         }
 
-        // ===============================================================
-        // for the rest, offset pixel by OPT_RANGE_PIXEL_OFFSET
-        // ===============================================================
-
-        if (offset_flag)
-        {
-            offset_image(ref_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_image(dis_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            offset_flag = false;
-		}
-
         /* =========== adm ============== */
-        if (frm_idx % n_subsample == 0)
+        if (do_adm && frm_idx % n_subsample == 0)
         {
             if ((ret = compute_adm(ref_buf, dis_buf, w, h, stride, stride, &score, &score_num, &score_den, scores, ADM_BORDER_FACTOR)))
             {
@@ -382,7 +414,7 @@ void* combo_threadfunc(void* vmaf_thread_data)
 
         /* =========== motion ============== */
 
-        if (frm_idx % n_subsample == 0)
+        if (do_motion && frm_idx % n_subsample == 0)
         {
 
             // compute
@@ -431,12 +463,15 @@ void* combo_threadfunc(void* vmaf_thread_data)
 
         }
         /* Indicate that motion score computation for this frame is complete */
-        insert_array_at(thread_data->motion_score_compute_flag_array, 1.0, frm_idx);
-        release_blur_buf_reference(&thread_data->blur_buf_array, frm_idx + 1);
+        if (do_motion)
+        {
+            insert_array_at(thread_data->motion_score_compute_flag_array, 1.0, frm_idx);
+            release_blur_buf_reference(&thread_data->blur_buf_array, frm_idx + 1);
+        }
 
         /* =========== vif ============== */
 
-        if (frm_idx % n_subsample == 0)
+        if (do_vif && frm_idx % n_subsample == 0)
         {
             if ((ret = compute_vif(ref_buf, dis_buf, w, h, stride, stride, &score, &score_num, &score_den, scores)))
             {
@@ -469,37 +504,53 @@ void* combo_threadfunc(void* vmaf_thread_data)
 
         dbg_printf("\n");
 
-        //Release references to reference and distorted buffers
-        release_blur_buf_reference(&thread_data->ref_buf_array, frm_idx);
-        release_blur_buf_reference(&thread_data->dis_buf_array, frm_idx);
-        release_blur_buf_reference(&thread_data->blur_buf_array, frm_idx);
-        /*Loop through the slots and release slots if there are no more
-          reference till the current index. Not releasing next frame as
-          it may be required for the next loop						   */
-        for(int i = 0; i <= frm_idx; i++)
+        /* Hand the frames whose features are complete to the caller, in frame order */
+        if (thread_data->frame_done)
         {
-            int ref_reference_count = get_blur_buf_reference_count(&thread_data->ref_buf_array, i);
-            int dis_reference_count = get_blur_buf_reference_count(&thread_data->dis_buf_array, i);
+            insert_array_at(thread_data->frame_done_flag_array, 1.0, frm_idx);
 
-            if((ref_reference_count == 0) && (dis_reference_count == 0))
+            pthread_mutex_lock(&thread_data->mutex_frame_done);
+            while (!ret &&
+                   frame_flag_set(thread_data->frame_done_flag_array, thread_data->frm_done))
             {
-                release_blur_buf_slot(&thread_data->ref_buf_array, i);
-                release_blur_buf_slot(&thread_data->dis_buf_array, i);
+                ret = thread_data->frame_done(thread_data->frm_done, thread_data->frame_done_data);
+                thread_data->frm_done++;
+            }
+            pthread_mutex_unlock(&thread_data->mutex_frame_done);
+
+            if (ret)
+            {
+                sprintf(errmsg, "frame_done callback failed.\n");
+                goto fail_or_end;
             }
         }
 
-        /* Loop through the blur buffer array and release slots only till current index - 1 */
+        //Release references to reference and distorted buffers
+        release_blur_buf_reference(&thread_data->ref_buf_array, frm_idx);
+        release_blur_buf_reference(&thread_data->dis_buf_array, frm_idx);
+        release_blur_buf_reference(&thread_data->blur_buf_array, frm_idx);
+        /* The reference and distorted buffers are only used by the worker
+           of their own frame, so the slots can be released right away. A
+           frame that is read but not claimed yet must not be touched here,
+           its worker may not have taken its references so far.         */
+        release_blur_buf_slot(&thread_data->ref_buf_array, frm_idx);
+        release_blur_buf_slot(&thread_data->dis_buf_array, frm_idx);
+
+        /* Loop through the blur buffer array and release the slots of all frames read so far */
         /* Only for those whose reference counter is zero */
-        for(int i = 0; i <= (frm_idx - 1); i++)
+        pthread_mutex_lock(&thread_data->mutex_readframe);
+        int frm_read = thread_data->frm_read;
+        pthread_mutex_unlock(&thread_data->mutex_readframe);
+        for(int i = MAX(0, frm_read - thread_data->blur_buf_array.actual_length); i < frm_read; i++)
         {
             int reference_count = get_blur_buf_reference_count(&thread_data->blur_buf_array, i);
             if(reference_count == 0)
             {
                 /* Release buffer only if motion score is computed for current, previous and next frame */
                 if(
-                    (get_at(thread_data->motion_score_compute_flag_array, i)) &&
-                    (get_at(thread_data->motion_score_compute_flag_array, i + 1)) &&
-                    ((i == 0) || (get_at(thread_data->motion_score_compute_flag_array, i - 1)))
+                    frame_flag_set(thread_data->motion_score_compute_flag_array, i) &&
+                    frame_flag_set(thread_data->motion_score_compute_flag_array, i + 1) &&
+                    ((i == 0) || frame_flag_set(thread_data->motion_score_compute_flag_array, i - 1))
                     )
                 {
                     release_blur_buf_slot(&thread_data->blur_buf_array, i);
@@ -507,29 +558,31 @@ void* combo_threadfunc(void* vmaf_thread_data)
             }
         }
 
-        /* If this is the last frame then release any subsequent slots */
+        /* If this is the last frame then release its slot */
         if (!next_frame_read)
         {
-            release_blur_buf_slot(&thread_data->ref_buf_array, frm_idx + 1);
-            release_blur_buf_slot(&thread_data->dis_buf_array, frm_idx + 1);
             release_blur_buf_slot(&thread_data->blur_buf_array, frm_idx);
         }
 
-        if (!next_frame_read)
-        {
-            thread_data->stop_threads = 1;
-            goto fail_or_end;
-        }
+        // let the reader know that slots may have been released
+        pthread_mutex_lock(&thread_data->mutex_readframe);
+        pthread_cond_broadcast(&thread_data->cond_slot_free);
+        pthread_mutex_unlock(&thread_data->mutex_readframe);
 
     }
 
 fail_or_end:
 
-    aligned_free(temp_buf);
-
-    // when one thread ends we signal all other threads to also stop
-    thread_data->stop_threads = 1;
-    thread_data->ret = ret;
+    // on error we signal all other threads to also stop
+    pthread_mutex_lock(&thread_data->mutex_readframe);
+    if (ret)
+    {
+        thread_data->stop_threads = 1;
+        thread_data->ret = ret;
+    }
+    pthread_cond_broadcast(&thread_data->cond_frame_read);
+    pthread_cond_broadcast(&thread_data->cond_slot_free);
+    pthread_mutex_unlock(&thread_data->mutex_readframe);
     pthread_exit(&ret);
 
 }
@@ -561,7 +614,9 @@ int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data,
         DArray *ms_ssim_array,
         char *errmsg,
         int n_thread,
-        int n_subsample
+        int n_subsample,
+        int (*frame_done)(int frm_idx, void *user_data),
+        void *frame_done_data
         )
 {
     // init shared thread data
@@ -597,13 +652,30 @@ int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data,
     combo_thread_data.ms_ssim_array = ms_ssim_array;
     combo_thread_data.errmsg = errmsg;
     combo_thread_data.frm_idx = 0;
+    combo_thread_data.frm_read = 0;
+    combo_thread_data.read_done = 0;
     combo_thread_data.stop_threads = 0;
+    combo_thread_data.ret = 0;
     combo_thread_data.n_subsample = n_subsample;
 
     DArray	motion_score_compute_flag_array;
-    init_array(&motion_score_compute_flag_array, 1000);
+    DArray	frame_done_flag_array;
+    int flags_err = init_array(&motion_score_compute_flag_array, 1000);
+    flags_err |= init_array(&frame_done_flag_array, 1000);
+    if (flags_err)
+    {
+        sprintf(errmsg, "failed to allocate the frame flag arrays.\n");
+        free_array(&motion_score_compute_flag_array);
+        free_array(&frame_done_flag_array);
+        return -1;
+    }
     combo_thread_data.motion_score_compute_flag_array = &motion_score_compute_flag_array;
 
+    combo_thread_data.frame_done = frame_done;
+    combo_thread_data.frame_done_data = frame_done_data;
+    combo_thread_data.frame_done_flag_array = &frame_done_flag_array;
+    combo_thread_data.frm_done = 0;
+
     // sanity check for width/height
     if (w <= 0 || h <= 0 || (size_t)w > ALIGN_FLOOR(INT_MAX) / sizeof(float))
     {
@@ -640,27 +712,67 @@ int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data,
     /*
      *	In the multi-thread mode, allocate a fixed size buffer pool for the reference, distorted and blur buffers.
      *	At any point, the no. of required ref and dis buffers is 1 more than the total no. of allotted threads,
-        to accomodate reading the next frame index.
+        to accomodate the next frame index, plus 1 for the reader to work ahead.
      *	At any point, one thread operates on the current, previous and next blur buffers, and hence, the no. of
-        required blur buffers will be three times the total no. of allotted threads.
+        required blur buffers will be three times the total no. of allotted threads, plus 1 for the reader.
      */
-    init_blur_array(&combo_thread_data.ref_buf_array, MIN(combo_thread_data.thread_count + 1, MAX_NUM_THREADS), combo_thread_data.data_sz, MAX_ALIGN);
-    init_blur_array(&combo_thread_data.dis_buf_array, MIN(combo_thread_data.thread_count + 1, MAX_NUM_THREADS), combo_thread_data.data_sz, MAX_ALIGN);
-    init_blur_array(&combo_thread_data.blur_buf_array, MIN(3 * (combo_thread_data.thread_count), MAX_NUM_THREADS), combo_thread_data.data_sz, MAX_ALIGN);
+    int pool_ok = init_blur_array(&combo_thread_data.ref_buf_array, combo_thread_data.thread_count + 2, combo_thread_data.data_sz, MAX_ALIGN);
+    pool_ok &= init_blur_array(&combo_thread_data.dis_buf_array, combo_thread_data.thread_count + 2, combo_thread_data.data_sz, MAX_ALIGN);
+    // without motion no frame is blurred, lookups in the empty blur array all fail
+    if (motion_array != NULL)
+    {
+        pool_ok &= init_blur_array(&combo_thread_data.blur_buf_array, 3 * (combo_thread_data.thread_count) + 1, combo_thread_data.data_sz, MAX_ALIGN);
+    }
+    else
+    {
+        memset(&combo_thread_data.blur_buf_array, 0, sizeof(combo_thread_data.blur_buf_array));
+    }
+    if (!pool_ok)
+    {
+        sprintf(errmsg, "failed to allocate the frame buffer pool for %d threads.\n", combo_thread_data.thread_count);
+        free_blur_buf(&combo_thread_data.ref_buf_array);
+        free_blur_buf(&combo_thread_data.dis_buf_array);
+        free_blur_buf(&combo_thread_data.blur_buf_array);
+        free_array(&motion_score_compute_flag_array);
+        free_array(&frame_done_flag_array);
+        return -1;
+    }
 
-    // initialize the mutex that protects the read_frame function
+    // initialize the mutex that protects the frame and slot bookkeeping,
+    // and the conditions signalling read frames and released slots
     pthread_mutex_init(&combo_thread_data.mutex_readframe, NULL);
+    pthread_mutex_init(&combo_thread_data.mutex_frame_done, NULL);
+    pthread_cond_init(&combo_thread_data.cond_frame_read, NULL);
+    pthread_cond_init(&combo_thread_data.cond_slot_free, NULL);
 
     // create a joinable thread
     pthread_attr_t attr;
     pthread_attr_init(&attr);
     pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
 
-    // start threads
+    // start threads, the reader first
     int t;
     int numThread = combo_thread_data.thread_count;
     pthread_t* thread = (pthread_t*)calloc(numThread, sizeof(pthread_t));
     memset(thread, 0, numThread * sizeof(pthread_t));
+    pthread_t reader_thread;
+
+    if (pthread_create(&reader_thread, &attr, combo_readerfunc, &combo_thread_data))
+    {
+        sprintf(errmsg, "failed to start the reader thread.\n");
+        pthread_attr_destroy(&attr);
+        free(thread);
+        pthread_cond_destroy(&combo_thread_data.cond_frame_read);
+        pthread_cond_destroy(&combo_thread_data.cond_slot_free);
+        pthread_mutex_destroy(&combo_thread_data.mutex_readframe);
+        pthread_mutex_destroy(&combo_thread_data.mutex_frame_done);
+        free_blur_buf(&combo_thread_data.ref_buf_array);
+        free_blur_buf(&combo_thread_data.dis_buf_array);
+        free_blur_buf(&combo_thread_data.blur_buf_array);
+        free_array(&motion_score_compute_flag_array);
+        free_array(&frame_done_flag_array);
+        return -1;
+    }
 
     for (t=0; t < combo_thread_data.thread_count; t++)
     {
@@ -682,13 +794,26 @@ int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data,
         }
     }
 
+    if (pthread_join(reader_thread, NULL))
+    {
+        printf("ERROR; pthread_join() failed for the reader thread\n");
+        return -1;
+    }
+
+    pthread_cond_destroy(&combo_thread_data.cond_frame_read);
+    pthread_cond_destroy(&combo_thread_data.cond_slot_free);
+    pthread_mutex_destroy(&combo_thread_data.mutex_readframe);
+    pthread_mutex_destroy(&combo_thread_data.mutex_frame_done);
+
     free_blur_buf(&combo_thread_data.ref_buf_array);
     free_blur_buf(&combo_thread_data.dis_buf_array);
     free_blur_buf(&combo_thread_data.blur_buf_array);
 
     free_array(&motion_score_compute_flag_array);
+    free_array(&frame_done_flag_array);
 
     free(thread);
 
-    return 0;
+    // a failed reader or worker stopped the run early
+    return combo_thread_data.ret ? -1 : 0;
 }
@@ -65,6 +65,8 @@ typedef struct
     int n_subsample;
 
     int frm_idx;
+    int frm_read;
+    int read_done;
     int stride;
     double peak;
     double psnr_max;
@@ -72,16 +74,34 @@ typedef struct
     int thread_count;
     int stop_threads;
     pthread_mutex_t mutex_readframe;
+    pthread_cond_t cond_frame_read;
+    pthread_cond_t cond_slot_free;
     BLUR_BUF_ARRAY blur_buf_array;
     BLUR_BUF_ARRAY ref_buf_array;
     BLUR_BUF_ARRAY dis_buf_array;
     DArray *motion_score_compute_flag_array;
+    int (*frame_done)(int frm_idx, void *user_data);
+    void *frame_done_data;
+    DArray *frame_done_flag_array;
+    int frm_done;
+    pthread_mutex_t mutex_frame_done;
     int ret;
 
 } VMAF_THREAD_STRUCT;
 
+void* combo_readerfunc(void* vmaf_thread_data);
+
 void* combo_threadfunc(void* vmaf_thread_data);
 
+/*
+ * Feature groups are skipped when their output arrays are NULL: ADM when
+ * adm_num_array is NULL, motion and motion2 when motion_array is NULL, VIF
+ * when vif_array is NULL, and likewise PSNR, SSIM and MS-SSIM.
+ *
+ * If frame_done is not NULL, it is called once all features of a frame are
+ * in the output arrays, for every frame in frame order and never from two
+ * threads at the same time. A non-zero return value stops the computation.
+ */
 int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt,
         DArray *adm_num_array,
         DArray *adm_den_array,
@@ -109,7 +129,9 @@ int combo(int (*read_frame)(float *ref_data, float *main_data, float *temp_data,
         DArray *ms_ssim_array,
         char *errmsg,
         int n_thread,
-        int n_subsample
+        int n_subsample,
+        int (*frame_done)(int frm_idx, void *user_data),
+        void *frame_done_data
 );
 
 #ifdef __cplusplus
@@ -16,65 +16,134 @@
  *
  */
 
+#include <errno.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include "darray.h"
-#include "common/blur_array.h"
 
-void init_array(DArray *a, size_t init_size)
+/* enough chunks for any int position, whatever the size of the first one */
+#define DARRAY_MAX_CHUNKS 32
+
+/* every field is only accessed through the __atomic builtins */
+struct DARRAY_CHUNKS
 {
-    a->array = (double *)malloc(init_size * sizeof(double));
-	memset(a->array, 0.0, init_size * sizeof(double));
-    a->used = 0;
-    a->size = init_size;
-    pthread_mutex_init(&a->mutex, NULL);
-}
+    size_t used;
+    double *chunk[DARRAY_MAX_CHUNKS];
+};
 
-void insert_array(DArray *a, double e)
+/*
+ * returns the element of position pos, allocating its chunk if alloc is
+ * set, or NULL if the chunk does not exist
+ */
+static double *get_element(DArray *a, size_t pos, bool alloc)
 {
-    pthread_mutex_lock(&a->mutex);
-    if (a->used == a->size)
+    // chunk k starts at position size * (2^k - 1)
+    size_t q = pos / a->size + 1;
+    int k = 0;
+    while (q >>= 1)
+    {
+        k++;
+    }
+    if (k >= DARRAY_MAX_CHUNKS)
+    {
+        return NULL;
+    }
+    size_t offset = pos - a->size * (((size_t)1 << k) - 1);
+
+    double *chunk = __atomic_load_n(&a->chunks->chunk[k], __ATOMIC_ACQUIRE);
+    if (chunk == NULL && alloc)
     {
-        a->size *= 2;
-		double *temp;
-		temp = a->array;
-		temp += (a->size / 2);
-		memset(temp, 0.0, (a->size / 2) * sizeof(double));
-        a->array = (double *)realloc(a->array, a->size * sizeof(double));
+        double *new_chunk = calloc(a->size << k, sizeof(*new_chunk));
+        if (new_chunk == NULL)
+        {
+            return NULL;
+        }
+        // another thread may have added the chunk in the meantime
+        if (__atomic_compare_exchange_n(&a->chunks->chunk[k], &chunk, new_chunk, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            chunk = new_chunk;
+        }
+        else
+        {
+            free(new_chunk);
+        }
     }
-    a->array[a->used++] = e;
-    pthread_mutex_unlock(&a->mutex);
+
+    return chunk ? &chunk[offset] : NULL;
 }
 
-void insert_array_at(DArray *a, double e, int pos)
+int init_array(DArray *a, size_t init_size)
 {
-    pthread_mutex_lock(&a->mutex);
-    if ((pos+1) > a->used)
+    a->size = init_size ? init_size : 1;
+    a->chunks = calloc(1, sizeof(*a->chunks));
+    if (a->chunks == NULL)
+    {
+        return -ENOMEM;
+    }
+    // preallocate the first chunk, it holds all frames of most videos
+    if (get_element(a, 0, true) == NULL)
     {
-        a->used = pos+1;
+        free(a->chunks);
+        a->chunks = NULL;
+        return -ENOMEM;
     }
+    return 0;
+}
 
-    while (a->used > a->size)
+static void store_element(DArray *a, double e, size_t pos)
+{
+    double *element = get_element(a, pos, true);
+    if (element == NULL)
     {
-        a->size *= 2;
-        a->array = (double *)realloc(a->array, a->size * sizeof(double));
-		double *temp;
-		temp = a->array;
-		temp += (a->size / 2);
-		memset(temp, 0.0, (a->size / 2) * sizeof(double));
+        return;
     }
-    a->array[pos] = e;
-    pthread_mutex_unlock(&a->mutex);
+    __atomic_store(element, &e, __ATOMIC_RELEASE);
+}
+
+void insert_array(DArray *a, double e)
+{
+    size_t pos = __atomic_fetch_add(&a->chunks->used, 1, __ATOMIC_RELAXED);
+    store_element(a, e, pos);
+}
+
+void insert_array_at(DArray *a, double e, int pos)
+{
+    store_element(a, e, pos);
+
+    size_t used = __atomic_load_n(&a->chunks->used, __ATOMIC_RELAXED);
+    while (used < (size_t)pos + 1 &&
+           !__atomic_compare_exchange_n(&a->chunks->used, &used, (size_t)pos + 1, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
 }
 
 double get_at(DArray *a, int pos)
 {
-    return a->array[pos];
+    double e = 0.0;
+    double *element = get_element(a, pos, false);
+    if (element)
+    {
+        __atomic_load(element, &e, __ATOMIC_ACQUIRE);
+    }
+    return e;
+}
+
+size_t get_used(DArray *a)
+{
+    return __atomic_load_n(&a->chunks->used, __ATOMIC_RELAXED);
 }
 
 void free_array(DArray *a)
 {
-    free(a->array);
-    a->array = NULL;
-    a->used = a->size = 0;
-    pthread_mutex_destroy(&a->mutex);
+    if (a->chunks == NULL)
+    {
+        return;
+    }
+    for (int k = 0; k < DARRAY_MAX_CHUNKS; k++)
+    {
+        free(a->chunks->chunk[k]);
+    }
+    free(a->chunks);
+    a->chunks = NULL;
 }
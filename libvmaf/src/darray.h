@@ -25,21 +25,30 @@
 extern "C" {
 #endif
 
-#include <pthread.h>
+#include <stddef.h>
+
+/*
+ * Array of doubles indexed by frame. The storage grows in chunks that are
+ * never moved: chunk k holds size << k elements. Inserts to distinct
+ * positions and reads are lock-free and may be called concurrently, a
+ * position that was never written reads as 0. init_array returns -ENOMEM
+ * when the first chunk cannot be allocated, free_array may be called after
+ * a failed init_array.
+ */
+struct DARRAY_CHUNKS;
 
 typedef struct
 {
-    double *array;
-    size_t used;
+    struct DARRAY_CHUNKS *chunks;
     size_t size;
-    pthread_mutex_t mutex;
 } DArray;
 
-void init_array(DArray *a, size_t init_size);
+int init_array(DArray *a, size_t init_size);
 void insert_array(DArray *a, double e);
 void insert_array_at(DArray *a, double e, int pos);
 void free_array(DArray *a);
 double get_at(DArray *a, int pos);
+size_t get_used(DArray *a);
 
 #ifdef __cplusplus
 }
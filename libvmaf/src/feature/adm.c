@@ -16,16 +16,20 @@
  *
  */
 
+#include <errno.h>
 #include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "mem.h"
 #include "adm_options.h"
+#include "adm.h"
 #include "adm_tools.h"
 #include "offset.h"
+#include "thread_pool.h"
 
 typedef adm_dwt_band_t_s adm_dwt_band_t;
 
@@ -40,6 +44,16 @@ typedef adm_dwt_band_t_s adm_dwt_band_t;
 #define adm_csf_den_scale adm_csf_den_scale_s
 #define dwt2_src_indices_filt dwt2_src_indices_filt_s
 
+#define adm_dwt2_rows          adm_dwt2_rows_s
+#define adm_decouple_rows      adm_decouple_rows_s
+#define adm_csf_rows           adm_csf_rows_s
+#define adm_cm_rows            adm_cm_rows_s
+#define adm_csf_den_scale_rows adm_csf_den_scale_rows_s
+#define adm_sum_rows           adm_sum_rows_s
+
+/* stripes smaller than this are not worth a thread */
+#define ADM_STRIPE_MIN_ROWS 16
+
 static char *init_dwt_band(adm_dwt_band_t *band, char *data_top, size_t buf_sz_one)
 {
     band->band_a = (float *)data_top; data_top += buf_sz_one;
@@ -272,6 +286,263 @@ fail:
 	return ret;
 }
 
+struct AdmRefState
+{
+	int start_scale;
+	int w, h;
+	int buf_stride;
+	float *data_buf;
+	char *buf_y_orig;
+	char *buf_x_orig;
+	int *ind_y[4], *ind_x[4];
+
+	/* optional, every scale runs in horizontal stripes on it */
+	VmafThreadPool *pool;
+	/* per row sums of a scale, for the den (reference) or num (distorted) scale */
+	float (*row_sums)[3];
+
+	/* reference side, per scale */
+	adm_dwt_band_t ref_dwt2[4];
+	float den_scale[4];
+
+	/* distorted side, reused for every distorted picture */
+	adm_dwt_band_t dis_dwt2;
+	float *dis_band_a[2]; /* alternates, as the next scale reads it while written */
+	adm_dwt_band_t decouple_r;
+	adm_dwt_band_t decouple_a;
+	adm_dwt_band_t csf_a;
+	adm_dwt_band_t csf_f;
+};
+
+int adm_ref_state_init(AdmRefState **state, int w, int h, int start_scale, VmafThreadPool *pool)
+{
+	AdmRefState *s;
+	char *data_top;
+	int buf_stride = ALIGN_CEIL(((w + 1) / 2) * sizeof(float));
+	size_t buf_sz_one = (size_t)buf_stride * ((h + 1) / 2);
+	int ind_size_y = ALIGN_CEIL(((h + 1) / 2) * sizeof(int));
+	int ind_size_x = ALIGN_CEIL(((w + 1) / 2) * sizeof(int));
+
+	// 4 dwt bands for each of the 4 reference scales, and the 17 buffers of the distorted side
+#define NUM_BUFS_ADM_REF 33
+	if (SIZE_MAX / buf_sz_one < NUM_BUFS_ADM_REF)
+		return -EINVAL;
+
+	if (!(s = *state = malloc(sizeof(*s))))
+		return -ENOMEM;
+	memset(s, 0, sizeof(*s));
+	s->start_scale = start_scale;
+	s->w = w;
+	s->h = h;
+	s->buf_stride = buf_stride;
+	s->pool = pool;
+
+	if (!(s->row_sums = malloc(sizeof(*s->row_sums) * ((h + 1) / 2 + 1))))
+		goto fail;
+	if (!(s->data_buf = aligned_malloc(buf_sz_one * NUM_BUFS_ADM_REF, MAX_ALIGN)))
+		goto fail;
+	if (!(s->buf_y_orig = aligned_malloc(ind_size_y * 4, MAX_ALIGN)))
+		goto fail;
+	if (!(s->buf_x_orig = aligned_malloc(ind_size_x * 4, MAX_ALIGN)))
+		goto fail;
+
+	data_top = (char *)s->data_buf;
+	for (int scale = 0; scale < 4; ++scale)
+		data_top = init_dwt_band(&s->ref_dwt2[scale], data_top, buf_sz_one);
+	data_top = init_dwt_band(&s->dis_dwt2, data_top, buf_sz_one);
+	s->dis_band_a[0] = s->dis_dwt2.band_a;
+	s->dis_band_a[1] = (float *)data_top; data_top += buf_sz_one;
+	data_top = init_dwt_band_hvd(&s->decouple_r, data_top, buf_sz_one);
+	data_top = init_dwt_band_hvd(&s->decouple_a, data_top, buf_sz_one);
+	data_top = init_dwt_band_hvd(&s->csf_a, data_top, buf_sz_one);
+	data_top = init_dwt_band_hvd(&s->csf_f, data_top, buf_sz_one);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		s->ind_y[i] = (int *)(s->buf_y_orig + i * ind_size_y);
+		s->ind_x[i] = (int *)(s->buf_x_orig + i * ind_size_x);
+	}
+
+	return 0;
+
+fail:
+	adm_ref_state_destroy(s);
+	*state = NULL;
+	return -ENOMEM;
+}
+
+void adm_ref_state_destroy(AdmRefState *s)
+{
+	if (!s)
+		return;
+	aligned_free(s->data_buf);
+	aligned_free(s->buf_y_orig);
+	aligned_free(s->buf_x_orig);
+	free(s->row_sums);
+	free(s);
+}
+
+/* One scale of compute_adm_ref() or compute_adm_dis(), split in stripes of its output rows */
+typedef struct AdmStripes
+{
+	AdmRefState *s;
+	int scale;
+	int w, h; /* of the scale input */
+	const float *src;
+	int src_stride;
+	int den_cached;
+	double border_factor;
+} AdmStripes;
+
+static void adm_ref_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+	AdmStripes *st = data;
+	AdmRefState *s = st->s;
+	int w = (st->w + 1) / 2;
+	int h = (st->h + 1) / 2;
+
+	adm_dwt2_rows(st->src, &s->ref_dwt2[st->scale], s->ind_y, s->ind_x, st->w, st->src_stride, s->buf_stride, row_begin, row_end);
+	if (!st->den_cached)
+		adm_csf_den_scale_rows(&s->ref_dwt2[st->scale], s->h, st->scale, w, h, s->buf_stride, st->border_factor, row_begin, row_end, s->row_sums + row_begin);
+}
+
+/* the DWT and the pointwise decoupling and CSF of the rows */
+static void adm_dis_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+	AdmStripes *st = data;
+	AdmRefState *s = st->s;
+	int buf_stride = s->buf_stride;
+	int w = (st->w + 1) / 2;
+	int h = (st->h + 1) / 2;
+
+	adm_dwt2_rows(st->src, &s->dis_dwt2, s->ind_y, s->ind_x, st->w, st->src_stride, buf_stride, row_begin, row_end);
+
+	/* skipped scales only provide the approximation band of the next */
+	if (st->scale < s->start_scale)
+		return;
+
+	adm_decouple_rows(&s->ref_dwt2[st->scale], &s->dis_dwt2, &s->decouple_r, &s->decouple_a, w, h, buf_stride, buf_stride, buf_stride, buf_stride, st->border_factor, row_begin, row_end);
+	adm_csf_rows(&s->decouple_a, &s->csf_a, &s->csf_f, s->h, st->scale, w, h, buf_stride, buf_stride, st->border_factor, row_begin, row_end);
+}
+
+/* the contrast masking reads the CSF bands of the rows above and below */
+static void adm_cm_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+	AdmStripes *st = data;
+	AdmRefState *s = st->s;
+	int buf_stride = s->buf_stride;
+	int w = (st->w + 1) / 2;
+	int h = (st->h + 1) / 2;
+
+	adm_cm_rows(&s->decouple_r, &s->csf_f, &s->csf_a, w, h, buf_stride, buf_stride, buf_stride, st->border_factor, st->scale, row_begin, row_end, s->row_sums + row_begin);
+}
+
+int compute_adm_ref(AdmRefState *s, const float *ref, int ref_stride, float *den_scale, int den_cached, double border_factor)
+{
+	AdmStripes st = { .s = s, .src = ref, .src_stride = ref_stride, .den_cached = den_cached, .border_factor = border_factor };
+	int w = s->w;
+	int h = s->h;
+	int err;
+
+	for (int scale = 0; scale < 4; ++scale)
+	{
+		dwt2_src_indices_filt(s->ind_y, s->ind_x, w, h);
+		st.scale = scale;
+		st.w = w;
+		st.h = h;
+		err = vmaf_thread_pool_stripes(s->pool, (h + 1) / 2, ADM_STRIPE_MIN_ROWS, adm_ref_stripe, &st);
+		if (err)
+			return err;
+
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+
+		if (den_cached)
+			s->den_scale[scale] = den_scale[scale];
+		else
+			s->den_scale[scale] = adm_sum_rows((const float (*)[3])s->row_sums, h, w, h, border_factor);
+		if (den_scale)
+			den_scale[scale] = s->den_scale[scale];
+
+		st.src = s->ref_dwt2[scale].band_a;
+		st.src_stride = s->buf_stride;
+	}
+
+	return 0;
+}
+
+int compute_adm_dis(AdmRefState *s, const float *dis, int dis_stride, double *score, double *score_num, double *score_den, double *scores, double border_factor)
+{
+#ifdef ADM_OPT_SINGLE_PRECISION
+	double numden_limit = 1e-2 * (s->w * s->h) / (1920.0 * 1080.0);
+#else
+	double numden_limit = 1e-10 * (s->w * s->h) / (1920.0 * 1080.0);
+#endif
+	AdmStripes st = { .s = s, .src = dis, .src_stride = dis_stride, .border_factor = border_factor };
+	int w = s->w;
+	int h = s->h;
+	int err;
+
+	double num = 0;
+	double den = 0;
+
+	for (int scale = 0; scale < 4; ++scale)
+	{
+		float num_scale = 0.0;
+
+		dwt2_src_indices_filt(s->ind_y, s->ind_x, w, h);
+		s->dis_dwt2.band_a = s->dis_band_a[scale & 1];
+		st.scale = scale;
+		st.w = w;
+		st.h = h;
+		err = vmaf_thread_pool_stripes(s->pool, (h + 1) / 2, ADM_STRIPE_MIN_ROWS, adm_dis_stripe, &st);
+		if (err)
+			return err;
+
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+
+		st.src = s->dis_dwt2.band_a;
+		st.src_stride = s->buf_stride;
+
+		if (scale < s->start_scale)
+		{
+			den += s->den_scale[scale];
+			scores[2 * scale + 0] = 0.0;
+			scores[2 * scale + 1] = s->den_scale[scale];
+			continue;
+		}
+
+		err = vmaf_thread_pool_stripes(s->pool, h, ADM_STRIPE_MIN_ROWS, adm_cm_stripe, &st);
+		if (err)
+			return err;
+		/* the last row comes in one more entry */
+		num_scale = adm_sum_rows((const float (*)[3])s->row_sums, h + 1, w, h, border_factor);
+
+		num += num_scale;
+		den += s->den_scale[scale];
+
+		scores[2 * scale + 0] = num_scale;
+		scores[2 * scale + 1] = s->den_scale[scale];
+	}
+
+	num = num < numden_limit ? 0 : num;
+	den = den < numden_limit ? 0 : den;
+
+	if (den == 0.0)
+	{
+		*score = 1.0f;
+	}
+	else
+	{
+		*score = num / den;
+	}
+	*score_num = num;
+	*score_den = den;
+
+	return 0;
+}
+
 int adm(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt)
 {
     double score = 0;
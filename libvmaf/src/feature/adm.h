@@ -1,4 +1,29 @@
+#include "thread_pool.h"
+
 int compute_adm(const float *ref, const float *dis, int w, int h,
                 int ref_stride, int dis_stride, double *score,
                 double *score_num, double *score_den, double *scores,
                 double border_factor);
+
+/*
+ * compute_adm() split in a reference pass and a distorted pass, so that the
+ * reference side (DWT and CSF denominators of every scale) is computed once
+ * and shared by several distorted pictures of the same reference.
+ * The 4 CSF denominators are returned in den_scale (if not NULL), or taken
+ * from it without being computed if den_cached is set.
+ * The numerators of scales below start_scale are not computed and 0.
+ * With a pool, every scale is split in horizontal stripes run on it.
+ */
+typedef struct AdmRefState AdmRefState;
+
+int adm_ref_state_init(AdmRefState **state, int w, int h, int start_scale,
+                       VmafThreadPool *pool);
+
+int compute_adm_ref(AdmRefState *state, const float *ref, int ref_stride,
+                    float *den_scale, int den_cached, double border_factor);
+
+int compute_adm_dis(AdmRefState *state, const float *dis, int dis_stride,
+                    double *score, double *score_num, double *score_den,
+                    double *scores, double border_factor);
+
+void adm_ref_state_destroy(AdmRefState *state);
@@ -91,7 +91,7 @@ float adm_sum_cube_s(const float *x, int w, int h, int stride, double border_fac
     return powf(accum, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
 }
 
-void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a, int w, int h, int ref_stride, int dis_stride, int r_stride, int a_stride, double border_factor)
+void adm_decouple_rows_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a, int w, int h, int ref_stride, int dis_stride, int r_stride, int a_stride, double border_factor, int row_begin, int row_end)
 {
 #ifdef ADM_OPT_AVOID_ATAN
 	const float cos_1deg_sq = cos(1.0 * M_PI / 180.0) * cos(1.0 * M_PI / 180.0);
@@ -121,6 +121,12 @@ void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, co
 	if (bottom > h) {
 		bottom = h;
 	}
+	if (top < row_begin) {
+		top = row_begin;
+	}
+	if (bottom > row_end) {
+		bottom = row_end;
+	}
 
 	float oh, ov, od, th, tv, td;
 	float kh, kv, kd, tmph, tmpv, tmpd;
@@ -208,7 +214,12 @@ void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, co
 	}
 }
 
-void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *flt, int orig_h, int scale, int w, int h, int src_stride, int dst_stride, double border_factor)
+void adm_decouple_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a, int w, int h, int ref_stride, int dis_stride, int r_stride, int a_stride, double border_factor)
+{
+	adm_decouple_rows_s(ref, dis, r, a, w, h, ref_stride, dis_stride, r_stride, a_stride, border_factor, 0, h);
+}
+
+void adm_csf_rows_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *flt, int orig_h, int scale, int w, int h, int src_stride, int dst_stride, double border_factor, int row_begin, int row_end)
 {
 	const float *src_angles[3] = { src->band_h, src->band_v, src->band_d };
 	float *dst_angles[3] = { dst->band_h, dst->band_v, dst->band_d };
@@ -245,6 +256,12 @@ void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const a
 	if (bottom > h) {
 		bottom = h;
 	}
+	if (top < row_begin) {
+		top = row_begin;
+	}
+	if (bottom > row_end) {
+		bottom = row_end;
+	}
 
 	int i, j, theta, src_offset, dst_offset;
 	float dst_val;
@@ -267,8 +284,38 @@ void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const a
 	}
 }
 
-/* Combination of adm_csf_s and adm_sum_cube_s for csf_o based den_scale */
-float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, int w, int h, int src_stride, double border_factor)
+void adm_csf_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *flt, int orig_h, int scale, int w, int h, int src_stride, int dst_stride, double border_factor)
+{
+	adm_csf_rows_s(src, dst, flt, orig_h, scale, w, h, src_stride, dst_stride, border_factor, 0, h);
+}
+
+float adm_sum_rows_s(const float (*accum)[3], int n_rows, int w, int h, double border_factor)
+{
+	float accum_h = 0, accum_v = 0, accum_d = 0;
+	float scale_h, scale_v, scale_d;
+
+	int left = w * border_factor - 0.5;
+	int top = h * border_factor - 0.5;
+	int right = w - left;
+	int bottom = h - top;
+
+	int i;
+
+	for (i = 0; i < n_rows; ++i) {
+		accum_h += accum[i][0];
+		accum_v += accum[i][1];
+		accum_d += accum[i][2];
+	}
+
+	scale_h = powf(accum_h, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+	scale_v = powf(accum_v, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+	scale_d = powf(accum_d, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+
+	return (scale_h + scale_v + scale_d);
+}
+
+/* Combination of adm_csf_s and adm_sum_cube_s for csf_o based den_scale, per row */
+void adm_csf_den_scale_rows_s(const adm_dwt_band_t_s *src, int orig_h, int scale, int w, int h, int src_stride, double border_factor, int row_begin, int row_end, float (*accum)[3])
 {
 	float *src_h = src->band_h, *src_v = src->band_v, *src_d = src->band_d;
 
@@ -280,9 +327,7 @@ float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, in
 	float factor2 = dwt_quant_step(&dwt_7_9_YCbCr_threshold[0], scale, 2);
 	float rfactor[3] = { 1.0f / factor1, 1.0f / factor1, 1.0f / factor2 };
 
-	float accum_h = 0, accum_v = 0, accum_d = 0;
 	float accum_inner_h, accum_inner_v, accum_inner_d;
-	float den_scale_h, den_scale_v, den_scale_d;
 
 	float val;
 	
@@ -294,10 +339,16 @@ float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, in
 
 	int i, j;
 
-	for (i = top; i < bottom; ++i) {
+	for (i = row_begin; i < row_end; ++i) {
 		accum_inner_h = 0;
 		accum_inner_v = 0;
 		accum_inner_d = 0;
+		if (i < top || i >= bottom) {
+			accum[i - row_begin][0] = 0;
+			accum[i - row_begin][1] = 0;
+			accum[i - row_begin][2] = 0;
+			continue;
+		}
 		src_h = src->band_h + i * src_px_stride;
 		src_v = src->band_v + i * src_px_stride;
 		src_d = src->band_d + i * src_px_stride;
@@ -314,21 +365,28 @@ float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, in
 			accum_inner_d += val;
 		}
 
-		accum_h += accum_inner_h;
-		accum_v += accum_inner_v;
-		accum_d += accum_inner_d;
-
+		accum[i - row_begin][0] = accum_inner_h;
+		accum[i - row_begin][1] = accum_inner_v;
+		accum[i - row_begin][2] = accum_inner_d;
 	}
+}
 
-	den_scale_h = powf(accum_h, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
-	den_scale_v = powf(accum_v, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
-	den_scale_d = powf(accum_d, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
-
-	return(den_scale_h + den_scale_v + den_scale_d);
+float adm_csf_den_scale_s(const adm_dwt_band_t_s *src, int orig_h, int scale, int w, int h, int src_stride, double border_factor)
+{
+	float row[1][3], accum[1][3] = { { 0, 0, 0 } };
+	int i;
+
+	for (i = 0; i < h; ++i) {
+		adm_csf_den_scale_rows_s(src, orig_h, scale, w, h, src_stride, border_factor, i, i + 1, row);
+		accum[0][0] += row[0][0];
+		accum[0][1] += row[0][1];
+		accum[0][2] += row[0][2];
+	}
 
+	return adm_sum_rows_s((const float (*)[3])accum, 1, w, h, border_factor);
 }
 
-float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, int w, int h, int src_stride, int flt_stride, int csf_a_stride, double border_factor, int scale)
+void adm_cm_rows_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, int w, int h, int src_stride, int flt_stride, int csf_a_stride, double border_factor, int scale, int row_begin, int row_end, float (*accum)[3])
 {
 	/* Take decouple_r as src and do dsf_s on decouple_r here to get csf_r */
 	float *src_h = src->band_h, *src_v = src->band_v, *src_d = src->band_d;
@@ -349,9 +407,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	float xh, xv, xd, thr;
 
 	float val;
-	float accum_h = 0, accum_v = 0, accum_d = 0;
 	float accum_inner_h, accum_inner_v, accum_inner_d;
-	float num_scale_h, num_scale_v, num_scale_d;
 	
 	/* The computation of the scales is not required for the regions which lie outside the frame borders */
 	int left = w * border_factor - 0.5;
@@ -364,13 +420,30 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	int start_row = (top > 1) ? top : 1;
 	int end_row = (bottom < (h - 1)) ? bottom : (h - 1);
 
+	/* The first and last rows are only computed by the stripes containing them */
+	int first_row = (top <= 0) && (row_begin == 0);
+	int last_row = (bottom > (h - 1)) && (row_end == h);
+
 	int i, j;
 
+	if (start_row < row_begin) {
+		start_row = row_begin;
+	}
+	if (end_row > row_end) {
+		end_row = row_end;
+	}
+
+	for (i = row_begin; i < row_end + (row_end == h); ++i) {
+		accum[i - row_begin][0] = 0;
+		accum[i - row_begin][1] = 0;
+		accum[i - row_begin][2] = 0;
+	}
+
 	/* i=0,j=0 */
 	accum_inner_h = 0;
 	accum_inner_v = 0;
 	accum_inner_d = 0;
-	if ((top <= 0) && (left <= 0))
+	if (first_row && (left <= 0))
 	{
 		xh = src->band_h[0] * rfactor[0];
 		xv = src->band_v[0] * rfactor[1];
@@ -395,7 +468,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	}
 
 	/* i=0, j */
-	if (top <= 0) {
+	if (first_row) {
 		for (j = start_col; j < end_col; ++j) {
 			xh = src->band_h[j] * rfactor[0];
 			xv = src->band_v[j] * rfactor[1];
@@ -421,7 +494,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	}
 
 	/* i=0,j=w-1 */
-	if ((top <= 0) && (right > (w - 1)))
+	if (first_row && (right > (w - 1)))
 	{
 		xh = src->band_h[w - 1] * rfactor[0];
 		xv = src->band_v[w - 1] * rfactor[1];
@@ -445,9 +518,11 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 
 	}
 
-	accum_h += accum_inner_h;
-	accum_v += accum_inner_v;
-	accum_d += accum_inner_d;
+	if (first_row) {
+		accum[0][0] = accum_inner_h;
+		accum[0][1] = accum_inner_v;
+		accum[0][2] = accum_inner_d;
+	}
 
 	if ((left > 0) && (right <= (w - 1))) /* Completely within frame */
 	{
@@ -477,9 +552,9 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_d += val;
 
 		}
-			accum_h += accum_inner_h;
-			accum_v += accum_inner_v;
-			accum_d += accum_inner_d;
+			accum[i - row_begin][0] = accum_inner_h;
+			accum[i - row_begin][1] = accum_inner_v;
+			accum[i - row_begin][2] = accum_inner_d;
 	}
 	}
 	else if ((left <= 0) && (right <= (w - 1))) /* Right border within frame, left outside */
@@ -534,9 +609,9 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 				accum_inner_d += val;
 
 			}
-	accum_h += accum_inner_h;
-	accum_v += accum_inner_v;
-	accum_d += accum_inner_d;
+	accum[i - row_begin][0] = accum_inner_h;
+	accum[i - row_begin][1] = accum_inner_v;
+	accum[i - row_begin][2] = accum_inner_d;
 		}
 	}
 	else if ((left > 0) && (right > (w - 1))) /* Left border within frame, right outside */
@@ -589,9 +664,9 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			val = (xd * xd * xd);
 			accum_inner_d += val;
 
-			accum_h += accum_inner_h;
-			accum_v += accum_inner_v;
-			accum_d += accum_inner_d;
+			accum[i - row_begin][0] = accum_inner_h;
+			accum[i - row_begin][1] = accum_inner_v;
+			accum[i - row_begin][2] = accum_inner_d;
 		}
 	}
 	else /* Both borders outside frame */
@@ -666,9 +741,9 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 		val = (xd * xd * xd);
 		accum_inner_d += val;
 
-			accum_h += accum_inner_h;
-			accum_v += accum_inner_v;
-			accum_d += accum_inner_d;
+			accum[i - row_begin][0] = accum_inner_h;
+			accum[i - row_begin][1] = accum_inner_v;
+			accum[i - row_begin][2] = accum_inner_d;
 	}
 	}
 	accum_inner_h = 0;
@@ -676,7 +751,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	accum_inner_d = 0;
 
 	/* i=h-1,j=0 */
-	if ((bottom > (h - 1)) && (left <= 0))
+	if (last_row && (left <= 0))
 	{
 		xh = src->band_h[(h - 1) * src_px_stride] * rfactor[0];
 		xv = src->band_v[(h - 1) * src_px_stride] * rfactor[1];
@@ -701,7 +776,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	}
 
 	/* i=h-1,j */
-	if (bottom > (h - 1)) {
+	if (last_row) {
 		for (j = start_col; j < end_col; ++j) {
 			xh = src->band_h[(h - 1) * src_px_stride + j] * rfactor[0];
 			xv = src->band_v[(h - 1) * src_px_stride + j] * rfactor[1];
@@ -727,7 +802,7 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 	}
 
 	/* i-h-1,j=w-1 */
-	if ((bottom > (h - 1)) && (right > (w - 1)))
+	if (last_row && (right > (w - 1)))
 	{
 		xh = src->band_h[(h - 1) * src_px_stride + w - 1] * rfactor[0];
 		xv = src->band_v[(h - 1) * src_px_stride + w - 1] * rfactor[1];
@@ -750,17 +825,29 @@ float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const
 			accum_inner_d += val;
 
 		}
-		accum_h += accum_inner_h;
-		accum_v += accum_inner_v;
-		accum_d += accum_inner_d;
-	
-
+	if (last_row) {
+		accum[h - row_begin][0] = accum_inner_h;
+		accum[h - row_begin][1] = accum_inner_v;
+		accum[h - row_begin][2] = accum_inner_d;
+	}
+}
 
-	num_scale_h = powf(accum_h, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
-	num_scale_v = powf(accum_v, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
-	num_scale_d = powf(accum_d, 1.0f / 3.0f) + powf((bottom - top) * (right - left) / 32.0f, 1.0f / 3.0f);
+float adm_cm_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *csf_f, const adm_dwt_band_t_s *csf_a, int w, int h, int src_stride, int flt_stride, int csf_a_stride, double border_factor, int scale)
+{
+	float row[2][3], accum[1][3] = { { 0, 0, 0 } };
+	int i, k;
+
+	for (i = 0; i < h; ++i) {
+		adm_cm_rows_s(src, csf_f, csf_a, w, h, src_stride, flt_stride, csf_a_stride, border_factor, scale, i, i + 1, row);
+		/* the last row comes in an extra entry */
+		for (k = 0; k < 1 + (i == h - 1); ++k) {
+			accum[0][0] += row[k][0];
+			accum[0][1] += row[k][1];
+			accum[0][2] += row[k][2];
+		}
+	}
 
-	return (num_scale_h + num_scale_v + num_scale_d);
+	return adm_sum_rows_s((const float (*)[3])accum, 1, w, h, border_factor);
 }
 
 // This function stores the imgcoeff values used in adm_dwt2_s in buffers, which reduces the control code cycles.
@@ -812,7 +899,7 @@ void dwt2_src_indices_filt_s(int **src_ind_y, int **src_ind_x, int w, int h)
 	}
 }
 
-void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride)
+void adm_dwt2_rows_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int src_stride, int dst_stride, int row_begin, int row_end)
 {
 	const float *filter_lo = dwt2_db2_coeffs_lo_s;
 	const float *filter_hi = dwt2_db2_coeffs_hi_s;
@@ -830,7 +917,7 @@ void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int
 	int i, j, fi, fj, ii, jj;
 	int j0, j1, j2, j3;
 
-	for (i = 0; i < (h + 1) / 2; ++i) {
+	for (i = row_begin; i < row_end; ++i) {
 		/* Vertical pass. */
 		for (j = 0; j < w; ++j) {
 			s0 = src[ind_y[0][i] * src_px_stride + j];
@@ -905,6 +992,11 @@ void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int
 	aligned_free(tmphi);
 }
 
+void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride)
+{
+	adm_dwt2_rows_s(src, dst, ind_y, ind_x, w, src_stride, dst_stride, 0, (h + 1) / 2);
+}
+
 void adm_buffer_copy(const void *src, void *dst, int linewidth, int h, int src_stride, int dst_stride)
 {
     const char *src_p = src;
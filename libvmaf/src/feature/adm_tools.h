@@ -268,6 +268,28 @@ void dwt2_src_indices_filt_s(int **src_ind_y, int **src_ind_x, int w, int h);
 
 void adm_dwt2_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int h, int src_stride, int dst_stride);
 
+/*
+ * Row range versions of the above, for horizontal stripes processed in
+ * parallel: only the output rows [row_begin, row_end) are written, the rows
+ * around them are read from the complete input. adm_dwt2_rows_s() counts the
+ * rows of its output, (h + 1) / 2 for an input h rows high.
+ * The sums are returned per row, accum[i - row_begin] for row i, and
+ * adm_cm_rows_s() returns the last row in one more entry, accum[h - row_begin],
+ * when row_end == h. adm_sum_rows_s() reduces them in row order, which makes
+ * the result independent of the striping.
+ */
+void adm_decouple_rows_s(const adm_dwt_band_t_s *ref, const adm_dwt_band_t_s *dis, const adm_dwt_band_t_s *r, const adm_dwt_band_t_s *a, int w, int h, int ref_stride, int dis_stride, int r_stride, int a_stride, double border_factor, int row_begin, int row_end);
+
+void adm_csf_rows_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *flt, int orig_h, int scale, int w, int h, int src_stride, int dst_stride, double border_factor, int row_begin, int row_end);
+
+void adm_csf_den_scale_rows_s(const adm_dwt_band_t_s *src, int orig_h, int scale, int w, int h, int src_stride, double border_factor, int row_begin, int row_end, float (*accum)[3]);
+
+void adm_cm_rows_s(const adm_dwt_band_t_s *src, const adm_dwt_band_t_s *dst, const adm_dwt_band_t_s *csf_a, int w, int h, int src_stride, int dst_stride, int csf_a_stride, double border_factor, int scale, int row_begin, int row_end, float (*accum)[3]);
+
+float adm_sum_rows_s(const float (*accum)[3], int n_rows, int w, int h, double border_factor);
+
+void adm_dwt2_rows_s(const float *src, const adm_dwt_band_t_s *dst, int **ind_y, int **ind_x, int w, int src_stride, int dst_stride, int row_begin, int row_end);
+
 /* ================= */
 /* Noise floor model */
 /* ================= */
@@ -5,32 +5,73 @@
  *      Author: thomas
  */
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include "blur_array.h"
 
+/*
+ * the slot state packs the frame index (upper 32 bits, -1 if the slot is
+ * free) and the reference count (lower 32 bits) into one word, so that
+ * both can be checked and updated by a single compare and swap, state is
+ * only accessed through the __atomic builtins
+ */
+struct BLUR_BUF_SLOT
+{
+    uint64_t state;
+    float *blur_buf;
+};
+
+#define SLOT_FREE ((uint64_t)UINT32_MAX << 32)
+
+static inline uint64_t slot_state(int frame_idx, uint32_t reference_count)
+{
+    return ((uint64_t)(uint32_t)frame_idx << 32) | reference_count;
+}
+
+static inline int slot_frame_idx(uint64_t state)
+{
+    return (int)(uint32_t)(state >> 32);
+}
+
+static inline uint32_t slot_reference_count(uint64_t state)
+{
+    return (uint32_t)state;
+}
+
+static inline struct BLUR_BUF_SLOT* get_slot(BLUR_BUF_ARRAY* arr, int frame_idx)
+{
+    if (frame_idx < 0 || arr->actual_length <= 0)
+        return NULL;
+    return &arr->blur_buf_array[frame_idx % arr->actual_length];
+}
+
 /*
  * initializes an array of blurred buffers
  */
 int init_blur_array(BLUR_BUF_ARRAY* arr, int array_length, size_t size, size_t alignement)
 {
-    // we can't go beyond the max number of threads
-    if (array_length > MAX_NUM_THREADS)
+    arr->blur_buf_array = NULL;
+    arr->actual_length = 0;
+    arr->buffer_size = size;
+
+    if (array_length <= 0)
+        return 0;
+
+    arr->blur_buf_array = calloc(array_length, sizeof(*arr->blur_buf_array));
+    if (arr->blur_buf_array == 0)
         return 0;
 
     for (int i = 0; i < array_length; i++)
     {
-        arr->blur_buf_array[i].frame_idx = -1;
+        arr->blur_buf_array[i].state = SLOT_FREE;
         arr->blur_buf_array[i].blur_buf = aligned_malloc(size, alignement);
-		arr->blur_buf_array[i].reference_count	= 0;
         if (arr->blur_buf_array[i].blur_buf == 0)
             return 0;
 
-        arr->buffer_size = size;
         arr->actual_length = i + 1;
     }
 
-    pthread_mutex_init(&arr->block, NULL);
-
     return 1;
 }
 
@@ -39,61 +80,36 @@ int init_blur_array(BLUR_BUF_ARRAY* arr, int array_length, size_t size, size_t a
  */
 float* get_blur_buf(BLUR_BUF_ARRAY* arr, int search_frame_idx)
 {
-    int array_length = arr->actual_length;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-	float *ret = NULL;
+    struct BLUR_BUF_SLOT* s = get_slot(arr, search_frame_idx);
+    if (!s)
+        return NULL;
 
-    pthread_mutex_lock(&arr->block);
-
-    for (int i = 0; i < array_length; i++)
+    /* Increment reference counter */
+    uint64_t state = __atomic_load_n(&s->state, __ATOMIC_SEQ_CST);
+    do
     {
-		if (s->frame_idx == search_frame_idx)
-		{
-			/* Increment reference counter */
-			s->reference_count++;
-			
-			ret = s->blur_buf;
-			break;
-		}
-
-		// next array item
-		s++;
-     }  
-
-    pthread_mutex_unlock(&arr->block);
-
-    return ret;
+        if (slot_frame_idx(state) != search_frame_idx)
+            return NULL;
+    } while (!__atomic_compare_exchange_n(&s->state, &state,
+                slot_state(search_frame_idx, slot_reference_count(state) + 1), true,
+                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+
+    return s->blur_buf;
 }
 
 /*
- * finds a free slot in the array, assigns the new frame index and copies the buffer
+ * claims the slot of the frame index and copies the buffer
  */
 int put_blur_buf(BLUR_BUF_ARRAY* arr, int frame_idx, float* blur_buf)
 {
-    int ret = 0;
-    int array_length = arr->actual_length;
-    size_t buf_size = arr->buffer_size;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-
-    pthread_mutex_lock(&arr->block);
-
-    for (int i = 0; i < array_length; i++)
-    {
-        if (s->frame_idx == -1)
-        {
-            memcpy(s->blur_buf, blur_buf, buf_size);
-            s->frame_idx = frame_idx;
-            ret = 1;
-            break;
-        }
-
-        // next array item
-        s++;
-    }
+    float *buf = get_free_blur_buf_slot(arr, frame_idx);
+    if (!buf)
+        return 0;
 
-    pthread_mutex_unlock(&arr->block);
+    memcpy(buf, blur_buf, arr->buffer_size);
+    release_blur_buf_reference(arr, frame_idx);
 
-    return ret;
+    return 1;
 }
 
 /*
@@ -101,35 +117,21 @@ int put_blur_buf(BLUR_BUF_ARRAY* arr, int frame_idx, float* blur_buf)
  */
 int release_blur_buf_slot(BLUR_BUF_ARRAY* arr, int search_frame_idx)
 {
-    int ret = 0;
-    int array_length = arr->actual_length;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-
-    pthread_mutex_lock(&arr->block);
+    struct BLUR_BUF_SLOT* s = get_slot(arr, search_frame_idx);
+    if (!s)
+        return 0;
 
-    for (int i = 0; i < array_length; i++)
+    uint64_t state = __atomic_load_n(&s->state, __ATOMIC_SEQ_CST);
+    do
     {
-        if (s->frame_idx == search_frame_idx)
-        {
-			if(s->reference_count <= 0)
-			{
-				s->frame_idx = -1;
-				ret = 1;
-			}
-			else
-			{
-				ret = -1;
-			}
-            break;
-        }
-
-        // next struct
-        s++;
-    }
-
-    pthread_mutex_unlock(&arr->block);
+        if (slot_frame_idx(state) != search_frame_idx)
+            return 0;
+        if (slot_reference_count(state) > 0)
+            return -1;
+    } while (!__atomic_compare_exchange_n(&s->state, &state, SLOT_FREE, true,
+                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
 
-    return ret;
+    return 1;
 }
 
 /*
@@ -137,51 +139,32 @@ int release_blur_buf_slot(BLUR_BUF_ARRAY* arr, int search_frame_idx)
  */
 void free_blur_buf(BLUR_BUF_ARRAY* arr)
 {
-    int array_length = arr->actual_length;
-    size_t buf_size = arr->buffer_size;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-
-    for (int i = 0; i < array_length; i++)
+    for (int i = 0; i < arr->actual_length; i++)
     {
-        aligned_free(s->blur_buf);
-
-        // next struct
-        s++;
+        aligned_free(arr->blur_buf_array[i].blur_buf);
     }
-
-    pthread_mutex_destroy(&arr->block);
+    free(arr->blur_buf_array);
+    arr->blur_buf_array = NULL;
+    arr->actual_length = 0;
 }
 
 /*
- * finds a free slot in the array, assigns the new frame index and returns the free buffer pointer
+ * claims the slot of the frame index if it is free and returns its buffer pointer,
+ * returns 0 while the slot is still used by the frame actual_length frames before.
  * This increases the reference count for this slot
  */
 float* get_free_blur_buf_slot(BLUR_BUF_ARRAY* arr, int frame_idx)
 {
-    int array_length = arr->actual_length;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-	float *ret = NULL;
-    pthread_mutex_lock(&arr->block);
-	
-    for (int i = 0; i < array_length; i++)
-    {
-        if (s->frame_idx == -1)
-        {			
-            s->frame_idx = frame_idx;
-			
-			/* Increment reference counter */
-			s->reference_count++;
-			
-			ret = s->blur_buf;
-			break;
-        }
-
-        // next array item
-        s++;
-    }
-    pthread_mutex_unlock(&arr->block);
+    struct BLUR_BUF_SLOT* s = get_slot(arr, frame_idx);
+    if (!s)
+        return NULL;
+
+    uint64_t state = SLOT_FREE;
+    if (!__atomic_compare_exchange_n(&s->state, &state, slot_state(frame_idx, 1), false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        return NULL;
 
-    return ret;
+    return s->blur_buf;
 }
 
 /*
@@ -189,27 +172,15 @@ float* get_free_blur_buf_slot(BLUR_BUF_ARRAY* arr, int frame_idx)
 */
 int get_blur_buf_reference_count(BLUR_BUF_ARRAY* arr, int frame_idx)
 {
-    int array_length = arr->actual_length;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
-	int ret = -1;
+    struct BLUR_BUF_SLOT* s = get_slot(arr, frame_idx);
+    if (!s)
+        return -1;
 
-    pthread_mutex_lock(&arr->block);
+    uint64_t state = __atomic_load_n(&s->state, __ATOMIC_SEQ_CST);
+    if (slot_frame_idx(state) != frame_idx)
+        return -1;
 
-    for (int i = 0; i < array_length; i++)
-    {
-        if (s->frame_idx == frame_idx)
-        {
-			ret = s->reference_count;
-			break;
-        }
-
-        // next array item
-        s++;
-    }
-
-    pthread_mutex_unlock(&arr->block);
-
-    return ret;
+    return (int)slot_reference_count(state);
 }
 
 /*
@@ -217,26 +188,20 @@ int get_blur_buf_reference_count(BLUR_BUF_ARRAY* arr, int frame_idx)
  */
 int release_blur_buf_reference(BLUR_BUF_ARRAY* arr, int search_frame_idx)
 {
-    int ret = -1;
-    int array_length = arr->actual_length;
-    BLUR_BUF_STRUCT* s = arr->blur_buf_array;
+    struct BLUR_BUF_SLOT* s = get_slot(arr, search_frame_idx);
+    if (!s)
+        return -1;
 
-    pthread_mutex_lock(&arr->block);
-	
-    for (int i = 0; i < array_length; i++)
+    uint64_t state = __atomic_load_n(&s->state, __ATOMIC_SEQ_CST);
+    do
     {
-        if (s->frame_idx == search_frame_idx)
-        {
-			s->reference_count--;
-			ret = 0;
-			break;
-		}
-
-        // next struct
-        s++;
-    }
-
-    pthread_mutex_unlock(&arr->block);
-
-    return ret;
+        if (slot_frame_idx(state) != search_frame_idx)
+            return -1;
+        if (slot_reference_count(state) == 0)
+            return -1;
+    } while (!__atomic_compare_exchange_n(&s->state, &state,
+                slot_state(search_frame_idx, slot_reference_count(state) - 1), true,
+                __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+
+    return 0;
 }
@@ -9,25 +9,21 @@
 #define VMAF_FEATURE_SRC_BLUR_ARRAY_H_
 
 #include <stdlib.h>
-#include <pthread.h>
 #include "mem.h"
 
-#define MAX_NUM_THREADS 128
-typedef struct
-{
-    int frame_idx;
-    float *blur_buf;
-    int reference_count;
-
-
-} BLUR_BUF_STRUCT;
+/*
+ * Ring of frame buffers keyed by frame index: frame_idx is always stored in
+ * slot frame_idx % actual_length, so a lookup never scans the array. The
+ * state of each slot (frame index and reference count) is a single atomic
+ * word, all functions below are lock-free and may be called concurrently.
+ */
+struct BLUR_BUF_SLOT;
 
 typedef struct
 {
-    BLUR_BUF_STRUCT blur_buf_array[MAX_NUM_THREADS];
+    struct BLUR_BUF_SLOT *blur_buf_array;
     int actual_length;
     size_t buffer_size;
-    pthread_mutex_t block;
 
 } BLUR_BUF_ARRAY;
 
@@ -40,4 +40,11 @@ void convolution_f32_avx_s(const float *filter, int filter_width, const float *s
 void convolution_f32_avx_sq_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride);
 
 void convolution_f32_avx_xy_s(const float *filter, int filter_width, const float *src1, const float *src2, float *dst, float *tmp, int width, int height, int src1_stride, int src2_stride, int dst_stride);
+
+/* Only the rows [row_begin, row_end) of dst (and tmp) are written. */
+void convolution_f32_avx_rows_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride, int row_begin, int row_end);
+
+void convolution_f32_avx_sq_rows_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride, int row_begin, int row_end);
+
+void convolution_f32_avx_xy_rows_s(const float *filter, int filter_width, const float *src1, const float *src2, float *dst, float *tmp, int width, int height, int src1_stride, int src2_stride, int dst_stride, int row_begin, int row_end);
 #endif // CONVOLUTION_H_
@@ -808,36 +808,42 @@ void convolution_f32_avx_s_1d(
 	int width,
 	int height,
 	int src_stride,
-	int dst_stride)
+	int dst_stride,
+	int row_begin,
+	int row_end)
 {
 	int radius = filter_width / 2;
 	int width_mod8 = vmaf_floorn(width, 8);
 	int tmp_stride = vmaf_ceiln(width, 8);
 
 	int i_vec_end = height - radius;
+	int i_head_end = radius < row_end ? radius : row_end;
+	int i_vec_begin = radius > row_begin ? radius : row_begin;
+	int i_vec_stop = i_vec_end < row_end ? i_vec_end : row_end;
+	int i_tail_begin = i_vec_end > row_begin ? i_vec_end : row_begin;
 	int j_vec_end = width_mod8 - vmaf_ceiln(radius + 1, 8);
 
 	// Vertical pass.
-	for (int i = 0; i < radius; ++i) {
+	for (int i = row_begin; i < i_head_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
-	for (int i = radius; i < i_vec_end; ++i) {
+	for (int i = i_vec_begin; i < i_vec_stop; ++i) {
 		convolution_f32_avx_s_1d_v_scanline(N, filter, filter_width, src + i * src_stride, tmp + i * tmp_stride, src_stride, width_mod8);
 
 		for (int j = width_mod8; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
-	for (int i = i_vec_end; i < height; ++i) {
+	for (int i = i_tail_begin; i < row_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
 
 	// Horizontal pass.
-	for (int i = 0; i < height; ++i) {
+	for (int i = row_begin; i < row_end; ++i) {
 		for (int j = 0; j < radius; ++j) {
 			dst[i * dst_stride + j] = convolution_edge_s(true, filter, filter_width, tmp, width, height, tmp_stride, i, j);
 		}
@@ -850,27 +856,32 @@ void convolution_f32_avx_s_1d(
 	}
 }
 
-void convolution_f32_avx_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride)
+void convolution_f32_avx_rows_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride, int row_begin, int row_end)
 {
 	switch (filter_width) {
 	case 17:
-		convolution_f32_avx_s_1d(17, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d(17, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 9:
-		convolution_f32_avx_s_1d(9, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d(9, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 5:
-		convolution_f32_avx_s_1d(5, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d(5, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 3:
-		convolution_f32_avx_s_1d(3, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d(3, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	default:
-		convolution_f32_avx_s_1d(0, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d(0, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	}
 }
 
+void convolution_f32_avx_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride)
+{
+	convolution_f32_avx_rows_s(filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, 0, height);
+}
+
 // Filter a single scanline.
 FORCE_INLINE inline static void convolution_f32_avx_s_1d_h_sq_scanline(int N, const float * RESTRICT filter, int filter_width, const float * RESTRICT src, float * RESTRICT dst, int j_end)
 {
@@ -1652,36 +1663,42 @@ void convolution_f32_avx_s_1d_sq(
 	int width,
 	int height,
 	int src_stride,
-	int dst_stride)
+	int dst_stride,
+	int row_begin,
+	int row_end)
 {
 	int radius = filter_width / 2;
 	int width_mod8 = vmaf_floorn(width, 8);
 	int tmp_stride = vmaf_ceiln(width, 8);
 
 	int i_vec_end = height - radius;
+	int i_head_end = radius < row_end ? radius : row_end;
+	int i_vec_begin = radius > row_begin ? radius : row_begin;
+	int i_vec_stop = i_vec_end < row_end ? i_vec_end : row_end;
+	int i_tail_begin = i_vec_end > row_begin ? i_vec_end : row_begin;
 	int j_vec_end = width_mod8 - vmaf_ceiln(radius + 1, 8);
 
 	// Vertical pass.
-	for (int i = 0; i < radius; ++i) {
+	for (int i = row_begin; i < i_head_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_sq_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
-	for (int i = radius; i < i_vec_end; ++i) {
+	for (int i = i_vec_begin; i < i_vec_stop; ++i) {
 		convolution_f32_avx_s_1d_v_sq_scanline(N, filter, filter_width, src + i * src_stride, tmp + i * tmp_stride, src_stride, width_mod8);
 
 		for (int j = width_mod8; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_sq_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
-	for (int i = i_vec_end; i < height; ++i) {
+	for (int i = i_tail_begin; i < row_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_sq_s(false, filter, filter_width, src, width, height, src_stride, i, j);
 		}
 	}
 
 	// Horizontal pass.
-	for (int i = 0; i < height; ++i) {
+	for (int i = row_begin; i < row_end; ++i) {
 		for (int j = 0; j < radius; ++j) {
 			dst[i * dst_stride + j] = convolution_edge_s(true, filter, filter_width, tmp, width, height, tmp_stride, i, j);
 		}
@@ -1694,27 +1711,32 @@ void convolution_f32_avx_s_1d_sq(
 	}
 }
 
-void convolution_f32_avx_sq_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride)
+void convolution_f32_avx_sq_rows_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride, int row_begin, int row_end)
 {
 	switch (filter_width) {
 	case 17:
-		convolution_f32_avx_s_1d_sq(17, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d_sq(17, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 9:
-		convolution_f32_avx_s_1d_sq(9, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d_sq(9, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 5:
-		convolution_f32_avx_s_1d_sq(5, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d_sq(5, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	case 3:
-		convolution_f32_avx_s_1d_sq(3, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d_sq(3, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	default:
-		convolution_f32_avx_s_1d_sq(0, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride);
+		convolution_f32_avx_s_1d_sq(0, filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, row_begin, row_end);
 		break;
 	}
 }
 
+void convolution_f32_avx_sq_s(const float *filter, int filter_width, const float *src, float *dst, float *tmp, int width, int height, int src_stride, int dst_stride)
+{
+	convolution_f32_avx_sq_rows_s(filter, filter_width, src, dst, tmp, width, height, src_stride, dst_stride, 0, height);
+}
+
 // Filter a single scanline.
 FORCE_INLINE inline static void convolution_f32_avx_s_1d_h_xy_scanline(int N, const float * RESTRICT filter, int filter_width, const float * RESTRICT src1, const float * RESTRICT src2, float * RESTRICT dst, int j_end)
 {
@@ -2582,36 +2604,42 @@ void convolution_f32_avx_s_1d_xy(
 	int height,
 	int src1_stride,
 	int src2_stride,
-	int dst_stride)
+	int dst_stride,
+	int row_begin,
+	int row_end)
 {
 	int radius = filter_width / 2;
 	int width_mod8 = vmaf_floorn(width, 8);
 	int tmp_stride = vmaf_ceiln(width, 8);
 
 	int i_vec_end = height - radius;
+	int i_head_end = radius < row_end ? radius : row_end;
+	int i_vec_begin = radius > row_begin ? radius : row_begin;
+	int i_vec_stop = i_vec_end < row_end ? i_vec_end : row_end;
+	int i_tail_begin = i_vec_end > row_begin ? i_vec_end : row_begin;
 	int j_vec_end = width_mod8 - vmaf_ceiln(radius + 1, 8);
 
 	// Vertical pass.
-	for (int i = 0; i < radius; ++i) {
+	for (int i = row_begin; i < i_head_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_xy_s(false, filter, filter_width, src1, src2, width, height, src1_stride, src2_stride, i, j);
 		}
 	}
-	for (int i = radius; i < i_vec_end; ++i) {
+	for (int i = i_vec_begin; i < i_vec_stop; ++i) {
 		convolution_f32_avx_s_1d_v_xy_scanline(N, filter, filter_width, src1 + i * src1_stride, src2 + i * src2_stride, tmp + i * tmp_stride, src1_stride, src2_stride, width_mod8);
 
 		for (int j = width_mod8; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_xy_s(false, filter, filter_width, src1, src2, width, height, src1_stride, src2_stride, i, j);
 		}
 	}
-	for (int i = i_vec_end; i < height; ++i) {
+	for (int i = i_tail_begin; i < row_end; ++i) {
 		for (int j = 0; j < width; ++j) {
 			tmp[i * tmp_stride + j] = convolution_edge_xy_s(false, filter, filter_width, src1, src2, width, height, src1_stride, src2_stride, i, j);
 		}
 	}
 
 	// Horizontal pass.
-	for (int i = 0; i < height; ++i) {
+	for (int i = row_begin; i < row_end; ++i) {
 		for (int j = 0; j < radius; ++j) {
 			dst[i * dst_stride + j] = convolution_edge_s(true, filter, filter_width, tmp, width, height, tmp_stride, i, j);
 		}
@@ -2624,23 +2652,28 @@ void convolution_f32_avx_s_1d_xy(
 	}
 }
 
-void convolution_f32_avx_xy_s(const float *filter, int filter_width, const float *src1, const float *src2, float *dst, float *tmp, int width, int height, int src1_stride, int src2_stride, int dst_stride)
+void convolution_f32_avx_xy_rows_s(const float *filter, int filter_width, const float *src1, const float *src2, float *dst, float *tmp, int width, int height, int src1_stride, int src2_stride, int dst_stride, int row_begin, int row_end)
 {
 	switch (filter_width) {
 	case 17:
-		convolution_f32_avx_s_1d_xy(17, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride);
+		convolution_f32_avx_s_1d_xy(17, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, row_begin, row_end);
 		break;
 	case 9:
-		convolution_f32_avx_s_1d_xy(9, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride);
+		convolution_f32_avx_s_1d_xy(9, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, row_begin, row_end);
 		break;
 	case 5:
-		convolution_f32_avx_s_1d_xy(5, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride);
+		convolution_f32_avx_s_1d_xy(5, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, row_begin, row_end);
 		break;
 	case 3:
-		convolution_f32_avx_s_1d_xy(3, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride);
+		convolution_f32_avx_s_1d_xy(3, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, row_begin, row_end);
 		break;
 	default:
-		convolution_f32_avx_s_1d_xy(0, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride);
+		convolution_f32_avx_s_1d_xy(0, filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, row_begin, row_end);
 		break;
 	}
 }
+
+void convolution_f32_avx_xy_s(const float *filter, int filter_width, const float *src1, const float *src2, float *dst, float *tmp, int width, int height, int src1_stride, int src2_stride, int dst_stride)
+{
+	convolution_f32_avx_xy_rows_s(filter, filter_width, src1, src2, dst, tmp, width, height, src1_stride, src2_stride, dst_stride, 0, height);
+}
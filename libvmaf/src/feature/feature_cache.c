@@ -0,0 +1,304 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feature_cache.h"
+#include "feature_extractor.h"
+#include "picture.h"
+
+#define FEATURE_CACHE_KEY_CNT 6
+
+typedef struct {
+    char *path;
+    const char *name, *version;
+    unsigned score_cnt;
+    uint64_t (*hash)[FEATURE_CACHE_KEY_CNT];
+    double *score;
+    unsigned cnt, capacity;
+    unsigned written_cnt; // records [written_cnt, cnt) are not in the file
+    bool rewrite; // the file has a bad record, records behind it are lost
+    struct {
+        unsigned *record; // record + 1, 0 if empty
+        unsigned capacity; // power of 2
+    } map;
+} ExtractorCache;
+
+struct VmafFeatureCache {
+    char *dir;
+    ExtractorCache **ec;
+    unsigned cnt, capacity;
+};
+
+unsigned vmaf_feature_cache_score_cnt(VmafFeatureExtractor *fex)
+{
+    if (!fex->version) return 0;
+    if (fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL) return 0;
+
+    unsigned cnt = 0;
+    for (const char **name = fex->provided_features; name && *name; name++)
+        cnt++;
+    return cnt;
+}
+
+static unsigned *map_slot(ExtractorCache *ec, const uint64_t *hash)
+{
+    const unsigned mask = ec->map.capacity - 1;
+    const size_t hash_sz = sizeof(ec->hash[0]);
+    unsigned i = hash[0] & mask;
+    for (; ec->map.record[i]; i = (i + 1) & mask) {
+        if (!memcmp(ec->hash[ec->map.record[i] - 1], hash, hash_sz))
+            break;
+    }
+    return &ec->map.record[i];
+}
+
+static int map_grow(ExtractorCache *ec)
+{
+    const unsigned capacity = ec->map.capacity ? ec->map.capacity * 2 : 1024;
+    unsigned *record = malloc(sizeof(*record) * capacity);
+    if (!record) return -ENOMEM;
+    memset(record, 0, sizeof(*record) * capacity);
+
+    free(ec->map.record);
+    ec->map.record = record;
+    ec->map.capacity = capacity;
+    for (unsigned i = 0; i < ec->cnt; i++)
+        *map_slot(ec, ec->hash[i]) = i + 1;
+    return 0;
+}
+
+static int record_append(ExtractorCache *ec, const uint64_t *hash,
+                         const double *score)
+{
+    unsigned *slot = map_slot(ec, hash);
+    if (*slot) return 0;
+
+    if (ec->cnt >= ec->capacity) {
+        const unsigned capacity = ec->capacity ? ec->capacity * 2 : 256;
+        void *h = realloc(ec->hash, sizeof(*ec->hash) * capacity);
+        if (!h) return -ENOMEM;
+        ec->hash = h;
+        void *s = realloc(ec->score, sizeof(*ec->score) * ec->score_cnt *
+                                     capacity);
+        if (!s) return -ENOMEM;
+        ec->score = s;
+        ec->capacity = capacity;
+    }
+
+    memcpy(ec->hash[ec->cnt], hash, sizeof(ec->hash[0]));
+    memcpy(&ec->score[ec->cnt * ec->score_cnt], score,
+           sizeof(*score) * ec->score_cnt);
+    ec->cnt++;
+
+    if (2 * ec->cnt > ec->map.capacity)
+        return map_grow(ec);
+    *slot = ec->cnt;
+    return 0;
+}
+
+static size_t record_size(ExtractorCache *ec)
+{
+    return sizeof(ec->hash[0]) + sizeof(*ec->score) * ec->score_cnt +
+           sizeof(uint64_t);
+}
+
+static int read_records(ExtractorCache *ec, FILE *infile)
+{
+    const size_t sz = record_size(ec);
+    uint8_t record[sz];
+    const size_t checksum_offset = sz - sizeof(uint64_t);
+
+    size_t n;
+    while ((n = fread(record, 1, sz, infile)) == sz) {
+        uint64_t checksum;
+        memcpy(&checksum, record + checksum_offset, sizeof(checksum));
+        if (checksum != vmaf_hash_bytes(0, record, checksum_offset)) {
+            ec->rewrite = true;
+            break;
+        }
+
+        uint64_t hash[FEATURE_CACHE_KEY_CNT];
+        double score[ec->score_cnt];
+        memcpy(hash, record, sizeof(hash));
+        memcpy(score, record + sizeof(hash), sizeof(score));
+        int err = record_append(ec, hash, score);
+        if (err) return err;
+    }
+    // a partial record left by an interrupted append would misalign the
+    // records appended behind it
+    if (n && n != sz) ec->rewrite = true;
+    ec->written_cnt = ec->cnt;
+    return 0;
+}
+
+static void extractor_cache_destroy(ExtractorCache *ec)
+{
+    if (!ec) return;
+    free(ec->path);
+    free(ec->hash);
+    free(ec->score);
+    free(ec->map.record);
+    free(ec);
+}
+
+static int extractor_cache_init(ExtractorCache **extractor_cache,
+                                const char *dir, VmafFeatureExtractor *fex)
+{
+    ExtractorCache *const ec = *extractor_cache = malloc(sizeof(*ec));
+    if (!ec) return -ENOMEM;
+    memset(ec, 0, sizeof(*ec));
+    ec->name = fex->name;
+    ec->version = fex->version;
+    ec->score_cnt = vmaf_feature_cache_score_cnt(fex);
+
+    const size_t path_sz = strlen(dir) + strlen(fex->name) +
+                           strlen(fex->version) + sizeof("/-.vfc");
+    ec->path = malloc(path_sz);
+    if (!ec->path) goto fail;
+    snprintf(ec->path, path_sz, "%s/%s-%s.vfc", dir, fex->name, fex->version);
+
+    int err = map_grow(ec);
+    if (err) goto fail;
+
+    // a missing file is created when writing
+    FILE *infile = fopen(ec->path, "rb");
+    if (!infile) return 0;
+    err = read_records(ec, infile);
+    fclose(infile);
+    if (err) goto fail;
+    return 0;
+
+fail:
+    extractor_cache_destroy(ec);
+    return -ENOMEM;
+}
+
+static ExtractorCache *extractor_cache(VmafFeatureCache *cache,
+                                       VmafFeatureExtractor *fex)
+{
+    if (!vmaf_feature_cache_score_cnt(fex)) return NULL;
+
+    for (unsigned i = 0; i < cache->cnt; i++) {
+        if (!strcmp(cache->ec[i]->name, fex->name) &&
+            !strcmp(cache->ec[i]->version, fex->version))
+        {
+            return cache->ec[i];
+        }
+    }
+
+    if (cache->cnt >= cache->capacity) {
+        const unsigned capacity = cache->capacity ? cache->capacity * 2 : 8;
+        void *ec = realloc(cache->ec, sizeof(*cache->ec) * capacity);
+        if (!ec) return NULL;
+        cache->ec = ec;
+        cache->capacity = capacity;
+    }
+
+    ExtractorCache *ec;
+    if (extractor_cache_init(&ec, cache->dir, fex)) return NULL;
+    cache->ec[cache->cnt++] = ec;
+    return ec;
+}
+
+int vmaf_feature_cache_init(VmafFeatureCache **cache, const char *dir)
+{
+    if (!cache) return -EINVAL;
+    if (!dir) return -EINVAL;
+
+    VmafFeatureCache *const c = *cache = malloc(sizeof(*c));
+    if (!c) return -ENOMEM;
+    memset(c, 0, sizeof(*c));
+    c->dir = malloc(strlen(dir) + 1);
+    if (!c->dir) {
+        free(c);
+        return -ENOMEM;
+    }
+    strcpy(c->dir, dir);
+    return 0;
+}
+
+int vmaf_feature_cache_get(VmafFeatureCache *cache, VmafFeatureExtractor *fex,
+                           const uint64_t hash[6], double *score)
+{
+    if (!cache) return -EINVAL;
+    if (!fex) return -EINVAL;
+    if (!hash) return -EINVAL;
+    if (!score) return -EINVAL;
+
+    ExtractorCache *ec = extractor_cache(cache, fex);
+    if (!ec) return -EINVAL;
+
+    const unsigned record = *map_slot(ec, hash);
+    if (!record) return -EINVAL;
+    memcpy(score, &ec->score[(record - 1) * ec->score_cnt],
+           sizeof(*score) * ec->score_cnt);
+    return 0;
+}
+
+int vmaf_feature_cache_put(VmafFeatureCache *cache, VmafFeatureExtractor *fex,
+                           const uint64_t hash[6], const double *score)
+{
+    if (!cache) return -EINVAL;
+    if (!fex) return -EINVAL;
+    if (!hash) return -EINVAL;
+    if (!score) return -EINVAL;
+
+    ExtractorCache *ec = extractor_cache(cache, fex);
+    if (!ec) return -EINVAL;
+    return record_append(ec, hash, score);
+}
+
+static int write_records(ExtractorCache *ec)
+{
+    if (ec->written_cnt == ec->cnt && !ec->rewrite) return 0;
+    if (ec->rewrite) ec->written_cnt = 0;
+
+    FILE *outfile = fopen(ec->path, ec->rewrite ? "wb" : "ab");
+    if (!outfile) return -EIO;
+
+    const size_t sz = record_size(ec);
+    uint8_t record[sz];
+    const size_t checksum_offset = sz - sizeof(uint64_t);
+    int err = 0;
+    for (; ec->written_cnt < ec->cnt; ec->written_cnt++) {
+        const unsigned i = ec->written_cnt;
+        memcpy(record, ec->hash[i], sizeof(ec->hash[i]));
+        memcpy(record + sizeof(ec->hash[i]), &ec->score[i * ec->score_cnt],
+               sizeof(*ec->score) * ec->score_cnt);
+        const uint64_t checksum = vmaf_hash_bytes(0, record, checksum_offset);
+        memcpy(record + checksum_offset, &checksum, sizeof(checksum));
+        // one write per record, so that concurrent runs append whole records
+        if (fwrite(record, sz, 1, outfile) != 1) {
+            err = -EIO;
+            break;
+        }
+        fflush(outfile);
+    }
+
+    if (fclose(outfile)) err = -EIO;
+    if (!err) ec->rewrite = false;
+    return err;
+}
+
+int vmaf_feature_cache_write(VmafFeatureCache *cache)
+{
+    if (!cache) return -EINVAL;
+
+    int err = 0;
+    for (unsigned i = 0; i < cache->cnt; i++)
+        err |= write_records(cache->ec[i]);
+    return err;
+}
+
+void vmaf_feature_cache_destroy(VmafFeatureCache *cache)
+{
+    if (!cache) return;
+    for (unsigned i = 0; i < cache->cnt; i++)
+        extractor_cache_destroy(cache->ec[i]);
+    free(cache->ec);
+    free(cache->dir);
+    free(cache);
+}
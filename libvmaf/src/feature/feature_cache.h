@@ -0,0 +1,40 @@
+#ifndef __VMAF_FEATURE_CACHE_H__
+#define __VMAF_FEATURE_CACHE_H__
+
+#include <stdint.h>
+
+#include "feature_extractor.h"
+
+/*
+ * Feature cache: per-picture scores of versioned, non-temporal feature
+ * extractors, kept across runs in a directory and keyed by the content
+ * hashes of the reference and distorted pictures (see vmaf_picture_hash()).
+ *
+ * Every extractor has one file, <dir>/<name>-<version>.vfc, to which the
+ * scores of new pictures are appended when writing. Records are binary,
+ * host byte order, one score per provided feature:
+ *
+ *   <u64 hash> * 6 <f64 score> * n <u64 checksum>
+ *
+ * Records with a bad checksum end the file, e.g. after an interrupted run.
+ */
+
+typedef struct VmafFeatureCache VmafFeatureCache;
+
+int vmaf_feature_cache_init(VmafFeatureCache **cache, const char *dir);
+
+/* Returns 0 if scores are cached for this extractor and picture pair. */
+int vmaf_feature_cache_get(VmafFeatureCache *cache, VmafFeatureExtractor *fex,
+                           const uint64_t hash[6], double *score);
+
+int vmaf_feature_cache_put(VmafFeatureCache *cache, VmafFeatureExtractor *fex,
+                           const uint64_t hash[6], const double *score);
+
+int vmaf_feature_cache_write(VmafFeatureCache *cache);
+
+void vmaf_feature_cache_destroy(VmafFeatureCache *cache);
+
+/* Number of features provided by an extractor, 0 if it can not be cached. */
+unsigned vmaf_feature_cache_score_cnt(VmafFeatureExtractor *fex);
+
+#endif /* __VMAF_FEATURE_CACHE_H__ */
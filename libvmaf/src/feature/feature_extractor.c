@@ -120,6 +120,51 @@ int vmaf_feature_extractor_context_extract(VmafFeatureExtractorContext *fex_ctx,
     return fex_ctx->fex->extract(fex_ctx->fex, ref, dist, pic_index, vfc);
 }
 
+int vmaf_feature_extractor_context_extract_multi(VmafFeatureExtractorContext *fex_ctx,
+                                                 VmafPicture *ref, VmafPicture **dist,
+                                                 unsigned n_dist, unsigned pic_index,
+                                                 VmafFeatureCollector **vfc)
+{
+    if (!fex_ctx) return -EINVAL;
+    if (!ref) return -EINVAL;
+    if (!dist) return -EINVAL;
+    if (!vfc) return -EINVAL;
+    if (!n_dist) return -EINVAL;
+
+    if (n_dist == 1)
+        return vmaf_feature_extractor_context_extract(fex_ctx, ref, dist[0],
+                                                      pic_index, vfc[0]);
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        if (!dist[i]) return -EINVAL;
+        if (!vfc[i]) return -EINVAL;
+    }
+
+    if (!fex_ctx->fex->extract_multi) {
+        // temporal state can not be shared by several distorted streams
+        if (fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL)
+            return -EINVAL;
+        for (unsigned i = 0; i < n_dist; i++) {
+            int err = vmaf_feature_extractor_context_extract(fex_ctx, ref,
+                                                             dist[i], pic_index,
+                                                             vfc[i]);
+            if (err) return err;
+        }
+        return 0;
+    }
+
+    if (!fex_ctx->fex->init) return -EINVAL;
+    if (!fex_ctx->is_initialized) {
+        int err =
+            vmaf_feature_extractor_context_init(fex_ctx, ref->pix_fmt, ref->bpc,
+                                                ref->w[0], ref->h[0]);
+        if (err) return err;
+    }
+
+    return fex_ctx->fex->extract_multi(fex_ctx->fex, ref, dist, n_dist,
+                                       pic_index, vfc);
+}
+
 int vmaf_feature_extractor_context_close(VmafFeatureExtractorContext *fex_ctx)
 {
     if (!fex_ctx) return -EINVAL;
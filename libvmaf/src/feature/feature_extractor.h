@@ -5,6 +5,8 @@
 #include <stdlib.h>
 
 #include "feature_collector.h"
+#include "ref_cache.h"
+#include "thread_pool.h"
 
 #include "libvmaf/picture.h"
 
@@ -14,14 +16,29 @@ enum VmafFeatureExtractorFlags {
 
 typedef struct VmafFeatureExtractor {
     const char *name;
+    // optional, scores are only cached across runs for versioned feature
+    // extractors, bump whenever the scores change
+    const char *version;
     int (*init)(struct VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h);
     int (*extract)(struct VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *dist_pic,
                    unsigned index, VmafFeatureCollector *feature_collector);
+    // optional, extracts the features of several distorted pictures of the
+    // same reference, sharing the reference side computation. Scores of
+    // dist_pic[i] go to feature_collector[i].
+    int (*extract_multi)(struct VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector);
     int (*close)(struct VmafFeatureExtractor *fex);
     void *priv;
     size_t priv_size;
+    VmafRefCache *ref_cache; // optional, reference-only intermediates
+    // preview mode, multi-scale features start at this scale and estimate
+    // the finer ones, 0 for full resolution (see VmafConfiguration.preview)
+    unsigned preview_scale;
+    VmafThreadPool *thread_pool; // optional, splits pictures in stripes run on it
     uint64_t flags;
     const char **provided_features;
 } VmafFeatureExtractor;
@@ -46,6 +63,11 @@ int vmaf_feature_extractor_context_extract(VmafFeatureExtractorContext *fex_ctx,
                                            unsigned pic_index,
                                            VmafFeatureCollector *vfc);
 
+int vmaf_feature_extractor_context_extract_multi(VmafFeatureExtractorContext *fex_ctx,
+                                                 VmafPicture *ref, VmafPicture **dist,
+                                                 unsigned n_dist, unsigned pic_index,
+                                                 VmafFeatureCollector **vfc);
+
 int vmaf_feature_extractor_context_close(VmafFeatureExtractorContext *fex_ctx);
 
 int vmaf_feature_extractor_context_delete(VmafFeatureExtractorContext *fex_ctx);
@@ -9,13 +9,63 @@
 #include "adm_options.h"
 #include "mem.h"
 #include "picture_copy.h"
+#include "ref_cache.h"
 
 typedef struct AdmState {
     size_t float_stride;
     float *ref;
     float *dist;
+    AdmRefState *ref_state; // only allocated by extract_multi()
 } AdmState;
 
+static char *den_scale_name[4] = {
+    "adm_den_scale0", "adm_den_scale1", "adm_den_scale2", "adm_den_scale3",
+};
+
+/*
+ * Preview mode: numerators of scales below preview_scale are estimated from
+ * the num / den ratio of the finest computed scale, num[k] = den[k] *
+ * ratio ^ gamma, which keeps identical pictures at 1. Fit on blur, noise,
+ * blocking and rescaling distortions of natural images, validate on other
+ * content with tools/speedup_study.c.
+ */
+static const double preview_gamma[2][2] = {
+    { 0.552 },        // preview_scale 1: scale 0
+    { 0.586, 1.136 }, // preview_scale 2: scales 0 and 1
+};
+
+static double preview_score(unsigned preview_scale, const double *scores,
+                            double score_den)
+{
+    if (score_den == 0.0) return 1.0;
+
+    const double ratio = scores[2 * preview_scale + 1] > 0.0 ?
+        scores[2 * preview_scale] / scores[2 * preview_scale + 1] : 1.0;
+    double num = 0.0;
+    for (unsigned scale = 0; scale < 4; scale++) {
+        if (scale >= preview_scale) {
+            num += scores[2 * scale];
+            continue;
+        }
+        const double gamma = preview_gamma[preview_scale - 1][scale];
+        num += scores[2 * scale + 1] * (ratio > 0.0 ? pow(ratio, gamma) : 0.0);
+    }
+    return num / score_den;
+}
+
+static int den_scale_from_cache(VmafRefCache *ref_cache, unsigned index,
+                                float *den_scale)
+{
+    for (unsigned i = 0; i < 4; i++) {
+        double value;
+        int err = vmaf_ref_cache_get(ref_cache, den_scale_name[i], index,
+                                     &value);
+        if (err) return err;
+        den_scale[i] = value;
+    }
+    return 0;
+}
+
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
@@ -34,6 +84,11 @@ fail:
     return -ENOMEM;
 }
 
+static int extract_multi(VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector);
+
 static int extract(VmafFeatureExtractor *fex,
                    VmafPicture *ref_pic, VmafPicture *dist_pic,
                    unsigned index, VmafFeatureCollector *feature_collector)
@@ -41,6 +96,10 @@ static int extract(VmafFeatureExtractor *fex,
     AdmState *s = fex->priv;
     int err = 0;
 
+    if (fex->ref_cache || fex->preview_scale || fex->thread_pool)
+        return extract_multi(fex, ref_pic, &dist_pic, 1, index,
+                             &feature_collector);
+
     picture_copy(s->ref, ref_pic, -128);
     picture_copy(s->dist, dist_pic, -128);
 
@@ -58,11 +117,64 @@ static int extract(VmafFeatureExtractor *fex,
     return 0;
 }
 
+static int extract_multi(VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector)
+{
+    AdmState *s = fex->priv;
+    int err = 0;
+
+    if (!s->ref_state) {
+        err = adm_ref_state_init(&s->ref_state, ref_pic->w[0], ref_pic->h[0],
+                                 fex->preview_scale, fex->thread_pool);
+        if (err) return err;
+    }
+
+    float den_scale[4];
+    const int den_cached = fex->ref_cache &&
+        !den_scale_from_cache(fex->ref_cache, index, den_scale);
+
+    picture_copy(s->ref, ref_pic, -128);
+    err = compute_adm_ref(s->ref_state, s->ref, s->float_stride, den_scale,
+                          den_cached, ADM_BORDER_FACTOR);
+    if (err) return err;
+
+    if (fex->ref_cache && !den_cached) {
+        for (unsigned i = 0; i < 4; i++) {
+            err = vmaf_ref_cache_put(fex->ref_cache, den_scale_name[i], index,
+                                     den_scale[i]);
+            if (err) return err;
+        }
+    }
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        picture_copy(s->dist, dist_pic[i], -128);
+
+        double score, score_num, score_den;
+        double scores[8];
+        err = compute_adm_dis(s->ref_state, s->dist, s->float_stride, &score,
+                              &score_num, &score_den, scores,
+                              ADM_BORDER_FACTOR);
+        if (err) return err;
+        if (fex->preview_scale)
+            score = preview_score(fex->preview_scale, scores, score_den);
+
+        err = vmaf_feature_collector_append(feature_collector[i],
+                                            "'VMAF_feature_adm2_score'",
+                                            score, index);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
 static int close(VmafFeatureExtractor *fex)
 {
     AdmState *s = fex->priv;
     if (s->ref) aligned_free(s->ref);
     if (s->dist) aligned_free(s->dist);
+    adm_ref_state_destroy(s->ref_state);
     return 0;
 }
 
@@ -73,8 +185,10 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_adm = {
     .name = "float_adm",
+    .version = "1.0",
     .init = init,
     .extract = extract,
+    .extract_multi = extract_multi,
     .close = close,
     .priv_size = sizeof(AdmState),
     .provided_features = provided_features,
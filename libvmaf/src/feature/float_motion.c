@@ -1,5 +1,7 @@
 #include <errno.h>
 #include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "common/convolution.h"
@@ -8,7 +10,9 @@
 #include "mem.h"
 #include "motion.h"
 #include "motion_tools.h"
+#include "ref_cache.h"
 
+#include "picture.h"
 #include "picture_copy.h"
 
 typedef struct MotionState {
@@ -16,7 +20,12 @@ typedef struct MotionState {
     float *ref;
     float *tmp;
     float *blur[3];
-    VmafFeatureCollector *feature_collector;
+    // with a reference cache, blurs are only computed once a score is
+    // missing from the cache, from the pictures held until then
+    VmafPicture held[3];
+    bool blurred[3];
+    VmafFeatureCollector **feature_collector;
+    unsigned n_feature_collector;
     unsigned index;
     double score;
 } MotionState;
@@ -40,29 +49,91 @@ static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
     return 0;
 }
 
-static int extract(VmafFeatureExtractor *fex,
-                   VmafPicture *ref_pic, VmafPicture *dist_pic,
-                   unsigned index, VmafFeatureCollector *feature_collector)
+static int append_score(MotionState *s, double score, unsigned index)
+{
+    for (unsigned i = 0; i < s->n_feature_collector; i++) {
+        int err = vmaf_feature_collector_append(s->feature_collector[i],
+                                                "'VMAF_feature_motion2_score'",
+                                                score, index);
+        if (err) return err;
+    }
+    return 0;
+}
+
+static void blur(MotionState *s, VmafPicture *pic, unsigned blur_idx)
+{
+    picture_copy(s->ref, pic, -128);
+    convolution_f32_c_s(FILTER_5_s, 5, s->ref, s->blur[blur_idx], s->tmp,
+                        pic->w[0], pic->h[0],
+                        s->float_stride / sizeof(float),
+                        s->float_stride / sizeof(float));
+    s->blurred[blur_idx] = true;
+}
+
+static int hold(MotionState *s, VmafPicture *pic, unsigned blur_idx)
+{
+    if (s->held[blur_idx].ref_cnt) {
+        int err = vmaf_picture_unref(&s->held[blur_idx]);
+        if (err) return err;
+    }
+    s->blurred[blur_idx] = false;
+    return vmaf_picture_ref(&s->held[blur_idx], pic);
+}
+
+/*
+ * Motion only depends on the reference, it is computed once and the score
+ * is appended to the collectors of all distorted pictures.
+ */
+static int extract_multi(VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector)
 {
     MotionState *s = fex->priv;
     int err = 0;
 
+    (void) dist_pic;
+
+    if (n_dist != s->n_feature_collector) {
+        VmafFeatureCollector **fc =
+            realloc(s->feature_collector, sizeof(*fc) * n_dist);
+        if (!fc) return -ENOMEM;
+        s->feature_collector = fc;
+        s->n_feature_collector = n_dist;
+    }
+    for (unsigned i = 0; i < n_dist; i++)
+        s->feature_collector[i] = feature_collector[i];
+
     s->index = index;
     unsigned blur_idx_0 = (index + 0) % 3;
     unsigned blur_idx_1 = (index + 1) % 3;
     unsigned blur_idx_2 = (index + 2) % 3;
-    s->feature_collector = feature_collector; //FIXME
 
-    picture_copy(s->ref, ref_pic, -128);
-    convolution_f32_c_s(FILTER_5_s, 5, s->ref, s->blur[blur_idx_0], s->tmp,
-                        ref_pic->w[0], ref_pic->h[0],
-                        s->float_stride / sizeof(float),
-                        s->float_stride / sizeof(float));
-
-    if (index == 0)
-        return vmaf_feature_collector_append(feature_collector,
-                                             "'VMAF_feature_motion2_score'",
-                                             0., index);
+    VmafRefCache *const ref_cache = fex->ref_cache;
+    if (ref_cache) {
+        err = hold(s, ref_pic, blur_idx_0);
+        if (err) return err;
+        if (index == 0)
+            return append_score(s, 0., index);
+        if (index == 1) return 0;
+
+        double score, score2;
+        if (!vmaf_ref_cache_get(ref_cache, "motion_score", index, &score) &&
+            !vmaf_ref_cache_get(ref_cache, "motion2_score", index - 1,
+                                &score2))
+        {
+            s->score = score;
+            return append_score(s, score2, index - 1);
+        }
+        for (unsigned i = 0; i < 3; i++) {
+            if (!s->blurred[i])
+                blur(s, &s->held[i], i);
+        }
+    } else {
+        blur(s, ref_pic, blur_idx_0);
+        if (index == 0)
+            return append_score(s, 0., index);
+    }
 
     double score;
     err = compute_motion(s->blur[blur_idx_2], s->blur[blur_idx_0],
@@ -77,16 +148,28 @@ static int extract(VmafFeatureExtractor *fex,
                          s->float_stride, s->float_stride, &score2);
     if (err) return err;
     score2 = score2 < score ? score2 : score;
-    err = vmaf_feature_collector_append(feature_collector,
-                                        "'VMAF_feature_motion2_score'",
-                                        score2, index - 1);
+    err = append_score(s, score2, index - 1);
 
     s->score = score;
 
     if (err) return err;
+    if (ref_cache) {
+        err  = vmaf_ref_cache_put(ref_cache, "motion_score", index, score);
+        err |= vmaf_ref_cache_put(ref_cache, "motion2_score", index - 1,
+                                  score2);
+        if (err) return err;
+    }
     return 0;
 }
 
+static int extract(VmafFeatureExtractor *fex,
+                   VmafPicture *ref_pic, VmafPicture *dist_pic,
+                   unsigned index, VmafFeatureCollector *feature_collector)
+{
+    return extract_multi(fex, ref_pic, &dist_pic, 1, index,
+                         &feature_collector);
+}
+
 static int close(VmafFeatureExtractor *fex)
 {
     MotionState *s = fex->priv;
@@ -96,10 +179,14 @@ static int close(VmafFeatureExtractor *fex)
     if (s->blur[1]) aligned_free(s->blur[1]);
     if (s->blur[2]) aligned_free(s->blur[2]);
     if (s->tmp) aligned_free(s->tmp);
-
-    return vmaf_feature_collector_append(s->feature_collector,
-                                         "'VMAF_feature_motion2_score'",
-                                         s->score, s->index);
+    for (unsigned i = 0; i < 3; i++) {
+        if (s->held[i].ref_cnt)
+            vmaf_picture_unref(&s->held[i]);
+    }
+
+    const int err = append_score(s, s->score, s->index);
+    free(s->feature_collector);
+    return err;
 }
 
 static const char *provided_features[] = {
@@ -109,8 +196,10 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_motion = {
     .name = "float_motion",
+    .version = "1.0",
     .init = init,
     .extract = extract,
+    .extract_multi = extract_multi,
     .close = close,
     .priv_size = sizeof(MotionState),
     .provided_features = provided_features,
@@ -67,6 +67,7 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_ms_ssim = {
     .name = "float_ms_ssim",
+    .version = "1.0",
     .init = init,
     .extract = extract,
     .close = close,
@@ -69,6 +69,7 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_psnr = {
     .name = "float_psnr",
+    .version = "1.0",
     .init = init,
     .extract = extract,
     .close = close,
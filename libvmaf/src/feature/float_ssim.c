@@ -66,6 +66,7 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_ssim = {
     .name = "float_ssim",
+    .version = "1.0",
     .init = init,
     .extract = extract,
     .close = close,
@@ -14,8 +14,35 @@ typedef struct VifState {
     size_t float_stride;
     float *ref;
     float *dist;
+    VifRefState *ref_state; // only allocated by extract_multi()
 } VifState;
 
+/*
+ * Preview mode: scales below preview_scale are estimated from the finest
+ * computed scale, vif_scale[k] = vif_scale[preview_scale] ^ gamma, which
+ * keeps identical pictures at 1. Fit on blur, noise, blocking and rescaling
+ * distortions of natural images, validate on other content with
+ * tools/speedup_study.c.
+ */
+static const double preview_gamma[2][2] = {
+    { 3.112 },        // preview_scale 1: scale 0
+    { 5.046, 1.690 }, // preview_scale 2: scales 0 and 1
+};
+
+static void estimate_skipped_scales(unsigned preview_scale, double *vif)
+{
+    for (unsigned scale = 0; scale < preview_scale; scale++) {
+        const double gamma = preview_gamma[preview_scale - 1][scale];
+        vif[scale] = vif[preview_scale] > 0. ?
+                     pow(vif[preview_scale], gamma) : vif[preview_scale];
+    }
+}
+
+static int extract_multi(VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector);
+
 static int init(VmafFeatureExtractor *fex, enum VmafPixelFormat pix_fmt,
                 unsigned bpc, unsigned w, unsigned h)
 {
@@ -41,6 +68,10 @@ static int extract(VmafFeatureExtractor *fex,
     VifState *s = fex->priv;
     int err = 0;
 
+    if (fex->preview_scale || fex->thread_pool)
+        return extract_multi(fex, ref_pic, &dist_pic, 1, index,
+                             &feature_collector);
+
     picture_copy(s->ref, ref_pic, -128);
     picture_copy(s->dist, dist_pic, -128);
 
@@ -71,11 +102,65 @@ static int extract(VmafFeatureExtractor *fex,
     return 0;
 }
 
+static int extract_multi(VmafFeatureExtractor *fex,
+                         VmafPicture *ref_pic, VmafPicture **dist_pic,
+                         unsigned n_dist, unsigned index,
+                         VmafFeatureCollector **feature_collector)
+{
+    VifState *s = fex->priv;
+    int err = 0;
+
+    if (!s->ref_state) {
+        err = vif_ref_state_init(&s->ref_state, ref_pic->w[0], ref_pic->h[0],
+                                 fex->preview_scale, fex->thread_pool);
+        if (err) return err;
+    }
+
+    picture_copy(s->ref, ref_pic, -128);
+    err = compute_vif_ref(s->ref_state, s->ref, s->float_stride);
+    if (err) return err;
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        picture_copy(s->dist, dist_pic[i], -128);
+
+        double score, score_num, score_den;
+        double scores[8];
+        err = compute_vif_dis(s->ref_state, s->dist, s->float_stride,
+                              &score, &score_num, &score_den, scores);
+        if (err) return err;
+
+        double vif[4];
+        for (unsigned scale = 0; scale < 4; scale++)
+            vif[scale] = scores[2 * scale] / scores[2 * scale + 1];
+        estimate_skipped_scales(fex->preview_scale, vif);
+
+        err = vmaf_feature_collector_append(feature_collector[i],
+                                            "'VMAF_feature_vif_scale0_score'",
+                                            vif[0], index);
+        if (err) return err;
+        err = vmaf_feature_collector_append(feature_collector[i],
+                                            "'VMAF_feature_vif_scale1_score'",
+                                            vif[1], index);
+        if (err) return err;
+        err = vmaf_feature_collector_append(feature_collector[i],
+                                            "'VMAF_feature_vif_scale2_score'",
+                                            vif[2], index);
+        if (err) return err;
+        err = vmaf_feature_collector_append(feature_collector[i],
+                                            "'VMAF_feature_vif_scale3_score'",
+                                            vif[3], index);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
 static int close(VmafFeatureExtractor *fex)
 {
     VifState *s = fex->priv;
     if (s->ref) aligned_free(s->ref);
     if (s->dist) aligned_free(s->dist);
+    vif_ref_state_destroy(s->ref_state);
     return 0;
 }
 
@@ -87,8 +172,10 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_float_vif = {
     .name = "float_vif",
+    .version = "1.0",
     .init = init,
     .extract = extract,
+    .extract_multi = extract_multi,
     .close = close,
     .priv_size = sizeof(VifState),
     .provided_features = provided_features,
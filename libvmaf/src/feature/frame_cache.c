@@ -0,0 +1,166 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#define FRAME_CACHE_SPILL 1
+#else
+#define FRAME_CACHE_SPILL 0
+#endif
+
+#include "frame_cache.h"
+#include "mem.h"
+
+struct FrameCache {
+    size_t frame_sz;
+    size_t mem_limit;
+    unsigned cnt;
+    bool sealed;
+    struct {
+        void **frame;
+        unsigned cnt, capacity;
+    } mem;
+    struct {
+        FILE *file;
+        void *map;
+        size_t map_sz;
+    } spill;
+};
+
+int frame_cache_init(FrameCache **cache, size_t frame_sz, size_t mem_limit)
+{
+    if (!cache) return -EINVAL;
+    if (!frame_sz) return -EINVAL;
+
+    FrameCache *const c = *cache = malloc(sizeof(*c));
+    if (!c) return -ENOMEM;
+    memset(c, 0, sizeof(*c));
+    c->frame_sz = frame_sz;
+    c->mem_limit = mem_limit;
+    return 0;
+}
+
+static int spill_frames(FrameCache *c)
+{
+    if (!(c->spill.file = tmpfile()))
+        return -EIO;
+
+    for (unsigned i = 0; i < c->mem.cnt; i++) {
+        if (fwrite(c->mem.frame[i], c->frame_sz, 1, c->spill.file) != 1)
+            return -EIO;
+    }
+    for (unsigned i = 0; i < c->mem.cnt; i++)
+        aligned_free(c->mem.frame[i]);
+    c->mem.cnt = 0;
+    return 0;
+}
+
+int frame_cache_append(FrameCache *c, const void *frame)
+{
+    if (!c) return -EINVAL;
+    if (!frame) return -EINVAL;
+    if (c->sealed) return -EINVAL;
+
+    if (FRAME_CACHE_SPILL && !c->spill.file &&
+        (size_t) (c->cnt + 1) * c->frame_sz > c->mem_limit)
+    {
+        int err = spill_frames(c);
+        if (err) return err;
+    }
+
+    if (c->spill.file) {
+        if (fwrite(frame, c->frame_sz, 1, c->spill.file) != 1)
+            return -EIO;
+        c->cnt++;
+        return 0;
+    }
+
+    if (c->mem.cnt == c->mem.capacity) {
+        const unsigned capacity = c->mem.capacity ? c->mem.capacity * 2 : 64;
+        void **f = realloc(c->mem.frame, sizeof(*f) * capacity);
+        if (!f) return -ENOMEM;
+        c->mem.frame = f;
+        c->mem.capacity = capacity;
+    }
+    void *const f = aligned_malloc(c->frame_sz, MAX_ALIGN);
+    if (!f) return -ENOMEM;
+    memcpy(f, frame, c->frame_sz);
+    c->mem.frame[c->mem.cnt++] = f;
+    c->cnt++;
+    return 0;
+}
+
+int frame_cache_seal(FrameCache *c)
+{
+    if (!c) return -EINVAL;
+    if (c->sealed) return 0;
+    c->sealed = true;
+
+#if FRAME_CACHE_SPILL
+    if (c->spill.file && c->cnt) {
+        if (fflush(c->spill.file))
+            return -EIO;
+        c->spill.map_sz = (size_t) c->cnt * c->frame_sz;
+        void *map = mmap(NULL, c->spill.map_sz, PROT_READ, MAP_SHARED,
+                         fileno(c->spill.file), 0);
+        if (map == MAP_FAILED)
+            return -EIO;
+        c->spill.map = map;
+    }
+#endif
+
+    return 0;
+}
+
+const void *frame_cache_get(FrameCache *c, unsigned index)
+{
+    if (!c || !c->sealed || index >= c->cnt)
+        return NULL;
+    if (c->spill.file)
+        return (const char *) c->spill.map + (size_t) index * c->frame_sz;
+    return c->mem.frame[index];
+}
+
+unsigned frame_cache_count(FrameCache *c)
+{
+    return c ? c->cnt : 0;
+}
+
+void frame_cache_destroy(FrameCache *c)
+{
+    if (!c) return;
+
+#if FRAME_CACHE_SPILL
+    if (c->spill.map)
+        munmap(c->spill.map, c->spill.map_sz);
+#endif
+    if (c->spill.file)
+        fclose(c->spill.file);
+    for (unsigned i = 0; i < c->mem.cnt; i++)
+        aligned_free(c->mem.frame[i]);
+    free(c->mem.frame);
+    free(c);
+}
@@ -0,0 +1,44 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef FRAME_CACHE_H_
+#define FRAME_CACHE_H_
+
+#include <stddef.h>
+
+/*
+ * Append-only cache of fixed size frames. Frames are kept in memory until
+ * mem_limit bytes are used, after that all frames are spilled to a
+ * temporary file which is memory-mapped by frame_cache_seal(). Frames can
+ * only be read back once the cache is sealed, from any number of threads.
+ */
+typedef struct FrameCache FrameCache;
+
+int frame_cache_init(FrameCache **cache, size_t frame_sz, size_t mem_limit);
+
+int frame_cache_append(FrameCache *cache, const void *frame);
+
+int frame_cache_seal(FrameCache *cache);
+
+const void *frame_cache_get(FrameCache *cache, unsigned index);
+
+unsigned frame_cache_count(FrameCache *cache);
+
+void frame_cache_destroy(FrameCache *cache);
+
+#endif /* FRAME_CACHE_H_ */
@@ -60,6 +60,7 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_psnr = {
     .name = "psnr",
+    .version = "1.0",
     .init = init,
     .extract = extract,
     .close = close,
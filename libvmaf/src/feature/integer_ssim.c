@@ -228,6 +228,7 @@ static const char *provided_features[] = {
 
 VmafFeatureExtractor vmaf_fex_ssim = {
     .name = "ssim",
+    .version = "1.0",
     .init = init,
     .extract = extract,
     .close = close,
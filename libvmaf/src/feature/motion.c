@@ -24,6 +24,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "offset.h"
 #include "motion_options.h"
@@ -31,6 +32,8 @@
 #include "common/convolution.h"
 #include "common/convolution_internal.h"
 #include "motion_tools.h"
+#include "motion_map.h"
+#include "frame_cache.h"
 
 #define convolution_f32_c convolution_f32_c_s
 #define FILTER_5           FILTER_5_s
@@ -43,41 +46,29 @@
 #define MIN_GAP 2
 // maximum (seconds) of frame gap
 #define MAX_GAP 4
-// discovered multiplier for correct frame indexing
-#define FRAME_INDEX_OFFSET 1.5
+// side length of the blocks summed into a frame signature
+#define SIG_BLOCK 16
+// relative slack of the signature bound, covers float accumulation error
+#define SIG_MARGIN 1e-3
+// blurred frames above this size are spilled to a memory-mapped file
+#define BLUR_CACHE_MEM_LIMIT ((size_t)1 << 30)
 
 /**
  * Note: img1_stride and img2_stride are in terms of (sizeof(float) bytes)
  */
-float vmaf_image_sad_c(const float *img1, const float *img2, int width, int height, int img1_stride, int img2_stride, int pass)
+float vmaf_image_sad_c(const float *img1, const float *img2, int width, int height, int img1_stride, int img2_stride)
 {
     float accum = (float)0.0;
     for (int i = 0; i < height; ++i) {
         float accum_line = (float)0.0;
         for (int j = 0; j < width; ++j) {
             float img1px = img1[i * img1_stride + j];
-            float img2px = img2[i * img2_stride + j];  
-            // if running through the first time, print out all the motion scores
-            // so that they can be used in alpha masking.
-            if (pass == 0){
-                if(j == width - 1 && i == height - 1){     
-                    // for csv parsing, the final value does not have
-                    // a trailing comma
-                    printf("%f", fabs(img1px - img2px));   
-                } else {
-                    printf("%f,", fabs(img1px - img2px));  
-                }
-            }                    
+            float img2px = img2[i * img2_stride + j];
             accum_line += fabs(img1px - img2px);
         }
         accum += accum_line;
     }
-    float res = (float) (accum / (width * height));
-    if (pass == 0) { 
-        // mark the end of a frame with a newline for csv parsing frame-by-frame
-        printf("\n"); 
-    }
-    return res;
+    return (float) (accum / (width * height));
 }
 
 float check_frame(const float *img1, int w_h)
@@ -93,7 +84,7 @@ float check_frame(const float *img1, int w_h)
 /** 
  * Note: ref_stride and dis_stride are in terms of bytes
  */
-int compute_motion(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score, int pass)
+int compute_motion(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score)
 {
 
     if (ref_stride % sizeof(float) != 0)
@@ -109,7 +100,7 @@ int compute_motion(const float *ref, const float *dis, int w, int h, int ref_str
         goto fail;
     }
     // stride for vmaf_image_sad_c is in terms of (sizeof(float) bytes)
-    *score = vmaf_image_sad_c(ref, dis, w, h, ref_stride / sizeof(float), dis_stride / sizeof(float), pass);
+    *score = vmaf_image_sad_c(ref, dis, w, h, ref_stride / sizeof(float), dis_stride / sizeof(float));
 
     return 0;
 
@@ -117,9 +108,104 @@ fail:
     return 1;
 }
 
-int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int stride, void *user_data, int offset), void *user_data, int w, int h, const char *fmt)
+typedef struct {
+    FrameCache *blur;
+    const double *sig;
+    int sig_sz;
+    int w, h, stride;
+    int n_frames;
+    pthread_mutex_t mutex;
+    int next_b;
+    double bound;       // least score compared so far, -1.0 if none
+    double *best_score; // per 'b' frame
+    int *best_c;        // per 'b' frame, -1 if no pair was selected
+} LoopSearch;
+
+/**
+ * Sum the frame over SIG_BLOCK x SIG_BLOCK blocks.
+ * Note: stride is in terms of (sizeof(float) bytes)
+ */
+static void frame_signature(const float *buf, int w, int h, int stride, double *sig)
+{
+    const int sig_w = (w + SIG_BLOCK - 1) / SIG_BLOCK;
+    const int sig_h = (h + SIG_BLOCK - 1) / SIG_BLOCK;
+    memset(sig, 0, sizeof(*sig) * sig_w * sig_h);
+    for (int i = 0; i < h; ++i) {
+        double *sig_line = sig + (i / SIG_BLOCK) * sig_w;
+        for (int j = 0; j < w; ++j) {
+            sig_line[j / SIG_BLOCK] += buf[i * stride + j];
+        }
+    }
+}
+
+/**
+ * |sum(b) - sum(c)| <= sum(|b - c|) for every block, so the signatures give
+ * a lower bound of the motion score without touching the full frames.
+ */
+static double signature_bound(const double *b_sig, const double *c_sig, int sig_sz, int w, int h)
+{
+    double accum = 0.0;
+    for (int k = 0; k < sig_sz; ++k) {
+        accum += fabs(b_sig[k] - c_sig[k]);
+    }
+    return accum / ((double)w * h);
+}
+
+static void *loop_search_thread(void *arg)
+{
+    LoopSearch *s = arg;
+
+    while (1) {
+        pthread_mutex_lock(&s->mutex);
+        const int b_idx = s->next_b++;
+        double bound = s->bound;
+        pthread_mutex_unlock(&s->mutex);
+        if (b_idx >= s->n_frames - 1) {
+            break;
+        }
+
+        const float *b_blur_buf = frame_cache_get(s->blur, b_idx);
+        const double *b_sig = s->sig + (size_t)b_idx * s->sig_sz;
+        float min = -1.0;
+        s->best_c[b_idx] = -1;
+        const int c_end = MIN(s->n_frames, b_idx + MAX_GAP * FPS);
+        for (int c_idx = b_idx + MIN_GAP * FPS + 1; c_idx < c_end; c_idx++) {
+            const double *c_sig = s->sig + (size_t)c_idx * s->sig_sz;
+            if (bound >= 0.0 &&
+                signature_bound(b_sig, c_sig, s->sig_sz, s->w, s->h) > bound * (1.0 + SIG_MARGIN)) {
+                continue;
+            }
+            // compute the motion from b -> c
+            double score;
+            const float *c_blur_buf = frame_cache_get(s->blur, c_idx);
+            compute_motion(b_blur_buf, c_blur_buf, s->w, s->h, s->stride, s->stride, &score);
+            if (min == -1.0 || score < min) {
+                min = score;
+                s->best_score[b_idx] = score;
+                s->best_c[b_idx] = c_idx;
+            }
+            if (bound < 0.0 || score < bound) {
+                pthread_mutex_lock(&s->mutex);
+                if (s->bound < 0.0 || score < s->bound) {
+                    s->bound = score;
+                }
+                bound = s->bound;
+                pthread_mutex_unlock(&s->mutex);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * The first pass writes the motion map between every pair of consecutive
+ * frames to map, if not NULL, so that they can be used in alpha masking.
+ * The second pass finds the pair of frames with the least relative motion,
+ * using up to n_threads threads.
+ */
+int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int stride, void *user_data, int64_t offset), void *user_data, int w, int h, const char *fmt, MotionMapSink *map, int n_threads)
 {
-    double score = 0;
     float *ref_buf = 0;
     float *prev_blur_buf = 0;
     float *blur_buf = 0;
@@ -131,10 +217,10 @@ int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int strid
     int ret = 1;
     bool next_frame_read;
     int global_frm_idx = 0; // map to thread_data->frm_idx in combo.c
-    // Pass is the mode to run the motion computation in. If it is zero, 
-    // it prints all the individual cell scores (used for masking). 
-    // If it is 1, we print the motion between the frames (used for N^2 comparions).
-    int pass = 0;
+    FrameCache *blur_cache = 0;
+    double *sig = 0;
+    int sig_capacity = 0;
+    const int sig_sz = ((w + SIG_BLOCK - 1) / SIG_BLOCK) * ((h + SIG_BLOCK - 1) / SIG_BLOCK);
 
     if (w <= 0 || h <= 0 || (size_t)w > ALIGN_FLOOR(INT_MAX) / sizeof(float)) { 
         goto fail_or_end; 
@@ -146,6 +232,12 @@ int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int strid
 
     data_sz = (size_t)stride * h;
 
+    if (frame_cache_init(&blur_cache, data_sz, BLUR_CACHE_MEM_LIMIT)) {
+        printf("error: frame_cache_init failed.\n");
+        fflush(stdout);
+        goto fail_or_end;
+    }
+
     if (!(ref_buf = aligned_malloc(data_sz, MAX_ALIGN))) {
         printf("error: aligned_malloc failed for ref_buf.\n");
         fflush(stdout); 
@@ -223,18 +315,35 @@ int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int strid
             convolution_f32_c(FILTER_5, 5, next_ref_buf, next_blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float)); 
         }
         
-        /* =========== motion ============== */
-        // compute
-        if (frm_idx == 0){
-            score = 0.0; 
-        } else {     
-            if ((ret = compute_motion(prev_blur_buf, blur_buf, w, h, stride, stride, &score, pass))){
-                printf("error: compute_motion (prev) failed.\n");
-                fflush(stdout); 
+        /* =========== motion map ============== */
+        if (map && frm_idx > 0) {
+            if (motion_map_sink_write(map, prev_blur_buf, blur_buf, stride / sizeof(float), stride / sizeof(float))) {
+                printf("error: motion_map_sink_write failed.\n");
+                fflush(stdout);
+                ret = 1;
                 goto fail_or_end;
-            }      
+            }
         }
-        fflush(stdout);
+
+        /* =========== blur cache ============== */
+        if ((ret = frame_cache_append(blur_cache, blur_buf))) {
+            printf("error: frame_cache_append failed.\n");
+            fflush(stdout);
+            goto fail_or_end;
+        }
+        if (frm_idx == sig_capacity) {
+            sig_capacity = sig_capacity ? sig_capacity * 2 : 64;
+            double *sig_realloc = realloc(sig, sizeof(*sig) * sig_sz * sig_capacity);
+            if (!sig_realloc) {
+                printf("error: realloc failed for frame signatures.\n");
+                fflush(stdout);
+                ret = 1;
+                goto fail_or_end;
+            }
+            sig = sig_realloc;
+        }
+        frame_signature(blur_buf, w, h, stride / sizeof(float), sig + (size_t)frm_idx * sig_sz);
+
         memcpy(prev_blur_buf, blur_buf, data_sz);
         memcpy(ref_buf, next_ref_buf, data_sz);
         memcpy(blur_buf, next_blur_buf, data_sz);
@@ -244,46 +353,74 @@ int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int strid
         }
     }
 
-    // The second pass (pass 1) is an N^2 comparison of relative motion between all frames
-    // in the input video file. The outer loop frame is referred to as 'b_frame_buf' and 
-    // the inner loop frame is 'c_frame_buf', you can think of 'b' as the reference frame
-    // for all the iteration of 'c' frames to be compared to. Blur buf's serve the same purpose
-    // but have blurring & convolutioin applied to eliminate noise to give more accurate motion scores
+    if ((ret = frame_cache_seal(blur_cache))) {
+        printf("error: frame_cache_seal failed.\n");
+        fflush(stdout);
+        goto fail_or_end;
+    }
+
+    // The second pass is a comparison of relative motion between frame pairs
+    // of the input video file, the 'b' frame being the frame of reference for
+    // all the 'c' frames it is compared to. Blurred frames are taken from the
+    // cache filled by the first pass, so every frame is read and blurred once.
+    // Only pairs whose gap meets the #define'd acceptable cinemagraph length
+    // can be selected, so no other pairs are compared:
     // b   c
     // ------
-    // 0   1   
-    // 0   2
+    // 0   9
+    // 0   10
     //  ...
-    // 2   2
-    // 2   3
+    // 0   15
+    // 1   10
     //  ...
-    // 51  52
-    pass = 1;
-    float *c_frame_buf = 0;
-    float *c_blur_buf = 0;
-    float *b_blur_buf = 0;
-    float *b_frame_buf = 0;
-    if (!(c_frame_buf = aligned_malloc(data_sz, MAX_ALIGN))) {
-        printf("error: aligned_malloc failed for c frame.\n");
-        fflush(stdout); 
-        goto fail_or_end;
-    }
-    if (!(c_blur_buf = aligned_malloc(data_sz, MAX_ALIGN))){
-        printf("error: aligned_malloc failed for c blur.\n");
-        fflush(stdout); 
-        goto fail_or_end;
-    }
-    if (!(b_frame_buf = aligned_malloc(data_sz, MAX_ALIGN))) {
-        printf("error: aligned_malloc failed for b_buf.\n");
-        fflush(stdout); 
-        goto fail_or_end;
-    }
-    if (!(b_blur_buf = aligned_malloc(data_sz, MAX_ALIGN))){
-        printf("error: aligned_malloc failed for b blur.\n");
-        fflush(stdout); 
-        goto fail_or_end;
+    LoopSearch search = {
+        .blur = blur_cache,
+        .sig = sig,
+        .sig_sz = sig_sz,
+        .w = w,
+        .h = h,
+        .stride = stride,
+        .n_frames = frame_cache_count(blur_cache),
+        .next_b = 0,
+        .bound = -1.0,
+    };
+    if (search.n_frames > 1) {
+        if (!(search.best_score = malloc(sizeof(*search.best_score) * search.n_frames)) ||
+            !(search.best_c = malloc(sizeof(*search.best_c) * search.n_frames)))
+        {
+            printf("error: malloc failed for loop search.\n");
+            fflush(stdout);
+            free(search.best_score);
+            ret = 1;
+            goto fail_or_end;
+        }
+        pthread_mutex_init(&search.mutex, NULL);
+
+        if (n_threads < 1) {
+            n_threads = 1;
+        }
+        if (n_threads > search.n_frames - 1) {
+            n_threads = search.n_frames - 1;
+        }
+        pthread_t *thread = calloc(n_threads, sizeof(*thread));
+        int n_started = 0;
+        if (thread) {
+            for (; n_started < n_threads; n_started++) {
+                if (pthread_create(&thread[n_started], NULL, loop_search_thread, &search)) {
+                    break;
+                }
+            }
+        }
+        // the calling thread takes part, so that progress is made even if no
+        // thread could be started
+        loop_search_thread(&search);
+        for (int t = 0; t < n_started; t++) {
+            pthread_join(thread[t], NULL);
+        }
+        free(thread);
+        pthread_mutex_destroy(&search.mutex);
     }
-    
+
     // Initialisation of scores and indices. The min_lower and min_upper are
     // initialised to give the entire video length as opposed to flag values 
     // that would pass errors back to the python process, so that if an error 
@@ -291,41 +428,25 @@ int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int strid
     float min = -1.0;
     int min_lower_idx = 0;
     int min_upper_idx = global_frm_idx-1;
-    // loop until all frames have been iterated over for comparison
-    for (int b_idx = 0; b_idx < global_frm_idx - 1; b_idx++){   
-        // read in the b frame to be the frame of reference  
-        read_noref_frame(b_frame_buf, temp_buf, stride, user_data, b_idx * w * h * FRAME_INDEX_OFFSET);
-        // offset and blur b_frame in preparation for comparison
-        offset_image(b_frame_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-        convolution_f32_c(FILTER_5, 5, b_frame_buf, b_blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float));      
-        // loop from the frame index immediately after the current 'b' frame index until
-        // the end of the frames
-        for (int c_idx = b_idx + 1; c_idx < global_frm_idx; c_idx++){        
-            // read the frame given by the 'c' index offset as the new comparison frame
-            read_noref_frame(c_frame_buf, temp_buf, stride, user_data, c_idx * w * h * FRAME_INDEX_OFFSET);
-            // offset and blur the 'c' frame in preparation for motion calculation
-            offset_image(c_frame_buf, OPT_RANGE_PIXEL_OFFSET, w, h, stride);
-            convolution_f32_c(FILTER_5, 5, c_frame_buf, c_blur_buf, temp_buf, w, h, stride / sizeof(float), stride / sizeof(float));
-            // compute the motion from b -> c with into score         
-            compute_motion(b_blur_buf, c_blur_buf, w, h, stride, stride, &score, pass);   
-            // min -1.0 is the condition that shows no genuine minimum has been found yet.
-            // Otherwise the motion must be less than the current minimum and the index gap
-            // must meet the #define'd acceptable cinemagraph length as measured in frames
-            if((min == -1.0 || score < min) && MIN_GAP * FPS < (c_idx - b_idx) && (c_idx - b_idx) < MAX_GAP * FPS){
-                min = score;
-                min_lower_idx = b_idx;
-                min_upper_idx = c_idx;
-            }           
-        } 
+    // reduce in 'b' order, so that the first pair with the least motion wins
+    // regardless of which thread compared it
+    for (int b_idx = 0; b_idx < search.n_frames - 1; b_idx++) {
+        if (search.best_c[b_idx] < 0) {
+            continue;
+        }
+        if (min == -1.0 || search.best_score[b_idx] < min) {
+            min = search.best_score[b_idx];
+            min_lower_idx = b_idx;
+            min_upper_idx = search.best_c[b_idx];
+        }
     }
     // print result to the pipe in expected format
     printf("%f,%d,%d\n", min, min_lower_idx, min_upper_idx);  
-    // cleanup
-    aligned_free(b_blur_buf);
-    aligned_free(b_frame_buf);
-    aligned_free(c_frame_buf);
-    aligned_free(c_blur_buf);
+    free(search.best_score);
+    free(search.best_c);
 fail_or_end:
+    frame_cache_destroy(blur_cache);
+    free(sig);
     aligned_free(ref_buf);
     aligned_free(prev_blur_buf);
     aligned_free(blur_buf);
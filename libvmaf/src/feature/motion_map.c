@@ -0,0 +1,138 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "motion_map.h"
+
+struct MotionMapSink {
+    FILE *outfile;
+    enum MotionMapFormat fmt;
+    int block;
+    int w, h;
+    int map_w, map_h;
+    float *accum;   // one row of block sums
+    void *line;     // one row of output values
+};
+
+int motion_map_sink_init(MotionMapSink **sink, FILE *outfile,
+                         enum MotionMapFormat fmt, int block, int w, int h)
+{
+    if (!sink) return -EINVAL;
+    if (!outfile) return -EINVAL;
+    if (block <= 0 || w <= 0 || h <= 0) return -EINVAL;
+
+    size_t value_sz;
+    switch (fmt) {
+    case MOTION_MAP_FMT_FLOAT32:
+        value_sz = sizeof(float);
+        break;
+    case MOTION_MAP_FMT_UINT16:
+        value_sz = sizeof(uint16_t);
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    MotionMapSink *const s = *sink = malloc(sizeof(*s));
+    if (!s) goto fail;
+    memset(s, 0, sizeof(*s));
+    s->outfile = outfile;
+    s->fmt = fmt;
+    s->block = block;
+    s->w = w;
+    s->h = h;
+    s->map_w = (w + block - 1) / block;
+    s->map_h = (h + block - 1) / block;
+
+    s->accum = malloc(sizeof(*s->accum) * s->map_w);
+    if (!s->accum) goto free_sink;
+    s->line = malloc(value_sz * s->map_w);
+    if (!s->line) goto free_accum;
+
+    return 0;
+
+free_accum:
+    free(s->accum);
+free_sink:
+    free(s);
+fail:
+    return -ENOMEM;
+}
+
+static int write_line(MotionMapSink *s, int rows)
+{
+    for (int k = 0; k < s->map_w; k++) {
+        const int cols = k == s->map_w - 1 ? s->w - k * s->block : s->block;
+        const float mean = s->accum[k] / (rows * cols);
+        if (s->fmt == MOTION_MAP_FMT_FLOAT32) {
+            ((float *) s->line)[k] = mean;
+        } else {
+            const float q = roundf(mean * 256.0f);
+            ((uint16_t *) s->line)[k] = q > UINT16_MAX ? UINT16_MAX : q;
+        }
+    }
+
+    const size_t value_sz = s->fmt == MOTION_MAP_FMT_FLOAT32 ?
+                            sizeof(float) : sizeof(uint16_t);
+    return fwrite(s->line, value_sz, s->map_w, s->outfile) == (size_t) s->map_w
+           ? 0 : -EIO;
+}
+
+int motion_map_sink_write(MotionMapSink *s, const float *img1,
+                          const float *img2, int img1_stride, int img2_stride)
+{
+    if (!s) return -EINVAL;
+    if (!img1 || !img2) return -EINVAL;
+
+    for (int i0 = 0; i0 < s->h; i0 += s->block) {
+        const int rows = i0 + s->block > s->h ? s->h - i0 : s->block;
+        memset(s->accum, 0, sizeof(*s->accum) * s->map_w);
+        for (int i = i0; i < i0 + rows; i++) {
+            const float *a = img1 + i * img1_stride;
+            const float *b = img2 + i * img2_stride;
+            if (s->block == 1) {
+                for (int j = 0; j < s->w; j++)
+                    s->accum[j] += fabsf(a[j] - b[j]);
+            } else {
+                for (int j = 0; j < s->w; j++)
+                    s->accum[j / s->block] += fabsf(a[j] - b[j]);
+            }
+        }
+        int err = write_line(s, rows);
+        if (err) return err;
+    }
+
+    return 0;
+}
+
+int motion_map_sink_close(MotionMapSink *s)
+{
+    if (!s) return -EINVAL;
+
+    const int err = fflush(s->outfile) ? -EIO : 0;
+    free(s->line);
+    free(s->accum);
+    free(s);
+    return err;
+}
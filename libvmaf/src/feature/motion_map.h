@@ -0,0 +1,51 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef MOTION_MAP_H_
+#define MOTION_MAP_H_
+
+#include <stdio.h>
+
+/*
+ * Sink for per-pixel absolute difference maps between consecutive blurred
+ * frames, as used for cinemagraph alpha masks. Every map is written as one
+ * raw frame of ceil(w / block) x ceil(h / block) values in host byte order,
+ * each value being the mean absolute difference over a block x block area:
+ *
+ *   MOTION_MAP_FMT_FLOAT32: float32
+ *   MOTION_MAP_FMT_UINT16:  uint16 fixed point, value * 256, saturated
+ */
+enum MotionMapFormat {
+    MOTION_MAP_FMT_FLOAT32 = 0,
+    MOTION_MAP_FMT_UINT16,
+};
+
+typedef struct MotionMapSink MotionMapSink;
+
+int motion_map_sink_init(MotionMapSink **sink, FILE *outfile,
+                         enum MotionMapFormat fmt, int block, int w, int h);
+
+/**
+ * Note: img1_stride and img2_stride are in terms of (sizeof(float) bytes)
+ */
+int motion_map_sink_write(MotionMapSink *sink, const float *img1,
+                          const float *img2, int img1_stride, int img2_stride);
+
+int motion_map_sink_close(MotionMapSink *sink);
+
+#endif /* MOTION_MAP_H_ */
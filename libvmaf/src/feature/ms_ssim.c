@@ -113,8 +113,13 @@ int _alloc_buffers(float **buf, int w, int h, int scales)
     return 0;
 }
 
-int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
-        int ref_stride, int cmp_stride, double *score,
+/*
+ * pixel_offset is subtracted from the ref and cmp pixels while they are
+ * copied into the working buffers, so that buffers offset for the other
+ * features do not need to be offset back first.
+ */
+int compute_ms_ssim_offset(const float *ref, const float *cmp, int w, int h,
+        int ref_stride, int cmp_stride, float pixel_offset, double *score,
         double* l_scores, double* c_scores, double* s_scores)
 {
 
@@ -220,8 +225,8 @@ int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
         src_offset = y * stride;
         offset = y * w;
         for (x=0; x<w; ++x, ++offset, ++src_offset) {
-            ref_imgs[0][offset] = (float)ref[src_offset];
-            cmp_imgs[0][offset] = (float)cmp[src_offset];
+            ref_imgs[0][offset] = (float)ref[src_offset] - pixel_offset;
+            cmp_imgs[0][offset] = (float)cmp[src_offset] - pixel_offset;
         }
     }
 
@@ -322,6 +327,14 @@ fail_or_end:
 
 }
 
+int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
+        int ref_stride, int cmp_stride, double *score,
+        double* l_scores, double* c_scores, double* s_scores)
+{
+    return compute_ms_ssim_offset(ref, cmp, w, h, ref_stride, cmp_stride, 0.0f,
+            score, l_scores, c_scores, s_scores);
+}
+
 int ms_ssim(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt)
 {
     double score = 0;
@@ -1,3 +1,7 @@
 int compute_ms_ssim(const float *ref, const float *cmp, int w, int h,
                     int ref_stride, int cmp_stride, double *score,
                     double* l_scores, double* c_scores, double* s_scores);
+int compute_ms_ssim_offset(const float *ref, const float *cmp, int w, int h,
+                           int ref_stride, int cmp_stride, float pixel_offset,
+                           double *score,
+                           double* l_scores, double* c_scores, double* s_scores);
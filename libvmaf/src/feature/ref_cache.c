@@ -0,0 +1,272 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feature_collector.h"
+#include "picture.h"
+#include "ref_cache.h"
+
+#define REF_CACHE_MAGIC "VMAFREFC"
+#define REF_CACHE_VERSION 1
+#define REF_CACHE_NAME_LEN 255
+
+typedef struct {
+    uint32_t pix_fmt, bpc, w, h;
+} RefCacheGeometry;
+
+typedef struct {
+    RefCacheGeometry geometry;
+    uint64_t *hash;
+    unsigned cnt, capacity;
+    VmafFeatureCollector *fc;
+} RefCacheFrames;
+
+struct VmafRefCache {
+    RefCacheFrames loaded; // read from a previous run
+    RefCacheFrames run;    // pictures read by this run
+    unsigned match_cnt;    // leading pictures identical to the previous run
+    bool diverged;
+};
+
+static int hash_append(RefCacheFrames *f, uint64_t hash)
+{
+    if (f->cnt >= f->capacity) {
+        size_t capacity = f->capacity ? f->capacity * 2 : 256;
+        uint64_t *h = realloc(f->hash, sizeof(*h) * capacity);
+        if (!h) return -ENOMEM;
+        f->hash = h;
+        f->capacity = capacity;
+    }
+    f->hash[f->cnt++] = hash;
+    return 0;
+}
+
+static int read_u32(FILE *infile, uint32_t *value)
+{
+    return fread(value, sizeof(*value), 1, infile) == 1 ? 0 : -EINVAL;
+}
+
+static int read_cache(VmafRefCache *c, FILE *infile)
+{
+    char magic[sizeof(REF_CACHE_MAGIC) - 1];
+    if (fread(magic, sizeof(magic), 1, infile) != 1) return -EINVAL;
+    if (memcmp(magic, REF_CACHE_MAGIC, sizeof(magic))) return -EINVAL;
+
+    uint32_t version, cnt;
+    RefCacheGeometry *g = &c->loaded.geometry;
+    int err = read_u32(infile, &version);
+    if (err || version != REF_CACHE_VERSION) return -EINVAL;
+    err  = read_u32(infile, &g->pix_fmt);
+    err |= read_u32(infile, &g->bpc);
+    err |= read_u32(infile, &g->w);
+    err |= read_u32(infile, &g->h);
+    err |= read_u32(infile, &cnt);
+    if (err) return -EINVAL;
+
+    for (unsigned i = 0; i < cnt; i++) {
+        uint64_t hash;
+        if (fread(&hash, sizeof(hash), 1, infile) != 1) return -EINVAL;
+        err = hash_append(&c->loaded, hash);
+        if (err) return err;
+    }
+
+    uint32_t name_len;
+    while (fread(&name_len, sizeof(name_len), 1, infile) == 1) {
+        char name[REF_CACHE_NAME_LEN + 1];
+        uint32_t n;
+        if (!name_len || name_len > REF_CACHE_NAME_LEN) return -EINVAL;
+        if (fread(name, name_len, 1, infile) != 1) return -EINVAL;
+        name[name_len] = '\0';
+        if (read_u32(infile, &n)) return -EINVAL;
+        for (unsigned i = 0; i < n; i++) {
+            uint32_t index;
+            double value;
+            if (read_u32(infile, &index)) return -EINVAL;
+            if (fread(&value, sizeof(value), 1, infile) != 1) return -EINVAL;
+            if (index >= cnt) return -EINVAL;
+            err = vmaf_feature_collector_append(c->loaded.fc, name, value,
+                                                index);
+            if (err) return err;
+        }
+    }
+    return ferror(infile) ? -EIO : 0;
+}
+
+int vmaf_ref_cache_init(VmafRefCache **cache, FILE *infile)
+{
+    if (!cache) return -EINVAL;
+
+    VmafRefCache *const c = *cache = malloc(sizeof(*c));
+    if (!c) return -ENOMEM;
+    memset(c, 0, sizeof(*c));
+
+    int err = vmaf_feature_collector_init(&c->loaded.fc);
+    if (err) goto free_c;
+    err = vmaf_feature_collector_init(&c->run.fc);
+    if (err) goto free_loaded;
+
+    if (infile && (err = read_cache(c, infile))) {
+        if (err == -ENOMEM) goto free_run;
+        // a truncated or corrupt cache is used as an empty one, and replaced
+        // when written
+        vmaf_feature_collector_destroy(c->loaded.fc);
+        free(c->loaded.hash);
+        memset(&c->loaded, 0, sizeof(c->loaded));
+        err = vmaf_feature_collector_init(&c->loaded.fc);
+        if (err) goto free_run;
+    }
+    return 0;
+
+free_run:
+    vmaf_feature_collector_destroy(c->run.fc);
+free_loaded:
+    vmaf_feature_collector_destroy(c->loaded.fc);
+free_c:
+    free(c->loaded.hash);
+    free(c);
+    return err;
+}
+
+int vmaf_ref_cache_frame(VmafRefCache *c, VmafPicture *ref, unsigned index)
+{
+    if (!c) return -EINVAL;
+    if (!ref) return -EINVAL;
+    // the chained hash needs every picture, in order
+    if (index != c->run.cnt) return -EINVAL;
+
+    const RefCacheGeometry g = {
+        .pix_fmt = ref->pix_fmt, .bpc = ref->bpc,
+        .w = ref->w[0], .h = ref->h[0],
+    };
+    if (!index)
+        c->run.geometry = g;
+    else if (memcmp(&g, &c->run.geometry, sizeof(g)))
+        return -EINVAL;
+
+    const uint64_t seed = index ? c->run.hash[index - 1] :
+                          vmaf_hash_bytes(0, &g, sizeof(g));
+    uint64_t plane_hash[3];
+    int err = vmaf_picture_hash(ref, plane_hash);
+    if (err) return err;
+    const uint64_t hash = vmaf_hash_bytes(seed, plane_hash,
+                                          sizeof(plane_hash));
+    err = hash_append(&c->run, hash);
+    if (err) return err;
+
+    // chained hashes can only match as long as all previous pictures did
+    if (!c->diverged && index < c->loaded.cnt &&
+        c->loaded.hash[index] == hash)
+    {
+        c->match_cnt = index + 1;
+    } else {
+        c->diverged = true;
+    }
+    return 0;
+}
+
+int vmaf_ref_cache_get(VmafRefCache *c, char *name, unsigned index,
+                       double *value)
+{
+    if (!c) return -EINVAL;
+    if (!name) return -EINVAL;
+    if (!value) return -EINVAL;
+    if (index >= c->match_cnt) return -EINVAL;
+
+    return vmaf_feature_collector_get_score(c->loaded.fc, name, value, index);
+}
+
+int vmaf_ref_cache_put(VmafRefCache *c, char *name, unsigned index,
+                       double value)
+{
+    if (!c) return -EINVAL;
+    if (!name) return -EINVAL;
+    if (index >= c->run.cnt) return -EINVAL;
+
+    double cached;
+    if (!vmaf_ref_cache_get(c, name, index, &cached))
+        return 0;
+    return vmaf_feature_collector_append(c->run.fc, name, value, index);
+}
+
+static int write_u32(FILE *outfile, uint32_t value)
+{
+    return fwrite(&value, sizeof(value), 1, outfile) == 1 ? 0 : -EIO;
+}
+
+static int write_feature_vector(FILE *outfile, FeatureVector *fv,
+                                unsigned index_high)
+{
+    const size_t name_len = strlen(fv->name);
+    if (!name_len || name_len > REF_CACHE_NAME_LEN) return -EINVAL;
+
+    uint32_t n = 0;
+    for (unsigned i = 0; i < index_high && i < fv->capacity; i++)
+        n += fv->score[i].written;
+    if (!n) return 0;
+
+    int err = write_u32(outfile, name_len);
+    if (err) return err;
+    if (fwrite(fv->name, name_len, 1, outfile) != 1) return -EIO;
+    err = write_u32(outfile, n);
+    if (err) return err;
+    for (unsigned i = 0; i < index_high && i < fv->capacity; i++) {
+        if (!fv->score[i].written) continue;
+        err = write_u32(outfile, i);
+        if (err) return err;
+        if (fwrite(&fv->score[i].value, sizeof(double), 1, outfile) != 1)
+            return -EIO;
+    }
+    return 0;
+}
+
+int vmaf_ref_cache_write(VmafRefCache *c, FILE *outfile)
+{
+    if (!c) return -EINVAL;
+    if (!outfile) return -EINVAL;
+
+    const RefCacheGeometry *g = &c->run.geometry;
+    if (fwrite(REF_CACHE_MAGIC, sizeof(REF_CACHE_MAGIC) - 1, 1, outfile) != 1)
+        return -EIO;
+    int err = write_u32(outfile, REF_CACHE_VERSION);
+    err |= write_u32(outfile, g->pix_fmt);
+    err |= write_u32(outfile, g->bpc);
+    err |= write_u32(outfile, g->w);
+    err |= write_u32(outfile, g->h);
+    err |= write_u32(outfile, c->run.cnt);
+    if (err) return -EIO;
+    if (c->run.cnt &&
+        fwrite(c->run.hash, sizeof(*c->run.hash), c->run.cnt, outfile) !=
+        c->run.cnt)
+    {
+        return -EIO;
+    }
+
+    // values of the previous run are only valid for the matching pictures
+    VmafFeatureCollector *const loaded = c->loaded.fc;
+    for (unsigned j = 0; j < loaded->cnt; j++) {
+        err = write_feature_vector(outfile, loaded->feature_vector[j],
+                                   c->match_cnt);
+        if (err) return err;
+    }
+    VmafFeatureCollector *const run = c->run.fc;
+    for (unsigned j = 0; j < run->cnt; j++) {
+        err = write_feature_vector(outfile, run->feature_vector[j],
+                                   c->run.cnt);
+        if (err) return err;
+    }
+
+    return ferror(outfile) ? -EIO : 0;
+}
+
+void vmaf_ref_cache_destroy(VmafRefCache *c)
+{
+    if (!c) return;
+    vmaf_feature_collector_destroy(c->loaded.fc);
+    vmaf_feature_collector_destroy(c->run.fc);
+    free(c->loaded.hash);
+    free(c->run.hash);
+    free(c);
+}
@@ -0,0 +1,45 @@
+#ifndef __VMAF_REF_CACHE_H__
+#define __VMAF_REF_CACHE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "feature_collector.h"
+
+#include "libvmaf/picture.h"
+
+/*
+ * Reference cache: reference-only intermediates of feature extractors
+ * (e.g. motion scores, ADM CSF denominators), kept across runs so that
+ * later runs against the same reference only compute the work which
+ * depends on the distorted pictures.
+ *
+ * Every picture is keyed by a content hash chained over all reference
+ * pictures read so far, values are only served for a prefix of pictures
+ * identical to the run which wrote the cache. Binary, host byte order:
+ *
+ *   "VMAFREFC" <u32 version> <u32 pix_fmt> <u32 bpc> <u32 w> <u32 h> <u32 cnt>
+ *   <u64 hash> * cnt
+ *   <u32 name_len> <name> <u32 n> (<u32 index> <f64 value>) * n
+ *   ...
+ */
+
+typedef struct VmafRefCache VmafRefCache;
+
+// infile may be NULL, a truncated or corrupt infile serves no values
+int vmaf_ref_cache_init(VmafRefCache **cache, FILE *infile);
+
+int vmaf_ref_cache_frame(VmafRefCache *cache, VmafPicture *ref,
+                         unsigned index);
+
+int vmaf_ref_cache_get(VmafRefCache *cache, char *name, unsigned index,
+                       double *value);
+
+int vmaf_ref_cache_put(VmafRefCache *cache, char *name, unsigned index,
+                       double value);
+
+int vmaf_ref_cache_write(VmafRefCache *cache, FILE *outfile);
+
+void vmaf_ref_cache_destroy(VmafRefCache *cache);
+
+#endif /* __VMAF_REF_CACHE_H__ */
@@ -45,8 +45,13 @@ float _ssim_reduce(int w, int h, void *ctx)
     return (float)(*ssim_sum / (double)(w*h));
 }
 
-int compute_ssim(const float *ref, const float *cmp, int w, int h,
-        int ref_stride, int cmp_stride, double *score,
+/*
+ * pixel_offset is subtracted from the ref and cmp pixels while they are
+ * copied into the working buffers, so that buffers offset for the other
+ * features do not need to be offset back first.
+ */
+int compute_ssim_offset(const float *ref, const float *cmp, int w, int h,
+        int ref_stride, int cmp_stride, float pixel_offset, double *score,
         double *l_score, double *c_score, double *s_score)
 {
 
@@ -113,8 +118,8 @@ int compute_ssim(const float *ref, const float *cmp, int w, int h,
         src_offset = y * stride;
         offset = y * w;
         for (x=0; x<w; ++x, ++offset, ++src_offset) {
-            ref_f[offset] = (float)ref[src_offset];
-            cmp_f[offset] = (float)cmp[src_offset];
+            ref_f[offset] = (float)ref[src_offset] - pixel_offset;
+            cmp_f[offset] = (float)cmp[src_offset] - pixel_offset;
         }
     }
 
@@ -177,6 +182,14 @@ fail_or_end:
 
 }
 
+int compute_ssim(const float *ref, const float *cmp, int w, int h,
+        int ref_stride, int cmp_stride, double *score,
+        double *l_score, double *c_score, double *s_score)
+{
+    return compute_ssim_offset(ref, cmp, w, h, ref_stride, cmp_stride, 0.0f,
+            score, l_score, c_score, s_score);
+}
+
 int ssim(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt)
 {
     double score = 0;
@@ -1,3 +1,7 @@
 int compute_ssim(const float *ref, const float *cmp, int w, int h,
                  int ref_stride, int cmp_stride, double *score,
                  double *l_score, double *c_score, double *s_score);
+int compute_ssim_offset(const float *ref, const float *cmp, int w, int h,
+                        int ref_stride, int cmp_stride, float pixel_offset,
+                        double *score,
+                        double *l_score, double *c_score, double *s_score);
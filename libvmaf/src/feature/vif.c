@@ -16,6 +16,7 @@
  *
  */
 
+#include <errno.h>
 #include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -27,7 +28,9 @@
 #include "common/convolution.h"
 #include "offset.h"
 #include "vif_options.h"
+#include "vif.h"
 #include "vif_tools.h"
+#include "thread_pool.h"
 
 #define vif_filter1d_table vif_filter1d_table_s
 #define vif_filter1d       vif_filter1d_s
@@ -42,6 +45,14 @@
 #define vif_filter1d_sq    vif_filter1d_sq_s
 #define vif_filter1d_xy    vif_filter1d_xy_s
 
+#define vif_filter1d_rows    vif_filter1d_rows_s
+#define vif_filter1d_sq_rows vif_filter1d_sq_rows_s
+#define vif_filter1d_xy_rows vif_filter1d_xy_rows_s
+#define vif_statistic_rows   vif_statistic_rows_s
+
+/* stripes smaller than this are not worth a thread */
+#define VIF_STRIPE_MIN_ROWS 16
+
 /**
  * Note: stride is in terms of bytes
  */
@@ -290,6 +301,271 @@ fail_or_end:
     return ret;
 }
 
+struct VifRefState
+{
+    int start_scale;
+    int buf_stride;
+    float *data_buf;
+    int w[4], h[4];
+
+    /* optional, every scale runs in horizontal stripes on it */
+    VmafThreadPool *pool;
+    /* per row num and den sums of a scale */
+    float *num_rows, *den_rows;
+
+    /* reference side, per scale */
+    const float *ref_scale[4];
+    int ref_stride[4];
+    float *mu1[4];
+    float *ref_sq_filt[4];
+
+    /* distorted side, reused for every distorted picture */
+    float *dis_scale[2]; /* alternates, as the next scale reads it while written */
+    float *mu2;
+    float *dis_sq_filt;
+    float *ref_dis_filt;
+    float *tmpbuf;
+};
+
+#ifdef VIF_OPT_HANDLE_BORDERS
+#define VIF_FILTER_ADJ(scale) 0
+#else
+#define VIF_FILTER_ADJ(scale) (vif_filter1d_width[scale] / 2)
+#endif
+
+/* offset pointer to adjust for convolution border handling */
+#define VIF_ADJUST(x, scale, stride) \
+    ((float *)((char *)(x) + VIF_FILTER_ADJ(scale) * (stride) + VIF_FILTER_ADJ(scale) * sizeof(float)))
+
+int vif_ref_state_init(VifRefState **state, int w, int h, int start_scale, VmafThreadPool *pool)
+{
+    VifRefState *s;
+    char *data_top;
+    int buf_stride = ALIGN_CEIL(w * sizeof(float));
+    size_t buf_sz_one = (size_t)buf_stride * h;
+    size_t ref_sz = 0;
+
+    // 5 full size buffers for the distorted side, plus the reference side of every scale
+#define VIF_REF_BUF_CNT 8
+    if (SIZE_MAX / buf_sz_one < VIF_REF_BUF_CNT)
+        return -EINVAL;
+
+    if (!(s = *state = malloc(sizeof(*s))))
+        return -ENOMEM;
+    memset(s, 0, sizeof(*s));
+    s->start_scale = start_scale;
+    s->buf_stride = buf_stride;
+    s->pool = pool;
+
+    for (int scale = 0; scale < 4; ++scale)
+    {
+        if (scale > 0)
+        {
+            w = (w - VIF_FILTER_ADJ(scale) * 2) / 2;
+            h = (h - VIF_FILTER_ADJ(scale) * 2) / 2;
+        }
+        s->w[scale] = w;
+        s->h[scale] = h;
+        ref_sz += (size_t)buf_stride * h * (scale > 0 ? 3 : 2);
+    }
+
+    // the second distorted scale buffer only holds scales 1 and 3
+    if (!(s->data_buf = aligned_malloc(buf_sz_one * 5 + (size_t)buf_stride * s->h[1] + ref_sz, MAX_ALIGN)) ||
+        !(s->num_rows = malloc(sizeof(*s->num_rows) * s->h[0] * 2)))
+    {
+        vif_ref_state_destroy(s);
+        *state = NULL;
+        return -ENOMEM;
+    }
+    s->den_rows = s->num_rows + s->h[0];
+
+    data_top = (char *)s->data_buf;
+    s->dis_scale[0] = (float *)data_top; data_top += buf_sz_one;
+    s->dis_scale[1] = (float *)data_top; data_top += (size_t)buf_stride * s->h[1];
+    s->mu2          = (float *)data_top; data_top += buf_sz_one;
+    s->dis_sq_filt  = (float *)data_top; data_top += buf_sz_one;
+    s->ref_dis_filt = (float *)data_top; data_top += buf_sz_one;
+    s->tmpbuf       = (float *)data_top; data_top += buf_sz_one;
+    for (int scale = 0; scale < 4; ++scale)
+    {
+        size_t sz = (size_t)buf_stride * s->h[scale];
+        if (scale > 0)
+        {
+            s->ref_scale[scale] = (float *)data_top; data_top += sz;
+            s->ref_stride[scale] = buf_stride;
+        }
+        s->mu1[scale]         = (float *)data_top; data_top += sz;
+        s->ref_sq_filt[scale] = (float *)data_top; data_top += sz;
+    }
+
+    return 0;
+}
+
+void vif_ref_state_destroy(VifRefState *s)
+{
+    if (!s)
+        return;
+    aligned_free(s->data_buf);
+    free(s->num_rows);
+    free(s);
+}
+
+/* One scale of compute_vif_ref() or compute_vif_dis(), split in stripes of its rows */
+typedef struct VifStripes
+{
+    VifRefState *s;
+    int scale;
+    const float *src; /* the previous scale when decimating */
+    int src_stride;
+    float *dst;
+} VifStripes;
+
+/* filters the rows of the previous scale that are decimated to the rows */
+static void vif_dec_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+    VifStripes *st = data;
+    VifRefState *s = st->s;
+    int buf_stride = s->buf_stride;
+    int adj = VIF_FILTER_ADJ(st->scale);
+    int prev_w = s->w[st->scale - 1];
+    int prev_h = s->h[st->scale - 1];
+    float *mu2 = s->mu2 + (2 * row_begin) * (buf_stride / sizeof(float));
+
+    vif_filter1d_rows(vif_filter1d_table[st->scale], st->src, s->mu2, s->tmpbuf, prev_w, prev_h, st->src_stride, buf_stride,
+                      vif_filter1d_width[st->scale], 2 * row_begin + adj, 2 * row_end + adj - 1);
+    vif_dec2(VIF_ADJUST(mu2, st->scale, buf_stride), st->dst + row_begin * (buf_stride / sizeof(float)),
+             prev_w - adj * 2, (row_end - row_begin) * 2, buf_stride, buf_stride);
+}
+
+static void vif_ref_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+    VifStripes *st = data;
+    VifRefState *s = st->s;
+    int scale = st->scale;
+
+    vif_filter1d_rows(vif_filter1d_table[scale], s->ref_scale[scale], s->mu1[scale], s->tmpbuf, s->w[scale], s->h[scale],
+                      s->ref_stride[scale], s->buf_stride, vif_filter1d_width[scale], row_begin, row_end);
+    vif_filter1d_sq_rows(vif_filter1d_table[scale], s->ref_scale[scale], s->ref_sq_filt[scale], s->tmpbuf, s->w[scale], s->h[scale],
+                         s->ref_stride[scale], s->buf_stride, vif_filter1d_width[scale], row_begin, row_end);
+}
+
+static void vif_dis_stripe(void *data, unsigned row_begin, unsigned row_end)
+{
+    VifStripes *st = data;
+    VifRefState *s = st->s;
+    const float *filter = vif_filter1d_table[st->scale];
+    int filter_width = vif_filter1d_width[st->scale];
+    int buf_stride = s->buf_stride;
+    int scale = st->scale;
+    int w = s->w[scale];
+    int h = s->h[scale];
+
+    vif_filter1d_rows(filter, st->src, s->mu2, s->tmpbuf, w, h, st->src_stride, buf_stride, filter_width, row_begin, row_end);
+    vif_filter1d_sq_rows(filter, st->src, s->dis_sq_filt, s->tmpbuf, w, h, st->src_stride, buf_stride, filter_width, row_begin, row_end);
+    vif_filter1d_xy_rows(filter, s->ref_scale[scale], st->src, s->ref_dis_filt, s->tmpbuf, w, h, s->ref_stride[scale], st->src_stride, buf_stride, filter_width, row_begin, row_end);
+    vif_statistic_rows(s->mu1[scale], s->mu2, NULL, s->ref_sq_filt[scale], s->dis_sq_filt, s->ref_dis_filt, s->num_rows + row_begin, s->den_rows + row_begin,
+        w, buf_stride, buf_stride, buf_stride, buf_stride, buf_stride, buf_stride, buf_stride, buf_stride, row_begin, row_end);
+}
+
+int compute_vif_ref(VifRefState *s, const float *ref, int ref_stride)
+{
+    VifStripes st = { .s = s };
+    int err;
+
+    s->ref_scale[0] = ref;
+    s->ref_stride[0] = ref_stride;
+
+    for (int scale = 0; scale < 4; ++scale)
+    {
+        st.scale = scale;
+
+        if (scale > 0)
+        {
+            st.src = s->ref_scale[scale - 1];
+            st.src_stride = s->ref_stride[scale - 1];
+            st.dst = (float *)s->ref_scale[scale];
+            err = vmaf_thread_pool_stripes(s->pool, s->h[scale], VIF_STRIPE_MIN_ROWS, vif_dec_stripe, &st);
+            if (err)
+                return err;
+        }
+
+        /* skipped scales are only decimated */
+        if (scale < s->start_scale)
+            continue;
+
+        err = vmaf_thread_pool_stripes(s->pool, s->h[scale], VIF_STRIPE_MIN_ROWS, vif_ref_stripe, &st);
+        if (err)
+            return err;
+    }
+
+    return 0;
+}
+
+int compute_vif_dis(VifRefState *s, const float *dis, int dis_stride, double *score, double *score_num, double *score_den, double *scores)
+{
+    VifStripes st = { .s = s, .src = dis, .src_stride = dis_stride };
+    float num, den;
+    int err;
+
+    for (int scale = 0; scale < 4; ++scale)
+    {
+        int h = s->h[scale];
+
+        st.scale = scale;
+
+        if (scale > 0)
+        {
+            st.dst = s->dis_scale[scale & 1];
+            err = vmaf_thread_pool_stripes(s->pool, h, VIF_STRIPE_MIN_ROWS, vif_dec_stripe, &st);
+            if (err)
+                return err;
+            st.src = st.dst;
+            st.src_stride = s->buf_stride;
+        }
+
+        if (scale < s->start_scale)
+        {
+            scores[2*scale] = 0.0;
+            scores[2*scale+1] = 0.0;
+            continue;
+        }
+
+        err = vmaf_thread_pool_stripes(s->pool, h, VIF_STRIPE_MIN_ROWS, vif_dis_stripe, &st);
+        if (err)
+            return err;
+
+        /* reduced in row order, as vif_statistic() does */
+        num = 0;
+        den = 0;
+        for (int i = 0; i < h; ++i)
+        {
+            num += s->num_rows[i];
+            den += s->den_rows[i];
+        }
+
+        scores[2*scale] = num;
+        scores[2*scale+1] = den;
+    }
+
+    *score_num = 0.0;
+    *score_den = 0.0;
+    for (int scale = 0; scale < 4; ++scale)
+    {
+        *score_num += scores[2*scale];
+        *score_den += scores[2*scale+1];
+    }
+    if (*score_den == 0.0)
+    {
+        *score = 1.0f;
+    }
+    else
+    {
+        *score = (*score_num) / (*score_den);
+    }
+
+    return 0;
+}
+
 int vif(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt)
 {
     double score = 0;
@@ -1 +1,24 @@
+#include "thread_pool.h"
+
 int compute_vif(const float *ref, const float *dis, int w, int h, int ref_stride, int dis_stride, double *score, double *score_num, double *score_den, double *scores);
+
+/*
+ * compute_vif() split in a reference pass and a distorted pass, so that the
+ * reference side (decimation, mu1 and ref_sq_filt of every scale) is
+ * computed once and shared by several distorted pictures of the same
+ * reference. ref has to stay valid until the last compute_vif_dis().
+ * Scales below start_scale are only decimated, their num and den scores
+ * are 0. With a pool, every scale is split in horizontal stripes run on it.
+ */
+typedef struct VifRefState VifRefState;
+
+int vif_ref_state_init(VifRefState **state, int w, int h, int start_scale,
+                       VmafThreadPool *pool);
+
+int compute_vif_ref(VifRefState *state, const float *ref, int ref_stride);
+
+int compute_vif_dis(VifRefState *state, const float *dis, int dis_stride,
+                    double *score, double *score_num, double *score_den,
+                    double *scores);
+
+void vif_ref_state_destroy(VifRefState *state);
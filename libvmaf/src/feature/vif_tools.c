@@ -212,8 +212,8 @@ void vif_xx_yy_xy_s(const float *x, const float *y, float *xx, float *yy, float
     }
 }
 
-void vif_statistic_s(const float *mu1, const float *mu2, const float *mu1_mu2, const float *xx_filt, const float *yy_filt, const float *xy_filt, float *num, float *den,
-	int w, int h, int mu1_stride, int mu2_stride, int mu1_mu2_stride, int xx_filt_stride, int yy_filt_stride, int xy_filt_stride, int num_stride, int den_stride)
+void vif_statistic_rows_s(const float *mu1, const float *mu2, const float *mu1_mu2, const float *xx_filt, const float *yy_filt, const float *xy_filt, float *num, float *den,
+	int w, int mu1_stride, int mu2_stride, int mu1_mu2_stride, int xx_filt_stride, int yy_filt_stride, int xy_filt_stride, int num_stride, int den_stride, int row_begin, int row_end)
 {
 	static const float sigma_nsq = 2;
 	static const float sigma_max_inv = 4.0 / (255.0*255.0);
@@ -229,10 +229,7 @@ void vif_statistic_s(const float *mu1, const float *mu2, const float *mu1_mu2, c
 	float num_val, den_val;
 	int i, j;
 
-	float accum_num = 0.0;
-	float accum_den = 0.0;
-
-	for (i = 0; i < h; ++i) {
+	for (i = row_begin; i < row_end; ++i) {
 		float accum_inner_num = 0;
 		float accum_inner_den = 0;
 		for (j = 0; j < w; ++j) {
@@ -271,14 +268,30 @@ void vif_statistic_s(const float *mu1, const float *mu2, const float *mu1_mu2, c
 			accum_inner_den += den_val;
 		}
 
-		accum_num += accum_inner_num;
-		accum_den += accum_inner_den;
+		num[i - row_begin] = accum_inner_num;
+		den[i - row_begin] = accum_inner_den;
+	}
+}
+
+void vif_statistic_s(const float *mu1, const float *mu2, const float *mu1_mu2, const float *xx_filt, const float *yy_filt, const float *xy_filt, float *num, float *den,
+	int w, int h, int mu1_stride, int mu2_stride, int mu1_mu2_stride, int xx_filt_stride, int yy_filt_stride, int xy_filt_stride, int num_stride, int den_stride)
+{
+	float accum_num = 0.0;
+	float accum_den = 0.0;
+	float num_row, den_row;
+	int i;
+
+	for (i = 0; i < h; ++i) {
+		vif_statistic_rows_s(mu1, mu2, mu1_mu2, xx_filt, yy_filt, xy_filt, &num_row, &den_row,
+			w, mu1_stride, mu2_stride, mu1_mu2_stride, xx_filt_stride, yy_filt_stride, xy_filt_stride, num_stride, den_stride, i, i + 1);
+		accum_num += num_row;
+		accum_den += den_row;
 	}
 	num[0] = accum_num;
 	den[0] = accum_den;
 }
 
-void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth)
+void vif_filter1d_rows_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth, int row_begin, int row_end)
 {
 
     int src_px_stride = src_stride / sizeof(float);
@@ -288,7 +301,7 @@ void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf,
 
     if (cpu >= VMAF_CPU_AVX)
     {
-        convolution_f32_avx_s(f, fwidth, src, dst, tmpbuf, w, h, src_px_stride, dst_px_stride);
+        convolution_f32_avx_rows_s(f, fwidth, src, dst, tmpbuf, w, h, src_px_stride, dst_px_stride, row_begin, row_end);
         return;
     }
 
@@ -299,7 +312,7 @@ void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf,
 
     int i, j, fi, fj, ii, jj;
 
-    for (i = 0; i < h; ++i) {
+    for (i = row_begin; i < row_end; ++i) {
         /* Vertical pass. */
         for (j = 0; j < w; ++j) {
             float accum = 0;
@@ -340,10 +353,15 @@ void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf,
     aligned_free(tmp);
 }
 
+void vif_filter1d_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth)
+{
+    vif_filter1d_rows_s(f, src, dst, tmpbuf, w, h, src_stride, dst_stride, fwidth, 0, h);
+}
+
 // Code optimized by adding intrinsic code for the functions,
 // vif_filter1d_sq and vif_filter1d_sq
 
-void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth)
+void vif_filter1d_sq_rows_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth, int row_begin, int row_end)
 {
 
 	int src_px_stride = src_stride / sizeof(float);
@@ -353,7 +371,7 @@ void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpb
 	
 	if (cpu >= VMAF_CPU_AVX)
 	{
-		convolution_f32_avx_sq_s(f, fwidth, src, dst, tmpbuf, w, h, src_px_stride, dst_px_stride);
+		convolution_f32_avx_sq_rows_s(f, fwidth, src, dst, tmpbuf, w, h, src_px_stride, dst_px_stride, row_begin, row_end);
 		return;
 	}
 
@@ -364,7 +382,7 @@ void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpb
 
 	int i, j, fi, fj, ii, jj;
 
-	for (i = 0; i < h; ++i) {
+	for (i = row_begin; i < row_end; ++i) {
 		/* Vertical pass. */
 		for (j = 0; j < w; ++j) {
 			float accum = 0;
@@ -405,7 +423,12 @@ void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpb
 	aligned_free(tmp);
 }
 
-void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, float *dst, float *tmpbuf, int w, int h, int src1_stride, int src2_stride, int dst_stride, int fwidth)
+void vif_filter1d_sq_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth)
+{
+	vif_filter1d_sq_rows_s(f, src, dst, tmpbuf, w, h, src_stride, dst_stride, fwidth, 0, h);
+}
+
+void vif_filter1d_xy_rows_s(const float *f, const float *src1, const float *src2, float *dst, float *tmpbuf, int w, int h, int src1_stride, int src2_stride, int dst_stride, int fwidth, int row_begin, int row_end)
 {
 
 	int src1_px_stride = src1_stride / sizeof(float);
@@ -416,7 +439,7 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 
 	if (cpu >= VMAF_CPU_AVX)
 	{
-		convolution_f32_avx_xy_s(f, fwidth, src1, src2, dst, tmpbuf, w, h, src1_px_stride, src2_px_stride, dst_px_stride);
+		convolution_f32_avx_xy_rows_s(f, fwidth, src1, src2, dst, tmpbuf, w, h, src1_px_stride, src2_px_stride, dst_px_stride, row_begin, row_end);
 		return;
 	}
 
@@ -427,7 +450,7 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 
 	int i, j, fi, fj, ii, jj;
 
-	for (i = 0; i < h; ++i) {
+	for (i = row_begin; i < row_end; ++i) {
 		/* Vertical pass. */
 		for (j = 0; j < w; ++j) {
 			float accum = 0;
@@ -469,6 +492,11 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 	aligned_free(tmp);
 }
 
+void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, float *dst, float *tmpbuf, int w, int h, int src1_stride, int src2_stride, int dst_stride, int fwidth)
+{
+	vif_filter1d_xy_rows_s(f, src1, src2, dst, tmpbuf, w, h, src1_stride, src2_stride, dst_stride, fwidth, 0, h);
+}
+
 void vif_filter2d_s(const float *f, const float *src, float *dst, int w, int h, int src_stride, int dst_stride, int fwidth)
 {
     int src_px_stride = src_stride / sizeof(float);
@@ -49,4 +49,20 @@ void vif_filter1d_xy_s(const float *f, const float *src1, const float *src2, flo
 
 void vif_filter2d_s(const float *f, const float *src, float *dst, int w, int h, int src_stride, int dst_stride, int fwidth);
 
+/*
+ * Row range versions of the above, for horizontal stripes processed in
+ * parallel: only the rows [row_begin, row_end) of dst are written, the rows
+ * around them are read from the complete input. vif_statistic_rows_s()
+ * returns the sums of row i in num[i - row_begin] and den[i - row_begin],
+ * to be reduced in row order.
+ */
+void vif_statistic_rows_s(const float *mu1_sq, const float *mu2_sq, const float *mu1_mu2, const float *xx_filt, const float *yy_filt, const float *xy_filt, float *num, float *den,
+                          int w, int mu1_sq_stride, int mu2_sq_stride, int mu1_mu2_stride, int xx_filt_stride, int yy_filt_stride, int xy_filt_stride, int num_stride, int den_stride, int row_begin, int row_end);
+
+void vif_filter1d_rows_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth, int row_begin, int row_end);
+
+void vif_filter1d_sq_rows_s(const float *f, const float *src, float *dst, float *tmpbuf, int w, int h, int src_stride, int dst_stride, int fwidth, int row_begin, int row_end);
+
+void vif_filter1d_xy_rows_s(const float *f, const float *src1, const float *src2, float *dst, float *tmpbuf, int w, int h, int src1_stride, int src2_stride, int dst_stride, int fwidth, int row_begin, int row_end);
+
 #endif /* VIF_TOOLS_H_ */
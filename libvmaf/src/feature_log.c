@@ -0,0 +1,109 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "feature_log.h"
+
+#define FEATURE_LOG_HEADER_SIZE 32
+
+static int write_u32(FILE *outfile, uint32_t v)
+{
+    uint8_t b[4];
+    for (unsigned i = 0; i < sizeof(b); i++)
+        b[i] = (v >> (8 * i)) & 0xff;
+    return fwrite(b, sizeof(b), 1, outfile) == 1 ? 0 : -EIO;
+}
+
+static int write_u64(FILE *outfile, uint64_t v)
+{
+    uint8_t b[8];
+    for (unsigned i = 0; i < sizeof(b); i++)
+        b[i] = (v >> (8 * i)) & 0xff;
+    return fwrite(b, sizeof(b), 1, outfile) == 1 ? 0 : -EIO;
+}
+
+static int write_f64(FILE *outfile, double v)
+{
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    return write_u64(outfile, u);
+}
+
+int vmaf_feature_log_write(FILE *outfile, const char *const *name,
+                           unsigned n_features, const unsigned *frame_num,
+                           unsigned n_frames, VmafFeatureLogScore get_score,
+                           void *ctx)
+{
+    if (!outfile) return -EINVAL;
+    if (n_features && !name) return -EINVAL;
+    if (n_frames && !frame_num) return -EINVAL;
+    if (!get_score) return -EINVAL;
+
+    for (unsigned j = 0; j < n_features; j++) {
+        if (!name[j] || strlen(name[j]) >= VMAF_FEATURE_LOG_NAME_SIZE)
+            return -EINVAL;
+    }
+
+    const uint64_t header_size = FEATURE_LOG_HEADER_SIZE +
+        (uint64_t) n_features * VMAF_FEATURE_LOG_NAME_SIZE;
+    const uint64_t data_offset = (header_size + VMAF_FEATURE_LOG_ALIGN - 1) /
+        VMAF_FEATURE_LOG_ALIGN * VMAF_FEATURE_LOG_ALIGN;
+
+    int err = 0;
+    if (fwrite(VMAF_FEATURE_LOG_MAGIC, sizeof(VMAF_FEATURE_LOG_MAGIC), 1,
+               outfile) != 1)
+        return -EIO;
+    err |= write_u32(outfile, VMAF_FEATURE_LOG_VERSION);
+    err |= write_u32(outfile, n_features);
+    err |= write_u64(outfile, n_frames);
+    err |= write_u64(outfile, data_offset);
+    if (err) return -EIO;
+
+    for (unsigned j = 0; j < n_features; j++) {
+        char buf[VMAF_FEATURE_LOG_NAME_SIZE] = { 0 };
+        strncpy(buf, name[j], sizeof(buf) - 1);
+        if (fwrite(buf, sizeof(buf), 1, outfile) != 1)
+            return -EIO;
+    }
+    for (uint64_t i = header_size; i < data_offset; i++) {
+        if (fputc(0, outfile) == EOF)
+            return -EIO;
+    }
+
+    for (unsigned i = 0; i < n_frames; i++) {
+        if (write_u64(outfile, frame_num[i]))
+            return -EIO;
+    }
+
+    for (unsigned j = 0; j < n_features; j++) {
+        for (unsigned i = 0; i < n_frames; i++) {
+            double score;
+            if (get_score(ctx, j, i, &score))
+                score = NAN;
+            if (write_f64(outfile, score))
+                return -EIO;
+        }
+    }
+
+    return ferror(outfile) ? -EIO : 0;
+}
@@ -0,0 +1,65 @@
+/**
+ *
+ *  Copyright 2016-2019 Netflix, Inc.
+ *
+ *     Licensed under the Apache License, Version 2.0 (the "License");
+ *     you may not use this file except in compliance with the License.
+ *     You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ *
+ */
+
+#ifndef __VMAF_SRC_FEATURE_LOG_H__
+#define __VMAF_SRC_FEATURE_LOG_H__
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Columnar binary feature log, all integers and floats are little-endian:
+ *
+ *   offset  0: char     magic[8]      "VMAFCOL\0"
+ *   offset  8: uint32   version       VMAF_FEATURE_LOG_VERSION
+ *   offset 12: uint32   n_features
+ *   offset 16: uint64   n_frames
+ *   offset 24: uint64   data_offset   multiple of VMAF_FEATURE_LOG_ALIGN
+ *   offset 32: char     name[n_features][VMAF_FEATURE_LOG_NAME_SIZE]
+ *   data_offset:
+ *              uint64   frame_num[n_frames]
+ *              float64  score[n_features][n_frames]
+ *
+ * Every feature is one contiguous column, so a single feature can be
+ * mapped without touching the others. Missing scores are stored as NaN.
+ */
+
+#define VMAF_FEATURE_LOG_MAGIC "VMAFCOL"
+#define VMAF_FEATURE_LOG_VERSION 1
+#define VMAF_FEATURE_LOG_NAME_SIZE 64
+#define VMAF_FEATURE_LOG_ALIGN 64
+
+/*
+ * Returns 0 and sets *score if feature j has a score for frame i.
+ */
+typedef int (*VmafFeatureLogScore)(void *ctx, unsigned j, unsigned i,
+                                   double *score);
+
+int vmaf_feature_log_write(FILE *outfile, const char *const *name,
+                           unsigned n_features, const unsigned *frame_num,
+                           unsigned n_frames, VmafFeatureLogScore get_score,
+                           void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VMAF_SRC_FEATURE_LOG_H__ */
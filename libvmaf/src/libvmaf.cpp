@@ -17,6 +17,7 @@
  */
 
 #include "vmaf.h"
+#include <algorithm>
 #include <cstdio>
 #include "cpu.h"
 
@@ -114,8 +115,15 @@ double StatVector::percentile(double perc)
     else if (perc > 100.0) {
         perc = 100.0;
     }
-    std::vector<double> l(this->l);
-    std::sort(l.begin(), l.end());
+    // keep a sorted copy, merging in only what was appended since last call
+    const size_t n_sorted = sorted.size();
+    if (n_sorted != this->l.size()) {
+        sorted.insert(sorted.end(), this->l.begin() + n_sorted, this->l.end());
+        std::sort(sorted.begin() + n_sorted, sorted.end());
+        std::inplace_merge(sorted.begin(), sorted.begin() + n_sorted,
+                           sorted.end());
+    }
+    const std::vector<double> &l = sorted;
     double pos = perc * (this->l.size() - 1) / 100.0;
     int pos_left = (int)floor(pos);
     int pos_right = (int)ceil(pos);
@@ -1,4 +1,6 @@
 #include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,22 +9,96 @@
 
 #include "feature/common/cpu.h"
 #include "feature/feature_extractor.h"
+#include "feature/feature_cache.h"
 #include "feature/feature_collector.h"
+#include "feature/ref_cache.h"
 #include "model.h"
 #include "output.h"
+#include "partial.h"
 #include "picture.h"
 #include "predict.h"
+#include "score_cache.h"
+#include "subsample.h"
+#include "thread_pool.h"
 
 typedef struct {
     VmafFeatureExtractorContext **fex_ctx;
     unsigned cnt, capacity;
 } RegisteredFeatureExtractors;
 
-typedef struct VmafContext {
+typedef struct {
+    bool written;
+    VmafBootstrapScore value;
+} BootstrapScore;
+
+typedef struct {
+    struct {
+        VmafModel *model;
+        VmafScoreCache *score_cache;
+        BootstrapScore *bootstrap;
+        unsigned bootstrap_capacity;
+    } *entry;
+    unsigned cnt, capacity;
+    // the first model scored writes "vmaf" to the feature collector, the
+    // first one scored with bootstrap "vmaf_bagging", "vmaf_stddev", ...
+    VmafModel *vmaf_model, *bootstrap_model;
+} ModelScoreCaches;
+
+typedef struct {
+    VmafModel *model;
+    VmafScoreCallback callback;
+    void *user_data;
+    unsigned index; // next index to be delivered
+} ScoreCallback;
+
+typedef struct {
+    ScoreCallback *entry;
+    unsigned cnt, capacity;
+} ScoreCallbacks;
+
+typedef struct {
+    VmafOutputWriter *writer;
+    VmafModel *model;
+    unsigned index; // next index to be written
+} OutputStream;
+
+typedef struct {
+    struct VmafContext **ctx;
+    unsigned cnt, capacity;
+} DistortedStreams;
+
+typedef struct {
+    struct {
+        uint64_t hash[6]; // ref and dist, per plane
+        unsigned index;
+        bool used;
+    } *entry;
+    unsigned cnt, capacity; // capacity is a power of 2
+} DuplicatePictures;
+
+typedef struct {
+    VmafRefCache *cache;
+    char *path; // rewritten when flushed
+    bool written;
+} ReferenceCache;
+
+struct VmafContext {
     VmafConfiguration cfg;
     VmafFeatureCollector *feature_collector;
     RegisteredFeatureExtractors registered_feature_extractors;
-} VmafContext;
+    ModelScoreCaches model_score_caches;
+    ScoreCallbacks score_callbacks;
+    OutputStream output_stream;
+    unsigned pic_cnt; // 1 + highest picture index read so far
+    bool flushed;
+    struct VmafContext *parent; // set for distorted streams
+    DistortedStreams streams;
+    ReferenceCache ref_cache;
+    DuplicatePictures duplicates;
+    VmafFeatureCache *feature_cache;
+    VmafSubsample *subsample; // adaptive, created with the first picture
+    VmafThreadPool *thread_pool; // with n_threads > 1, distorted streams use the parent's
+};
 
 static int feature_extractor_vector_init(RegisteredFeatureExtractors *rfe)
 {
@@ -72,6 +148,355 @@ static void feature_extractor_vector_destroy(RegisteredFeatureExtractors *rfe)
     return;
 }
 
+static int model_score_cache_entry(ModelScoreCaches *msc, VmafModel *model)
+{
+    for (unsigned i = 0; i < msc->cnt; i++) {
+        if (msc->entry[i].model == model)
+            return i;
+    }
+
+    if (msc->cnt >= msc->capacity) {
+        size_t capacity = msc->capacity ? msc->capacity * 2 : 4;
+        void *entry = realloc(msc->entry, sizeof(*(msc->entry)) * capacity);
+        if (!entry) return -ENOMEM;
+        msc->entry = entry;
+        msc->capacity = capacity;
+    }
+
+    VmafScoreCache *score_cache;
+    int err = vmaf_score_cache_init(&score_cache);
+    if (err) return err;
+    memset(&(msc->entry[msc->cnt]), 0, sizeof(*(msc->entry)));
+    msc->entry[msc->cnt].model = model;
+    msc->entry[msc->cnt].score_cache = score_cache;
+    return msc->cnt++;
+}
+
+static VmafScoreCache *model_score_cache(ModelScoreCaches *msc,
+                                         VmafModel *model)
+{
+    const int i = model_score_cache_entry(msc, model);
+    return i < 0 ? NULL : msc->entry[i].score_cache;
+}
+
+static BootstrapScore *model_bootstrap_score(ModelScoreCaches *msc,
+                                             VmafModel *model, unsigned index)
+{
+    const int i = model_score_cache_entry(msc, model);
+    if (i < 0) return NULL;
+
+    BootstrapScore **bootstrap = &(msc->entry[i].bootstrap);
+    unsigned *capacity = &(msc->entry[i].bootstrap_capacity);
+    if (index >= *capacity) {
+        unsigned c = *capacity ? *capacity : 256;
+        while (index >= c) c *= 2;
+        BootstrapScore *b = realloc(*bootstrap, sizeof(*b) * c);
+        if (!b) return NULL;
+        memset(b + *capacity, 0, sizeof(*b) * (c - *capacity));
+        *bootstrap = b;
+        *capacity = c;
+    }
+    return &((*bootstrap)[index]);
+}
+
+static void model_score_caches_destroy(ModelScoreCaches *msc)
+{
+    if (!msc) return;
+    for (unsigned i = 0; i < msc->cnt; i++) {
+        vmaf_score_cache_destroy(msc->entry[i].score_cache);
+        free(msc->entry[i].bootstrap);
+    }
+    free(msc->entry);
+}
+
+static int score_callbacks_append(ScoreCallbacks *sc, VmafModel *model,
+                                  VmafScoreCallback callback, void *user_data)
+{
+    if (sc->cnt >= sc->capacity) {
+        size_t capacity = sc->capacity ? sc->capacity * 2 : 4;
+        void *entry = realloc(sc->entry, sizeof(*(sc->entry)) * capacity);
+        if (!entry) return -ENOMEM;
+        sc->entry = entry;
+        sc->capacity = capacity;
+    }
+
+    sc->entry[sc->cnt].model = model;
+    sc->entry[sc->cnt].callback = callback;
+    sc->entry[sc->cnt].user_data = user_data;
+    sc->entry[sc->cnt].index = 0;
+    sc->cnt++;
+    return 0;
+}
+
+static void score_callbacks_destroy(ScoreCallbacks *sc)
+{
+    if (!sc) return;
+    free(sc->entry);
+}
+
+static bool model_features_available(VmafContext *vmaf, VmafModel *model,
+                                     unsigned index)
+{
+    for (unsigned i = 0; i < model->n_features; i++) {
+        double value;
+        int err = vmaf_feature_collector_get_score(vmaf->feature_collector,
+                                                   model->feature[i].name,
+                                                   &value, index);
+        if (err) return false;
+    }
+    return true;
+}
+
+static int deliver_frame_score(VmafContext *vmaf, ScoreCallback *cb)
+{
+    int err = 0;
+
+    VmafModel *model = cb->model;
+    const unsigned index = cb->index;
+    VmafFrameScore frame_score = {
+        .index = index,
+        .n_features = model->n_features,
+    };
+    err = vmaf_score_at_index(vmaf, model, &frame_score.score, index);
+    if (err) return err;
+
+    VmafFeatureScore feature[model->n_features];
+    for (unsigned i = 0; i < model->n_features; i++) {
+        feature[i].name = model->feature[i].name;
+        err = vmaf_feature_collector_get_score(vmaf->feature_collector,
+                                               model->feature[i].name,
+                                               &feature[i].value, index);
+        if (err) return err;
+    }
+    frame_score.feature = feature;
+
+    cb->callback(cb->user_data, &frame_score);
+    return 0;
+}
+
+static int dispatch_score_callbacks(VmafContext *vmaf)
+{
+    int err = 0;
+
+    for (unsigned i = 0; i < vmaf->score_callbacks.cnt; i++) {
+        ScoreCallback *const cb = &(vmaf->score_callbacks.entry[i]);
+
+        for (; cb->index < vmaf->pic_cnt; cb->index++) {
+            if ((vmaf->cfg.n_subsample > 1) &&
+                (cb->index % vmaf->cfg.n_subsample))
+            {
+                continue;
+            }
+            // deliver in order: wait for delayed (temporal) features,
+            // unless flushed, when no more features will arrive
+            if (!model_features_available(vmaf, cb->model, cb->index)) {
+                if (vmaf->flushed) continue;
+                break;
+            }
+            err = deliver_frame_score(vmaf, cb);
+            if (err) return err;
+        }
+    }
+
+    return 0;
+}
+
+static bool extracted_features_available(VmafContext *vmaf, unsigned index)
+{
+    // distorted streams use the feature extractors of their parent
+    VmafContext *const root = vmaf->parent ? vmaf->parent : vmaf;
+    RegisteredFeatureExtractors rfe = root->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++) {
+        const char **name = rfe.fex_ctx[i]->fex->provided_features;
+        for (; name && *name; name++) {
+            double value;
+            int err = vmaf_feature_collector_get_score(vmaf->feature_collector,
+                                                       (char *) *name, &value,
+                                                       index);
+            if (err) return false;
+        }
+    }
+    return true;
+}
+
+static int dispatch_output_stream(VmafContext *vmaf)
+{
+    OutputStream *const os = &(vmaf->output_stream);
+    if (!os->writer) return 0;
+
+    int err = 0;
+
+    for (; os->index < vmaf->pic_cnt; os->index++) {
+        if ((vmaf->cfg.n_subsample > 1) &&
+            (os->index % vmaf->cfg.n_subsample))
+        {
+            continue;
+        }
+        const bool model_available = os->model &&
+            model_features_available(vmaf, os->model, os->index);
+        const bool complete =
+            extracted_features_available(vmaf, os->index) &&
+            (!os->model || model_available);
+        if (!complete && !vmaf->flushed) break;
+
+        if (model_available) {
+            double score;
+            err = vmaf_score_at_index(vmaf, os->model, &score, os->index);
+            if (err) return err;
+        }
+        err = vmaf_output_writer_frame(os->writer, vmaf->feature_collector,
+                                       os->index);
+        if (err) return err;
+    }
+
+    if (vmaf->flushed) {
+        err = vmaf_output_writer_close(os->writer);
+        os->writer = NULL;
+    }
+
+    return err;
+}
+
+static int dispatch(VmafContext *vmaf)
+{
+    int err = dispatch_score_callbacks(vmaf);
+    if (err) return err;
+    return dispatch_output_stream(vmaf);
+}
+
+static int write_ref_cache(ReferenceCache *rc)
+{
+    if (!rc->cache || rc->written) return 0;
+    rc->written = true;
+
+    // written aside and renamed, an interrupted write keeps the old cache
+    const size_t sz = strlen(rc->path) + sizeof(".tmp");
+    char *tmp_path = malloc(sz);
+    if (!tmp_path) return -ENOMEM;
+    snprintf(tmp_path, sz, "%s.tmp", rc->path);
+
+    int err = 0;
+    FILE *outfile = fopen(tmp_path, "wb");
+    if (!outfile) {
+        err = -EIO;
+        goto free_tmp_path;
+    }
+    err = vmaf_ref_cache_write(rc->cache, outfile);
+    if (fclose(outfile)) err = -EIO;
+    if (!err && rename(tmp_path, rc->path)) err = -EIO;
+    if (err) remove(tmp_path);
+
+free_tmp_path:
+    free(tmp_path);
+    return err;
+}
+
+static int subsample_picture(VmafContext *vmaf, VmafPicture *ref,
+                             VmafPicture **dist, unsigned n_dist,
+                             unsigned index, bool *skipped,
+                             unsigned *last_extracted, bool *cut)
+{
+    if (!vmaf->subsample) {
+        int err = vmaf_subsample_init(&(vmaf->subsample),
+                                      vmaf->cfg.adaptive_subsample, n_dist);
+        if (err) return err;
+    }
+
+    // motion2 lags one picture behind
+    double motion = -1.;
+    if (index) {
+        vmaf_feature_collector_get_score(vmaf->feature_collector,
+                                         "'VMAF_feature_motion2_score'",
+                                         &motion, index - 1);
+    }
+
+    *last_extracted = vmaf->subsample->last;
+    bool extract;
+    int err = vmaf_subsample_picture(vmaf->subsample, ref, dist, n_dist,
+                                     motion, index, &extract, cut);
+    if (err) return err;
+    *skipped = !extract;
+    return 0;
+}
+
+/*
+ * Pictures in (low, high) skipped by adaptive subsampling get the spatial
+ * feature scores of the extracted pictures around them, linearly
+ * interpolated. Across a scene cut, and after the last extracted picture,
+ * the scores of low are held instead.
+ */
+static int fill_skipped_scores(VmafContext *vmaf, VmafFeatureCollector **fc,
+                               unsigned n_dist, unsigned low, unsigned high,
+                               bool hold)
+{
+    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++) {
+        VmafFeatureExtractor *const fex = rfe.fex_ctx[i]->fex;
+        if (fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL) continue;
+
+        for (const char **name = fex->provided_features; name && *name;
+             name++)
+        {
+            for (unsigned j = 0; j < n_dist; j++) {
+                double a, b;
+                int err = vmaf_feature_collector_get_score(fc[j],
+                                                           (char *) *name,
+                                                           &a, low);
+                if (err) return err;
+                b = a;
+                if (!hold) {
+                    err = vmaf_feature_collector_get_score(fc[j],
+                                                           (char *) *name,
+                                                           &b, high);
+                    if (err) return err;
+                }
+                for (unsigned k = low + 1; k < high; k++) {
+                    const double t = (double) (k - low) / (high - low);
+                    err = vmaf_feature_collector_append(fc[j], (char *) *name,
+                                                        a + t * (b - a), k);
+                    if (err) return err;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int flush_context(VmafContext *vmaf)
+{
+    if (vmaf->parent) return flush_context(vmaf->parent);
+
+    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++)
+        vmaf_feature_extractor_context_close(rfe.fex_ctx[i]);
+    vmaf->flushed = true;
+    int err = write_ref_cache(&(vmaf->ref_cache));
+    if (err) return err;
+    if (vmaf->subsample) {
+        // hold the scores of the last extracted picture up to the end
+        VmafSubsample *const s = vmaf->subsample;
+        VmafFeatureCollector *fc[s->n_dist];
+        fc[0] = vmaf->feature_collector;
+        for (unsigned i = 1; i < s->n_dist; i++)
+            fc[i] = vmaf->streams.ctx[i - 1]->feature_collector;
+        err = fill_skipped_scores(vmaf, fc, s->n_dist, s->last, s->index + 1,
+                                  true);
+        if (err) return err;
+        s->last = s->index;
+    }
+    if (vmaf->feature_cache) {
+        err = vmaf_feature_cache_write(vmaf->feature_cache);
+        if (err) return err;
+    }
+    for (unsigned i = 0; i < vmaf->streams.cnt; i++)
+        vmaf->streams.ctx[i]->flushed = true;
+
+    err = dispatch(vmaf);
+    for (unsigned i = 0; i < vmaf->streams.cnt; i++)
+        err |= dispatch(vmaf->streams.ctx[i]);
+    return err;
+}
+
 enum vmaf_cpu cpu;
 // ^ FIXME, this is a global in the old libvmaf
 // A few wrapped floating point feature extractors rely on it being a global
@@ -84,6 +509,11 @@ int vmaf_init(VmafContext **vmaf, VmafConfiguration cfg)
 
     cpu = cpu_autodetect(); //FIXME, see above
 
+    if (cfg.preview > 1 && cfg.preview != 2 && cfg.preview != 4)
+        return -EINVAL;
+    if (cfg.adaptive_subsample > 1 && cfg.n_subsample > 1)
+        return -EINVAL;
+
     VmafContext *const v = *vmaf = malloc(sizeof(*v));
     if (!v) goto fail;
     memset(v, 0, sizeof(*v));
@@ -95,13 +525,14 @@ int vmaf_init(VmafContext **vmaf, VmafConfiguration cfg)
     if (err) goto free_feature_collector;
 
     if (v->cfg.n_threads > 1) {
-        fprintf(stderr, "set `--threads 1` for now.\n"
-                        "multithreaded feature extraction is on the way.\n");
-        return -EINVAL;
+        err = vmaf_thread_pool_create(&(v->thread_pool), v->cfg.n_threads);
+        if (err) goto free_feature_extractor_vector;
     }
 
     return 0;
 
+free_feature_extractor_vector:
+    feature_extractor_vector_destroy(&(v->registered_feature_extractors));
 free_feature_collector:
     vmaf_feature_collector_destroy(v->feature_collector);
 free_v:
@@ -110,14 +541,33 @@ fail:
     return -ENOMEM;
 }
 
-int vmaf_close(VmafContext *vmaf)
+static void context_destroy(VmafContext *vmaf)
 {
-    if (!vmaf) return -EINVAL;
-
+    if (vmaf->output_stream.writer)
+        vmaf_output_writer_close(vmaf->output_stream.writer);
+    // closing the feature extractors may still append to the streams
     feature_extractor_vector_destroy(&(vmaf->registered_feature_extractors));
+    for (unsigned i = 0; i < vmaf->streams.cnt; i++)
+        context_destroy(vmaf->streams.ctx[i]);
+    free(vmaf->streams.ctx);
+    vmaf_ref_cache_destroy(vmaf->ref_cache.cache);
+    free(vmaf->ref_cache.path);
+    free(vmaf->duplicates.entry);
+    vmaf_feature_cache_destroy(vmaf->feature_cache);
+    vmaf_subsample_destroy(vmaf->subsample);
+    if (vmaf->thread_pool) vmaf_thread_pool_destroy(vmaf->thread_pool);
+    model_score_caches_destroy(&(vmaf->model_score_caches));
+    score_callbacks_destroy(&(vmaf->score_callbacks));
     vmaf_feature_collector_destroy(vmaf->feature_collector);
     free(vmaf);
+}
 
+int vmaf_close(VmafContext *vmaf)
+{
+    if (!vmaf) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+
+    context_destroy(vmaf);
     return 0;
 }
 
@@ -127,14 +577,20 @@ int vmaf_import_feature_score(VmafContext *vmaf, char *feature_name,
     if (!vmaf) return -EINVAL;
     if (!feature_name) return -EINVAL;
 
-    return vmaf_feature_collector_append(vmaf->feature_collector, feature_name,
-                                         value, index);
+    int err = vmaf_feature_collector_append(vmaf->feature_collector,
+                                            feature_name, value, index);
+    if (err) return err;
+
+    if (index >= vmaf->pic_cnt)
+        vmaf->pic_cnt = index + 1;
+    return dispatch(vmaf);
 }
 
 int vmaf_use_feature(VmafContext *vmaf, const char *feature_name)
 {
     if (!vmaf) return -EINVAL;
     if (!feature_name) return -EINVAL;
+    if (vmaf->parent) return vmaf_use_feature(vmaf->parent, feature_name);
 
     int err = 0;
 
@@ -158,6 +614,8 @@ int vmaf_use_features_from_model(VmafContext *vmaf, VmafModel *model)
 {
     if (!vmaf) return -EINVAL;
     if (!model) return -EINVAL;
+    if (vmaf->parent)
+        return vmaf_use_features_from_model(vmaf->parent, model);
 
     int err = 0;
 
@@ -181,47 +639,495 @@ int vmaf_use_features_from_model(VmafContext *vmaf, VmafModel *model)
     return 0;
 }
 
-int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
-                       unsigned index)
+int vmaf_register_score_callback(VmafContext *vmaf, VmafModel *model,
+                                 VmafScoreCallback callback, void *user_data)
 {
     if (!vmaf) return -EINVAL;
-    if (!ref) return -EINVAL;
-    if (!dist) return -EINVAL;
+    if (!model) return -EINVAL;
+    if (!callback) return -EINVAL;
+
+    return score_callbacks_append(&(vmaf->score_callbacks), model, callback,
+                                  user_data);
+}
+
+int vmaf_register_distorted_stream(VmafContext *vmaf, VmafContext **stream)
+{
+    if (!vmaf) return -EINVAL;
+    if (!stream) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+    if (vmaf->pic_cnt) return -EINVAL;
+
+    DistortedStreams *const ds = &(vmaf->streams);
+    if (ds->cnt >= ds->capacity) {
+        size_t capacity = ds->capacity ? ds->capacity * 2 : 4;
+        void *ctx = realloc(ds->ctx, sizeof(*(ds->ctx)) * capacity);
+        if (!ctx) return -ENOMEM;
+        ds->ctx = ctx;
+        ds->capacity = capacity;
+    }
+
+    // the feature extractors, and so the thread pool, are the parent's
+    VmafConfiguration cfg = vmaf->cfg;
+    cfg.n_threads = 1;
+
+    VmafContext *s;
+    int err = vmaf_init(&s, cfg);
+    if (err) return err;
+    s->parent = vmaf;
+    ds->ctx[ds->cnt++] = s;
+
+    *stream = s;
+    return 0;
+}
 
+int vmaf_use_reference_cache(VmafContext *vmaf, const char *path)
+{
+    if (!vmaf) return -EINVAL;
+    if (!path) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+    if (vmaf->pic_cnt) return -EINVAL;
+    if (vmaf->ref_cache.cache) return -EINVAL;
+
+    ReferenceCache *const rc = &(vmaf->ref_cache);
+    rc->path = malloc(strlen(path) + 1);
+    if (!rc->path) return -ENOMEM;
+    strcpy(rc->path, path);
+
+    // a missing cache file is created when flushing
+    FILE *infile = fopen(path, "rb");
+    int err = vmaf_ref_cache_init(&(rc->cache), infile);
+    if (infile) fclose(infile);
+    if (err) {
+        free(rc->path);
+        memset(rc, 0, sizeof(*rc));
+    }
+    return err;
+}
+
+int vmaf_use_feature_cache(VmafContext *vmaf, const char *dir)
+{
+    if (!vmaf) return -EINVAL;
+    if (!dir) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+    if (vmaf->pic_cnt) return -EINVAL;
+    if (vmaf->feature_cache) return -EINVAL;
+    // preview scores are estimates, they must not be served as full ones
+    if (vmaf->cfg.preview > 1) return -EINVAL;
+
+    return vmaf_feature_cache_init(&(vmaf->feature_cache), dir);
+}
+
+static int duplicates_grow(DuplicatePictures *dp)
+{
+    const unsigned capacity = dp->capacity ? dp->capacity * 2 : 256;
+    void *entry = malloc(sizeof(*(dp->entry)) * capacity);
+    if (!entry) return -ENOMEM;
+    memset(entry, 0, sizeof(*(dp->entry)) * capacity);
+
+    DuplicatePictures grown = { .entry = entry, .capacity = capacity };
+    for (unsigned i = 0; i < dp->capacity; i++) {
+        if (!dp->entry[i].used) continue;
+        unsigned j = dp->entry[i].hash[0] & (capacity - 1);
+        while (grown.entry[j].used)
+            j = (j + 1) & (capacity - 1);
+        grown.entry[j] = dp->entry[i];
+        grown.cnt++;
+    }
+    free(dp->entry);
+    *dp = grown;
+    return 0;
+}
+
+/*
+ * Returns 1 and the index of the first occurrence if the (ref, dist) pair
+ * was seen before, otherwise remembers it at index and returns 0.
+ */
+static int duplicates_find(DuplicatePictures *dp, const uint64_t hash[6],
+                           unsigned index, unsigned *first_index)
+{
+    if (2 * (dp->cnt + 1) > dp->capacity) {
+        int err = duplicates_grow(dp);
+        if (err) return err;
+    }
+
+    const size_t hash_sz = sizeof(dp->entry[0].hash);
+    unsigned i = hash[0] & (dp->capacity - 1);
+    for (; dp->entry[i].used; i = (i + 1) & (dp->capacity - 1)) {
+        if (!memcmp(dp->entry[i].hash, hash, hash_sz)) {
+            *first_index = dp->entry[i].index;
+            return 1;
+        }
+    }
+
+    memcpy(dp->entry[i].hash, hash, hash_sz);
+    dp->entry[i].index = index;
+    dp->entry[i].used = true;
+    dp->cnt++;
+    return 0;
+}
+
+static int copy_duplicate_scores(VmafFeatureExtractorContext *fex_ctx,
+                                 VmafFeatureCollector **fc, unsigned n_dist,
+                                 const unsigned *first_index, unsigned index)
+{
+    const char **name = fex_ctx->fex->provided_features;
+    if (!name || !*name) return -EINVAL;
+
+    // all scores have to be available before any of them is appended
+    for (unsigned i = 0; i < n_dist; i++) {
+        for (const char **n = name; *n; n++) {
+            double score;
+            int err = vmaf_feature_collector_get_score(fc[i], (char *) *n,
+                                                       &score, first_index[i]);
+            if (err) return err;
+        }
+    }
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        for (const char **n = name; *n; n++) {
+            double score;
+            int err = vmaf_feature_collector_get_score(fc[i], (char *) *n,
+                                                       &score, first_index[i]);
+            err |= vmaf_feature_collector_append(fc[i], (char *) *n, score,
+                                                 index);
+            if (err) return err;
+        }
+    }
+    return 0;
+}
+
+static bool extracts_spatial_features(VmafContext *vmaf)
+{
+    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++) {
+        if (!(rfe.fex_ctx[i]->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL))
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Identical (ref, dist) pairs, e.g. freeze frames or repeated animation
+ * frames, get the spatial feature scores of their first occurrence copied
+ * instead of recomputed. Returns 1 if all distorted pictures are such
+ * duplicates, with the index of their first occurrence in first_index.
+ */
+static int find_duplicates(VmafContext *vmaf, uint64_t (*hash)[6],
+                           unsigned n_dist, unsigned index,
+                           unsigned *first_index)
+{
+    bool duplicate = true;
+    for (unsigned i = 0; i < n_dist; i++) {
+        VmafContext *const ctx = i ? vmaf->streams.ctx[i - 1] : vmaf;
+        int err = duplicates_find(&(ctx->duplicates), hash[i], index,
+                                  &first_index[i]);
+        if (err < 0) return err;
+        duplicate &= err;
+    }
+    return duplicate;
+}
+
+static int hash_pictures(VmafPicture *ref, VmafPicture **dist,
+                         unsigned n_dist, uint64_t (*hash)[6])
+{
+    int err = vmaf_picture_hash(ref, &hash[0][0]);
+    if (err) return err;
+    for (unsigned i = 0; i < n_dist; i++) {
+        if (i) memcpy(&hash[i][0], &hash[0][0], sizeof(hash[0][0]) * 3);
+        err = vmaf_picture_hash(dist[i], &hash[i][3]);
+        if (err) return err;
+    }
+    return 0;
+}
+
+/*
+ * Scores of versioned, non-temporal feature extractors are looked up in the
+ * feature cache of previous runs by content hash, all distorted pictures
+ * have to hit for the extractor to be skipped.
+ */
+static int use_cached_scores(VmafFeatureCache *cache,
+                             VmafFeatureExtractorContext *fex_ctx,
+                             VmafFeatureCollector **fc, uint64_t (*hash)[6],
+                             unsigned n_dist, unsigned index)
+{
+    VmafFeatureExtractor *const fex = fex_ctx->fex;
+    const unsigned cnt = vmaf_feature_cache_score_cnt(fex);
+    if (!cnt) return -EINVAL;
+
+    double score[n_dist][cnt];
+    for (unsigned i = 0; i < n_dist; i++) {
+        int err = vmaf_feature_cache_get(cache, fex, hash[i], score[i]);
+        if (err) return err;
+    }
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        for (unsigned j = 0; j < cnt; j++) {
+            int err = vmaf_feature_collector_append(fc[i],
+                                           (char *) fex->provided_features[j],
+                                           score[i][j], index);
+            if (err) return err;
+        }
+    }
+    return 0;
+}
+
+static int store_cached_scores(VmafFeatureCache *cache,
+                               VmafFeatureExtractorContext *fex_ctx,
+                               VmafFeatureCollector **fc, uint64_t (*hash)[6],
+                               unsigned n_dist, unsigned index)
+{
+    VmafFeatureExtractor *const fex = fex_ctx->fex;
+    const unsigned cnt = vmaf_feature_cache_score_cnt(fex);
+    if (!cnt) return 0;
+
+    for (unsigned i = 0; i < n_dist; i++) {
+        double score[cnt];
+        int err = 0;
+        for (unsigned j = 0; j < cnt; j++) {
+            err |= vmaf_feature_collector_get_score(fc[i],
+                                           (char *) fex->provided_features[j],
+                                           &score[j], index);
+        }
+        if (err) continue;
+        err = vmaf_feature_cache_put(cache, fex, hash[i], score);
+        if (err) return err;
+    }
+    return 0;
+}
+
+static int read_pictures(VmafContext *vmaf, VmafPicture *ref,
+                         VmafPicture **dist, unsigned n_dist, unsigned index)
+{
     int err = 0;
 
-    //TODO: VmafThreadPool
+    VmafFeatureCollector *fc[n_dist];
+    fc[0] = vmaf->feature_collector;
+    for (unsigned i = 1; i < n_dist; i++)
+        fc[i] = vmaf->streams.ctx[i - 1]->feature_collector;
+
+    if (index >= vmaf->pic_cnt)
+        vmaf->pic_cnt = index + 1;
+    for (unsigned i = 0; i < vmaf->streams.cnt; i++) {
+        if (index >= vmaf->streams.ctx[i]->pic_cnt)
+            vmaf->streams.ctx[i]->pic_cnt = index + 1;
+    }
+
+    if (vmaf->ref_cache.cache) {
+        err = vmaf_ref_cache_frame(vmaf->ref_cache.cache, ref, index);
+        if (err) return err;
+    }
+
+    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
+    for (unsigned i = 0; i < rfe.cnt; i++) {
+        rfe.fex_ctx[i]->fex->ref_cache = vmaf->ref_cache.cache;
+        rfe.fex_ctx[i]->fex->preview_scale = vmaf->cfg.preview == 4 ? 2 :
+                                             vmaf->cfg.preview == 2 ? 1 : 0;
+        rfe.fex_ctx[i]->fex->thread_pool = vmaf->thread_pool;
+    }
+
+    bool skipped =
+        (vmaf->cfg.n_subsample > 1) && (index % vmaf->cfg.n_subsample);
+    const bool adaptive = vmaf->cfg.adaptive_subsample > 1;
+    unsigned last_extracted = 0;
+    bool cut = false;
+    if (adaptive) {
+        // the decision uses the motion up to this picture,
+        // so the temporal features are extracted first
+        for (unsigned i = 0; i < rfe.cnt; i++) {
+            VmafFeatureExtractorContext *fex_ctx = rfe.fex_ctx[i];
+            if (!(fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL))
+                continue;
+            err = vmaf_feature_extractor_context_extract_multi(fex_ctx, ref,
+                                                               dist, n_dist,
+                                                               index, fc);
+            if (err) return err;
+        }
+        err = subsample_picture(vmaf, ref, dist, n_dist, index, &skipped,
+                                &last_extracted, &cut);
+        if (err) return err;
+    }
+
+    // content hashes of the (ref, dist) pairs, for spatial features only
+    uint64_t hash[n_dist][6];
+    unsigned first_index[n_dist];
+    int duplicate = 0;
+    const bool spatial = !skipped && extracts_spatial_features(vmaf);
+    if (spatial) {
+        err = hash_pictures(ref, dist, n_dist, hash);
+        if (err) return err;
+        duplicate = find_duplicates(vmaf, hash, n_dist, index, first_index);
+        if (duplicate < 0) return duplicate;
+    }
+    VmafFeatureCache *const feature_cache =
+        spatial ? vmaf->feature_cache : NULL;
+
+    // feature extractors run in turn, the thread pool splits their pictures
     for (unsigned i = 0; i < vmaf->registered_feature_extractors.cnt; i++) {
         VmafFeatureExtractorContext *fex_ctx =
             vmaf->registered_feature_extractors.fex_ctx[i];
+        const bool temporal =
+            fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL;
+        if (temporal ? adaptive : skipped) continue;
 
-        if ((vmaf->cfg.n_subsample > 1) && (index % vmaf->cfg.n_subsample) &&
-            !(fex_ctx->fex->flags & VMAF_FEATURE_EXTRACTOR_TEMPORAL))
+        if (duplicate && !temporal &&
+            !copy_duplicate_scores(fex_ctx, fc, n_dist, first_index, index))
+        {
+            continue;
+        }
+        if (feature_cache &&
+            !use_cached_scores(feature_cache, fex_ctx, fc, hash, n_dist,
+                               index))
         {
             continue;
         }
 
-        err = vmaf_feature_extractor_context_extract(fex_ctx, ref, dist, index,
-                                                     vmaf->feature_collector);
+        err = vmaf_feature_extractor_context_extract_multi(fex_ctx, ref, dist,
+                                                           n_dist, index, fc);
+        if (err) return err;
+
+        if (feature_cache) {
+            err = store_cached_scores(feature_cache, fex_ctx, fc, hash, n_dist,
+                                      index);
+            if (err) return err;
+        }
+    }
+
+    if (adaptive && !skipped) {
+        err = fill_skipped_scores(vmaf, fc, n_dist, last_extracted, index,
+                                  cut);
         if (err) return err;
     }
 
     err = vmaf_picture_unref(ref);
     if (err) return err;
-    err = vmaf_picture_unref(dist);
-    if (err) return err;
+    for (unsigned i = 0; i < n_dist; i++) {
+        err = vmaf_picture_unref(dist[i]);
+        if (err) return err;
+    }
 
+    err = dispatch(vmaf);
+    if (err) return err;
+    for (unsigned i = 0; i < vmaf->streams.cnt; i++) {
+        err = dispatch(vmaf->streams.ctx[i]);
+        if (err) return err;
+    }
     return 0;
 }
 
+int vmaf_read_pictures(VmafContext *vmaf, VmafPicture *ref, VmafPicture *dist,
+                       unsigned index)
+{
+    if (!vmaf) return -EINVAL;
+    if (!ref && !dist) return flush_context(vmaf);
+    if (!ref) return -EINVAL;
+    if (!dist) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+    if (vmaf->streams.cnt) return -EINVAL;
+
+    return read_pictures(vmaf, ref, &dist, 1, index);
+}
+
+int vmaf_read_pictures_multi(VmafContext *vmaf, VmafPicture *ref,
+                             VmafPicture **dist, unsigned n_dist,
+                             unsigned index)
+{
+    if (!vmaf) return -EINVAL;
+    if (!ref) return -EINVAL;
+    if (!dist) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+    if (vmaf->parent) return -EINVAL;
+    if (n_dist != vmaf->streams.cnt + 1) return -EINVAL;
+    for (unsigned i = 0; i < n_dist; i++)
+        if (!dist[i]) return -EINVAL;
+
+    return read_pictures(vmaf, ref, dist, n_dist, index);
+}
+
+int vmaf_register_output(VmafContext *vmaf, FILE *outfile,
+                         enum VmafOutputFormat fmt, VmafModel *model)
+{
+    if (!vmaf) return -EINVAL;
+    if (!outfile) return -EINVAL;
+    if (vmaf->output_stream.writer) return -EINVAL;
+    if (vmaf->flushed) return -EINVAL;
+
+    int err = vmaf_output_writer_init(&(vmaf->output_stream.writer), outfile,
+                                      fmt, vmaf->cfg.n_subsample);
+    if (err) return err;
+    vmaf->output_stream.model = model;
+    vmaf->output_stream.index = 0;
+    // the streamed "vmaf" scores are this model's
+    ModelScoreCaches *const msc = &(vmaf->model_score_caches);
+    if (model && !msc->vmaf_model) msc->vmaf_model = model;
+
+    return dispatch_output_stream(vmaf);
+}
+
 int vmaf_score_at_index(VmafContext *vmaf, VmafModel *model, double *score,
                         unsigned index)
 {
     if (!vmaf) return -EINVAL;
+    if (!model) return -EINVAL;
     if (!score) return -EINVAL;
 
-    return vmaf_predict_score_at_index(model, vmaf->feature_collector, index,
-                                       score);
+    VmafScoreCache *score_cache =
+        model_score_cache(&(vmaf->model_score_caches), model);
+    if (!score_cache) return -ENOMEM;
+
+    int err = vmaf_score_cache_get_score(score_cache, score, index);
+    if (!err) return 0;
+
+    err = vmaf_predict_score_at_index(model, vmaf->feature_collector, index,
+                                      score);
+    if (err) return err;
+    err = vmaf_score_cache_append(score_cache, *score, index);
+    if (err) return err;
+
+    ModelScoreCaches *const msc = &(vmaf->model_score_caches);
+    if (!msc->vmaf_model) msc->vmaf_model = model;
+    if (msc->vmaf_model != model) return 0;
+    return vmaf_feature_collector_append(vmaf->feature_collector, "vmaf",
+                                         *score, index);
+}
+
+int vmaf_score_at_index_bootstrap(VmafContext *vmaf, VmafModel *model,
+                                  VmafBootstrapScore *score, unsigned index)
+{
+    if (!vmaf) return -EINVAL;
+    if (!model) return -EINVAL;
+    if (!score) return -EINVAL;
+
+    ModelScoreCaches *const msc = &(vmaf->model_score_caches);
+    BootstrapScore *const b = model_bootstrap_score(msc, model, index);
+    if (!b) return -ENOMEM;
+    if (b->written) {
+        *score = b->value;
+        return 0;
+    }
+
+    int err = vmaf_predict_score_at_index_bootstrap(model,
+                                                    vmaf->feature_collector,
+                                                    index, score);
+    if (err) return err;
+    b->written = true;
+    b->value = *score;
+
+    if (!msc->bootstrap_model) msc->bootstrap_model = model;
+    if (msc->bootstrap_model != model) return 0;
+    VmafFeatureCollector *const fc = vmaf->feature_collector;
+    err  = vmaf_feature_collector_append(fc, "vmaf_bagging",
+                                         score->bagging_score, index);
+    err |= vmaf_feature_collector_append(fc, "vmaf_stddev",
+                                         score->stddev, index);
+    err |= vmaf_feature_collector_append(fc, "vmaf_ci95_low",
+                                         score->ci95.lo, index);
+    err |= vmaf_feature_collector_append(fc, "vmaf_ci95_high",
+                                         score->ci95.hi, index);
+    return err;
 }
 
 int vmaf_score_pooled(VmafContext *vmaf, VmafModel *model,
@@ -229,24 +1135,66 @@ int vmaf_score_pooled(VmafContext *vmaf, VmafModel *model,
                       unsigned index_low, unsigned index_high)
 {
     if (!vmaf) return -EINVAL;
+    if (!model) return -EINVAL;
     if (!score) return -EINVAL;
     if (index_low >= index_high) return -EINVAL;
 
-    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
-    for (unsigned i = 0; i < rfe.cnt; i++)
-        vmaf_feature_extractor_context_close(rfe.fex_ctx[i]);
+    int err = flush_context(vmaf);
+    if (err) return err;
+
+    VmafScoreCache *score_cache =
+        model_score_cache(&(vmaf->model_score_caches), model);
+    if (!score_cache) return -ENOMEM;
 
-    double sum = 0.;
-    for (unsigned i = index_low; i < index_high; i++) {
+    // only frames not yet known to be scored need a look,
+    // every frame is predicted at most once per model
+    unsigned i = index_low > score_cache->complete ?
+                 index_low : score_cache->complete;
+    for (; i < index_high; i++) {
         if ((vmaf->cfg.n_subsample > 1) && (i % vmaf->cfg.n_subsample))
             continue;
         double vmaf_score;
-        int err = vmaf_score_at_index(vmaf, model, &vmaf_score, i);
+        err = vmaf_score_at_index(vmaf, model, &vmaf_score, i);
         if (err) return err;
-        sum += vmaf_score;
     }
-    *score = sum / (index_high - index_low);
-    return 0;
+    if (index_low <= score_cache->complete &&
+        index_high > score_cache->complete)
+    {
+        score_cache->complete = index_high;
+    }
+
+    return vmaf_score_cache_pool(score_cache, pool_method, score,
+                                 index_low, index_high);
+}
+
+int vmaf_write_partial(VmafContext *vmaf, FILE *partial, unsigned index_low,
+                       unsigned index_high, unsigned index_offset)
+{
+    if (!vmaf) return -EINVAL;
+    if (!partial) return -EINVAL;
+
+    int err = flush_context(vmaf);
+    if (err) return err;
+
+    return vmaf_partial_write(vmaf->feature_collector, partial, index_low,
+                              index_high, index_offset);
+}
+
+int vmaf_read_partial(VmafContext *vmaf, FILE *partial, unsigned *index_low,
+                      unsigned *index_high)
+{
+    if (!vmaf) return -EINVAL;
+    if (!partial) return -EINVAL;
+
+    unsigned low, high;
+    int err = vmaf_partial_read(vmaf->feature_collector, partial, &low, &high);
+    if (err) return err;
+
+    if (index_low) *index_low = low;
+    if (index_high) *index_high = high;
+    if (high > vmaf->pic_cnt)
+        vmaf->pic_cnt = high;
+    return dispatch(vmaf);
 }
 
 const char *vmaf_version(void)
@@ -257,15 +1205,10 @@ const char *vmaf_version(void)
 int vmaf_write_output(VmafContext *vmaf, FILE *outfile,
                       enum VmafOutputFormat fmt)
 {
-    RegisteredFeatureExtractors rfe = vmaf->registered_feature_extractors;
-    for (unsigned i = 0; i < rfe.cnt; i++)
-        vmaf_feature_extractor_context_close(rfe.fex_ctx[i]);
+    int err = flush_context(vmaf);
+    if (err) return err;
 
-    switch (fmt) {
-    case VMAF_OUTPUT_FORMAT_XML:
-        return vmaf_write_output_xml(vmaf->feature_collector, outfile,
-                                     vmaf->cfg.n_subsample);
-    default:
-        return 0;
-    }
+    if (fmt == VMAF_OUTPUT_FORMAT_NONE) return 0;
+    return vmaf_write_output_fc(vmaf->feature_collector, outfile, fmt,
+                                vmaf->cfg.n_subsample);
 }
@@ -1,4 +1,5 @@
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -6,6 +7,48 @@
 #include "svm.h"
 #include "unpickle.h"
 
+static int load_bootstrap_models(VmafModel *m)
+{
+    // bootstrap model i > 0 lives next to the base model as $path.%04d.model
+    const unsigned cnt = m->bootstrap.n_models - 1;
+    m->bootstrap.svm = malloc(sizeof(*(m->bootstrap.svm)) * cnt);
+    if (!m->bootstrap.svm) goto fail;
+    memset(m->bootstrap.svm, 0, sizeof(*(m->bootstrap.svm)) * cnt);
+
+    const char *svm_path_suffix = ".0000.model";
+    size_t svm_path_sz = strlen(m->path) + strlen(svm_path_suffix) + 1;
+    char *svm_path = malloc(svm_path_sz);
+    if (!svm_path) goto free_svm;
+
+    for (unsigned i = 0; i < cnt; i++) {
+        snprintf(svm_path, svm_path_sz, "%s.%04d.model", m->path, i + 1);
+        m->bootstrap.svm[i] = svm_load_model(svm_path);
+        if (!m->bootstrap.svm[i]) goto free_svm_path;
+    }
+    free(svm_path);
+
+    {
+        struct svm_model *svm[m->bootstrap.n_models];
+        svm[0] = m->svm;
+        for (unsigned i = 0; i < cnt; i++)
+            svm[i + 1] = m->bootstrap.svm[i];
+        m->bootstrap.batch = svm_model_batch_create(svm, m->bootstrap.n_models);
+        if (!m->bootstrap.batch) goto free_svm;
+    }
+
+    return 0;
+
+free_svm_path:
+    free(svm_path);
+free_svm:
+    for (unsigned i = 0; i < cnt; i++)
+        svm_free_and_destroy_model(&(m->bootstrap.svm[i]));
+    free(m->bootstrap.svm);
+    m->bootstrap.svm = NULL;
+fail:
+    return -ENOMEM;
+}
+
 int vmaf_model_load_from_path(VmafModel **model, const char *path)
 {
     VmafModel *const m = *model = malloc(sizeof(*m));
@@ -31,8 +74,19 @@ int vmaf_model_load_from_path(VmafModel **model, const char *path)
     int err = vmaf_unpickle_model(m, m->path);
     if (err) goto free_svm;
 
+    if (m->type == VMAF_MODEL_BOOTSTRAP_SVM_NUSVR ||
+        m->type == VMAF_MODEL_RESIDUE_BOOTSTRAP_SVM_NUSVR)
+    {
+        err = load_bootstrap_models(m);
+        if (err) goto free_feature;
+    }
+
     return 0;
 
+free_feature:
+    for (unsigned i = 0; i < m->n_features; i++)
+        free(m->feature[i].name);
+    free(m->feature);
 free_svm:
     svm_free_and_destroy_model(&(m->svm));
 free_path:
@@ -48,6 +102,12 @@ void vmaf_model_destroy(VmafModel *model)
     if (!model) return;
     free(model->path);
     svm_free_and_destroy_model(&(model->svm));
+    if (model->bootstrap.svm) {
+        svm_model_batch_destroy(&(model->bootstrap.batch));
+        for (unsigned i = 0; i < model->bootstrap.n_models - 1; i++)
+            svm_free_and_destroy_model(&(model->bootstrap.svm[i]));
+        free(model->bootstrap.svm);
+    }
     for (unsigned i = 0; i < model->n_features; i++)
         free(model->feature[i].name);
     free(model->feature);
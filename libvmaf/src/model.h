@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include <libvmaf/model.h>
+
 enum VmafModelType {
     VMAF_MODEL_TYPE_UNKNOWN = 0,
     VMAF_MODEL_TYPE_SVM_NUSVR,
@@ -21,7 +23,7 @@ typedef struct {
     double slope, intercept;
 } VmafModelFeature;
 
-typedef struct VmafModel {
+struct VmafModel {
     char *path;
     enum VmafModelType type;
     double slope, intercept;
@@ -41,6 +43,11 @@ typedef struct VmafModel {
         bool out_lte_in, out_gte_in;
     } score_transform;
     struct svm_model *svm;
-} VmafModel;
+    struct {
+        unsigned n_models;
+        struct svm_model **svm;
+        struct svm_model_batch *batch;
+    } bootstrap;
+};
 
 #endif /* __VMAF_SRC_MODEL_H__ */
@@ -1,11 +1,169 @@
 #include <errno.h>
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "feature/alias.h"
 #include "feature/feature_collector.h"
+#include "feature_log.h"
+#include "output.h"
 
 #include <libvmaf/libvmaf.rc.h>
 
+struct VmafOutputWriter {
+    FILE *outfile;
+    enum VmafOutputFormat fmt;
+    unsigned subsample;
+    unsigned frame_cnt;
+    unsigned column_cnt; // csv: features known when the header was written
+};
+
+int vmaf_output_writer_init(VmafOutputWriter **writer, FILE *outfile,
+                            enum VmafOutputFormat fmt, unsigned subsample)
+{
+    if (!writer) return -EINVAL;
+    if (!outfile) return -EINVAL;
+
+    switch (fmt) {
+    case VMAF_OUTPUT_FORMAT_XML:
+    case VMAF_OUTPUT_FORMAT_JSON:
+    case VMAF_OUTPUT_FORMAT_CSV:
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    VmafOutputWriter *const w = *writer = malloc(sizeof(*w));
+    if (!w) return -ENOMEM;
+    memset(w, 0, sizeof(*w));
+    w->outfile = outfile;
+    w->fmt = fmt;
+    w->subsample = subsample;
+
+    switch (fmt) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        fprintf(outfile, "<VMAF version=\"%s\">\n", vmaf_version());
+        fprintf(outfile, "  <frames>\n");
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        fprintf(outfile, "{\n");
+        fprintf(outfile, "  \"version\": \"%s\",\n", vmaf_version());
+        fprintf(outfile, "  \"frames\": [");
+        break;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static void write_json_value(FILE *outfile, double value)
+{
+    if (isfinite(value))
+        fprintf(outfile, "%.6f", value);
+    else
+        fprintf(outfile, "null");
+}
+
+int vmaf_output_writer_frame(VmafOutputWriter *w, VmafFeatureCollector *fc,
+                             unsigned index)
+{
+    if (!w) return -EINVAL;
+    if (!fc) return -EINVAL;
+
+    if ((w->subsample > 1) && (index % w->subsample))
+        return 0;
+
+    unsigned cnt = 0;
+    for (unsigned j = 0; j < fc->cnt; j++) {
+        FeatureVector *fv = fc->feature_vector[j];
+        if (index < fv->capacity && fv->score[index].written)
+            cnt++;
+    }
+    if (!cnt) return 0;
+
+    FILE *const outfile = w->outfile;
+
+    switch (w->fmt) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        fprintf(outfile, "    <frame frameNum=\"%d\" ", index);
+        for (unsigned j = 0; j < fc->cnt; j++) {
+            FeatureVector *fv = fc->feature_vector[j];
+            if (index >= fv->capacity || !fv->score[index].written)
+                continue;
+            fprintf(outfile, "%s=\"%.6f\" ",
+                    vmaf_feature_name_alias(fv->name),
+                    fv->score[index].value);
+        }
+        fprintf(outfile, "/>\n");
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        fprintf(outfile, "%s\n    {\n", w->frame_cnt ? "," : "");
+        fprintf(outfile, "      \"frameNum\": %d,\n", index);
+        fprintf(outfile, "      \"metrics\": {");
+        for (unsigned j = 0, k = 0; j < fc->cnt; j++) {
+            FeatureVector *fv = fc->feature_vector[j];
+            if (index >= fv->capacity || !fv->score[index].written)
+                continue;
+            fprintf(outfile, "%s\n        \"%s\": ", k++ ? "," : "",
+                    vmaf_feature_name_alias(fv->name));
+            write_json_value(outfile, fv->score[index].value);
+        }
+        fprintf(outfile, "\n      }\n    }");
+        break;
+    case VMAF_OUTPUT_FORMAT_CSV:
+        // columns are fixed by the first frame, later features are dropped
+        if (!w->frame_cnt) {
+            w->column_cnt = fc->cnt;
+            fprintf(outfile, "Frame,");
+            for (unsigned j = 0; j < w->column_cnt; j++) {
+                fprintf(outfile, "%s,",
+                        vmaf_feature_name_alias(fc->feature_vector[j]->name));
+            }
+            fprintf(outfile, "\n");
+        }
+        fprintf(outfile, "%d,", index);
+        for (unsigned j = 0; j < w->column_cnt; j++) {
+            FeatureVector *fv = fc->feature_vector[j];
+            if (index < fv->capacity && fv->score[index].written)
+                fprintf(outfile, "%.6f", fv->score[index].value);
+            fprintf(outfile, ",");
+        }
+        fprintf(outfile, "\n");
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    w->frame_cnt++;
+    return ferror(outfile) ? -EIO : 0;
+}
+
+int vmaf_output_writer_close(VmafOutputWriter *w)
+{
+    if (!w) return -EINVAL;
+
+    FILE *const outfile = w->outfile;
+
+    switch (w->fmt) {
+    case VMAF_OUTPUT_FORMAT_XML:
+        fprintf(outfile, "  </frames>\n");
+        fprintf(outfile, "</VMAF>\n");
+        break;
+    case VMAF_OUTPUT_FORMAT_JSON:
+        fprintf(outfile, "%s]\n", w->frame_cnt ? "\n  " : "");
+        fprintf(outfile, "}\n");
+        break;
+    default:
+        break;
+    }
+
+    const int err = ferror(outfile) ? -EIO : 0;
+    free(w);
+    return err;
+}
+
 static unsigned max_capacity(VmafFeatureCollector *fc)
 {
     unsigned capacity = 0;
@@ -18,44 +176,75 @@ static unsigned max_capacity(VmafFeatureCollector *fc)
     return capacity;
 }
 
-int vmaf_write_output_xml(VmafFeatureCollector *fc, FILE *outfile,
-                          unsigned subsample)
+typedef struct {
+    VmafFeatureCollector *fc;
+    const unsigned *frame_num;
+} BinaryOutput;
+
+static int binary_score(void *ctx, unsigned j, unsigned i, double *score)
 {
-    if (!fc) return -EINVAL;
-    if (!outfile) return -EINVAL;
+    BinaryOutput *out = ctx;
+    FeatureVector *fv = out->fc->feature_vector[j];
+    const unsigned index = out->frame_num[i];
+    if (index >= fv->capacity || !fv->score[index].written)
+        return -EINVAL;
+    *score = fv->score[index].value;
+    return 0;
+}
 
-    fprintf(outfile, "<VMAF version=\"%s\">\n", vmaf_version());
-    fprintf(outfile, "  <frames>\n");
+static int write_output_binary(VmafFeatureCollector *fc, FILE *outfile,
+                               unsigned subsample)
+{
+    const unsigned capacity = max_capacity(fc);
+    unsigned *frame_num = malloc(sizeof(*frame_num) * (capacity + 1));
+    const char **name = malloc(sizeof(*name) * (fc->cnt + 1));
+    int err = -ENOMEM;
+    if (!frame_num || !name) goto free_buffers;
 
-    for (unsigned i = 0 ; i < max_capacity(fc); i++) {
+    unsigned n_frames = 0;
+    for (unsigned i = 0; i < capacity; i++) {
         if ((subsample > 1) && (i % subsample))
             continue;
-
-        unsigned cnt = 0;
-        for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (fc->feature_vector[j]->score[i].written)
-                cnt++;
-        }
-        if (!cnt) continue;
-
-        fprintf(outfile, "    <frame frameNum=\"%d\" ", i);
         for (unsigned j = 0; j < fc->cnt; j++) {
-            if (i > fc->feature_vector[j]->capacity)
-                continue;
-            if (!fc->feature_vector[j]->score[i].written)
-                continue;
-            fprintf(outfile, "%s=\"%.6f\" ",
-                vmaf_feature_name_alias(fc->feature_vector[j]->name),
-                fc->feature_vector[j]->score[i].value
-            );
+            FeatureVector *fv = fc->feature_vector[j];
+            if (i < fv->capacity && fv->score[i].written) {
+                frame_num[n_frames++] = i;
+                break;
+            }
         }
-        fprintf(outfile, "/>\n");
     }
+    for (unsigned j = 0; j < fc->cnt; j++)
+        name[j] = vmaf_feature_name_alias(fc->feature_vector[j]->name);
 
-    fprintf(outfile, "  </frames>\n");
-    fprintf(outfile, "</VMAF>\n");
+    BinaryOutput out = { .fc = fc, .frame_num = frame_num };
+    err = vmaf_feature_log_write(outfile, name, fc->cnt, frame_num, n_frames,
+                                 binary_score, &out);
 
-    return 0;
+free_buffers:
+    free(name);
+    free(frame_num);
+    return err;
+}
+
+int vmaf_write_output_fc(VmafFeatureCollector *fc, FILE *outfile,
+                         enum VmafOutputFormat fmt, unsigned subsample)
+{
+    if (!fc) return -EINVAL;
+    if (!outfile) return -EINVAL;
+
+    if (fmt == VMAF_OUTPUT_FORMAT_BINARY)
+        return write_output_binary(fc, outfile, subsample);
+
+    VmafOutputWriter *w;
+    int err = vmaf_output_writer_init(&w, outfile, fmt, subsample);
+    if (err) return err;
+
+    const unsigned capacity = max_capacity(fc);
+    for (unsigned i = 0; i < capacity; i++) {
+        err = vmaf_output_writer_frame(w, fc, i);
+        if (err) break;
+    }
+
+    const int err_close = vmaf_output_writer_close(w);
+    return err ? err : err_close;
 }
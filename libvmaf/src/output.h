@@ -1 +1,27 @@
-int vmaf_write_log_xml(VmafFeatureCollector *fc, FILE *logfile);
+#ifndef __VMAF_SRC_OUTPUT_H__
+#define __VMAF_SRC_OUTPUT_H__
+
+#include <stdio.h>
+
+#include "feature/feature_collector.h"
+
+#include <libvmaf/libvmaf.rc.h>
+
+/*
+ * Incremental output writer: frames are written one at a time, in order,
+ * as soon as they are complete. Only the format state is kept in memory.
+ */
+typedef struct VmafOutputWriter VmafOutputWriter;
+
+int vmaf_output_writer_init(VmafOutputWriter **writer, FILE *outfile,
+                            enum VmafOutputFormat fmt, unsigned subsample);
+
+int vmaf_output_writer_frame(VmafOutputWriter *writer,
+                             VmafFeatureCollector *fc, unsigned index);
+
+int vmaf_output_writer_close(VmafOutputWriter *writer);
+
+int vmaf_write_output_fc(VmafFeatureCollector *fc, FILE *outfile,
+                         enum VmafOutputFormat fmt, unsigned subsample);
+
+#endif /* __VMAF_SRC_OUTPUT_H__ */
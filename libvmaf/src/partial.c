@@ -0,0 +1,105 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "feature/feature_collector.h"
+#include "partial.h"
+
+#define PARTIAL_MAGIC "VMAF_PARTIAL"
+#define PARTIAL_VERSION 1
+#define PARTIAL_NAME_LEN 255
+
+/*
+ * Model outputs are predicted again from the merged features, a partial
+ * holding them would make the merged context append them twice.
+ */
+static const char *model_output[] = {
+    "vmaf", "vmaf_bagging", "vmaf_stddev", "vmaf_ci95_low", "vmaf_ci95_high",
+    NULL
+};
+
+static bool is_model_output(const char *name)
+{
+    for (const char **n = model_output; *n; n++) {
+        if (!strcmp(name, *n)) return true;
+    }
+    return false;
+}
+
+static unsigned written_cnt(FeatureVector *fv, unsigned index_low,
+                            unsigned index_high)
+{
+    unsigned cnt = 0;
+    for (unsigned i = index_low; i < index_high && i < fv->capacity; i++)
+        cnt += fv->score[i].written;
+    return cnt;
+}
+
+int vmaf_partial_write(VmafFeatureCollector *fc, FILE *outfile,
+                       unsigned index_low, unsigned index_high,
+                       unsigned index_offset)
+{
+    if (!fc) return -EINVAL;
+    if (!outfile) return -EINVAL;
+    if (index_low >= index_high) return -EINVAL;
+
+    fprintf(outfile, "%s %d %u %u\n", PARTIAL_MAGIC, PARTIAL_VERSION,
+            index_low + index_offset, index_high + index_offset);
+
+    for (unsigned j = 0; j < fc->cnt; j++) {
+        FeatureVector *fv = fc->feature_vector[j];
+        if (strlen(fv->name) > PARTIAL_NAME_LEN) return -EINVAL;
+        if (strpbrk(fv->name, " \t\n")) return -EINVAL;
+        if (is_model_output(fv->name)) continue;
+
+        const unsigned cnt = written_cnt(fv, index_low, index_high);
+        if (!cnt) continue;
+
+        fprintf(outfile, "feature %s %u\n", fv->name, cnt);
+        for (unsigned i = index_low; i < index_high && i < fv->capacity; i++) {
+            if (!fv->score[i].written) continue;
+            // 17 significant digits round-trip any double exactly
+            fprintf(outfile, "%u %.17g\n", i + index_offset,
+                    fv->score[i].value);
+        }
+    }
+
+    return ferror(outfile) ? -EIO : 0;
+}
+
+int vmaf_partial_read(VmafFeatureCollector *fc, FILE *infile,
+                      unsigned *index_low, unsigned *index_high)
+{
+    if (!fc) return -EINVAL;
+    if (!infile) return -EINVAL;
+
+    char magic[sizeof(PARTIAL_MAGIC)];
+    int version;
+    unsigned low, high;
+    if (fscanf(infile, "%12s %d %u %u", magic, &version, &low, &high) != 4)
+        return -EINVAL;
+    if (strcmp(magic, PARTIAL_MAGIC)) return -EINVAL;
+    if (version != PARTIAL_VERSION) return -EINVAL;
+    if (low >= high) return -EINVAL;
+
+    char name[PARTIAL_NAME_LEN + 1];
+    unsigned cnt;
+    int ret;
+    while ((ret = fscanf(infile, " feature %255s %u", name, &cnt)) == 2) {
+        for (unsigned i = 0; i < cnt; i++) {
+            unsigned index;
+            double score;
+            if (fscanf(infile, "%u %lf", &index, &score) != 2)
+                return -EINVAL;
+            if (index < low || index >= high) return -EINVAL;
+            int err = vmaf_feature_collector_append(fc, name, score, index);
+            if (err) return err;
+        }
+    }
+    if (ret != EOF) return -EINVAL;
+
+    if (index_low) *index_low = low;
+    if (index_high) *index_high = high;
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef __VMAF_SRC_PARTIAL_H__
+#define __VMAF_SRC_PARTIAL_H__
+
+#include <stdio.h>
+
+#include "feature/feature_collector.h"
+
+/*
+ * Partial results: the feature scores of a picture index interval,
+ * e.g. one temporal shard of a video. Plain text, one feature per section,
+ * values are written with enough digits to be read back bit-exact. Model
+ * outputs ("vmaf", the bootstrap "vmaf_*" scores) are not written, they are
+ * predicted from the merged features.
+ *
+ *   VMAF_PARTIAL 1 <index_low> <index_high>
+ *   feature <name> <cnt>
+ *   <index> <value>
+ *   ...
+ */
+
+int vmaf_partial_write(VmafFeatureCollector *fc, FILE *outfile,
+                       unsigned index_low, unsigned index_high,
+                       unsigned index_offset);
+
+int vmaf_partial_read(VmafFeatureCollector *fc, FILE *infile,
+                      unsigned *index_low, unsigned *index_high);
+
+#endif /* __VMAF_SRC_PARTIAL_H__ */
@@ -60,6 +60,67 @@ int vmaf_picture_ref(VmafPicture *dst, VmafPicture *src) {
     return 0;
 }
 
+#define HASH_PRIME_1 0x9e3779b97f4a7c15ULL
+#define HASH_PRIME_2 0xc2b2ae3d27d4eb4fULL
+
+static inline uint64_t hash_round(uint64_t h, uint64_t word)
+{
+    h = (h ^ word) * HASH_PRIME_1;
+    return (h << 31 | h >> 33) * HASH_PRIME_2;
+}
+
+// 4 independent lanes, so that rows are hashed at memory speed
+static void hash_row(uint64_t lane[4], const uint8_t *data, size_t sz)
+{
+    uint64_t word[4];
+    for (; sz >= sizeof(word); sz -= sizeof(word), data += sizeof(word)) {
+        memcpy(word, data, sizeof(word));
+        for (unsigned k = 0; k < 4; k++)
+            lane[k] = hash_round(lane[k], word[k]);
+    }
+    for (unsigned k = 0; sz; k++) {
+        const size_t n = sz < sizeof(word[0]) ? sz : sizeof(word[0]);
+        word[0] = 0;
+        memcpy(&word[0], data, n);
+        lane[k] = hash_round(lane[k], word[0]);
+        data += n;
+        sz -= n;
+    }
+}
+
+static uint64_t hash_finish(const uint64_t lane[4])
+{
+    uint64_t h = lane[0];
+    for (unsigned k = 1; k < 4; k++)
+        h = hash_round(h, lane[k]);
+    return h ^ (h >> 29);
+}
+
+uint64_t vmaf_hash_bytes(uint64_t seed, const void *data, size_t sz)
+{
+    uint64_t lane[4] = { seed, sz, ~seed, 0 };
+    hash_row(lane, data, sz);
+    return hash_finish(lane);
+}
+
+int vmaf_picture_hash(VmafPicture *pic, uint64_t hash[3])
+{
+    if (!pic) return -EINVAL;
+    if (!hash) return -EINVAL;
+
+    const size_t bytes_per_value = pic->bpc > 8 ? 2 : 1;
+    for (unsigned p = 0; p < 3; p++) {
+        uint64_t lane[4] = { p, pic->w[p], pic->h[p], pic->bpc };
+        const uint8_t *data = pic->data[p];
+        for (unsigned i = 0; i < pic->h[p]; i++) {
+            hash_row(lane, data, pic->w[p] * bytes_per_value);
+            data += pic->stride[p];
+        }
+        hash[p] = hash_finish(lane);
+    }
+    return 0;
+}
+
 int vmaf_picture_unref(VmafPicture *pic) {
     if (!pic) return -EINVAL;
     if (!pic->ref_cnt) return -EINVAL;
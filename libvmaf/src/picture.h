@@ -1,8 +1,19 @@
 #ifndef __VMAF_SRC_PICTURE_H__
 #define __VMAF_SRC_PICTURE_H__
 
+#include <stdint.h>
+
 #include "libvmaf/picture.h"
 
 int vmaf_picture_ref(VmafPicture *dst, VmafPicture *src);
 
+/*
+ * 64-bit content hash of every plane, covering dimensions, bit depth and
+ * the visible samples (not the stride padding).
+ */
+int vmaf_picture_hash(VmafPicture *pic, uint64_t hash[3]);
+
+/* Same hash for arbitrary data, e.g. cache keys and checksums. */
+uint64_t vmaf_hash_bytes(uint64_t seed, const void *data, size_t sz);
+
 #endif /* __VMAF_SRC_PICTURE_H__ */
@@ -0,0 +1,227 @@
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libvmaf/libvmaf.rc.h>
+
+/*
+ * Relative-error quantile sketch (DDSketch). Values are counted in
+ * logarithmically spaced buckets, so any quantile estimate is within
+ * SKETCH_RELATIVE_ACCURACY of the true value. Two sketches are merged by
+ * adding bucket counts, which is exact: merging per-shard sketches gives the
+ * same result as sketching the concatenated scores.
+ */
+
+#define SKETCH_RELATIVE_ACCURACY 0.001
+#define SKETCH_MIN_INDEXABLE 1e-6
+
+typedef struct {
+    uint64_t *count;
+    int offset;
+    unsigned len;
+} SketchStore;
+
+struct VmafPoolAccumulator {
+    unsigned long long n;
+    double sum, sum_hm;
+    double min, max;
+    struct {
+        double gamma, log_gamma;
+        SketchStore positive, negative;
+        uint64_t zero;
+    } sketch;
+};
+
+static int store_grow(SketchStore *store, int key_low, int key_high)
+{
+    if (store->len &&
+        key_low >= store->offset &&
+        key_high < store->offset + (int) store->len)
+    {
+        return 0;
+    }
+
+    if (store->len) {
+        if (store->offset < key_low) key_low = store->offset;
+        if (store->offset + (int) store->len - 1 > key_high)
+            key_high = store->offset + store->len - 1;
+    }
+
+    const unsigned len = key_high - key_low + 1;
+    uint64_t *count = malloc(sizeof(*count) * len);
+    if (!count) return -ENOMEM;
+    memset(count, 0, sizeof(*count) * len);
+    if (store->len) {
+        memcpy(count + (store->offset - key_low), store->count,
+               sizeof(*count) * store->len);
+    }
+
+    free(store->count);
+    store->count = count;
+    store->offset = key_low;
+    store->len = len;
+    return 0;
+}
+
+static int store_add(SketchStore *store, int key, uint64_t cnt)
+{
+    int err = store_grow(store, key, key);
+    if (err) return err;
+    store->count[key - store->offset] += cnt;
+    return 0;
+}
+
+static int sketch_key(VmafPoolAccumulator *acc, double value)
+{
+    return (int) ceil(log(value) / acc->sketch.log_gamma);
+}
+
+static double sketch_value(VmafPoolAccumulator *acc, int key)
+{
+    return 2. * pow(acc->sketch.gamma, key) / (1. + acc->sketch.gamma);
+}
+
+int vmaf_pool_accumulator_init(VmafPoolAccumulator **acc)
+{
+    if (!acc) return -EINVAL;
+
+    VmafPoolAccumulator *const a = *acc = malloc(sizeof(*a));
+    if (!a) return -ENOMEM;
+    memset(a, 0, sizeof(*a));
+    a->min = INFINITY;
+    a->max = -INFINITY;
+    a->sketch.gamma =
+        (1. + SKETCH_RELATIVE_ACCURACY) / (1. - SKETCH_RELATIVE_ACCURACY);
+    a->sketch.log_gamma = log(a->sketch.gamma);
+    return 0;
+}
+
+int vmaf_pool_accumulator_append(VmafPoolAccumulator *acc, double score)
+{
+    if (!acc) return -EINVAL;
+    if (!isfinite(score)) return -EINVAL;
+
+    int err = 0;
+    if (score > SKETCH_MIN_INDEXABLE)
+        err = store_add(&acc->sketch.positive, sketch_key(acc, score), 1);
+    else if (score < -SKETCH_MIN_INDEXABLE)
+        err = store_add(&acc->sketch.negative, sketch_key(acc, -score), 1);
+    else
+        acc->sketch.zero++;
+    if (err) return err;
+
+    acc->n++;
+    acc->sum += score;
+    acc->sum_hm += 1. / (score + 1.);
+    acc->min = score < acc->min ? score : acc->min;
+    acc->max = score > acc->max ? score : acc->max;
+    return 0;
+}
+
+static int store_merge(SketchStore *dst, const SketchStore *src)
+{
+    if (!src->len) return 0;
+
+    int err = store_grow(dst, src->offset, src->offset + src->len - 1);
+    if (err) return err;
+    for (unsigned i = 0; i < src->len; i++)
+        dst->count[src->offset - dst->offset + i] += src->count[i];
+    return 0;
+}
+
+int vmaf_pool_accumulator_merge(VmafPoolAccumulator *dst,
+                                const VmafPoolAccumulator *src)
+{
+    if (!dst) return -EINVAL;
+    if (!src) return -EINVAL;
+
+    int err = 0;
+    err = store_merge(&dst->sketch.positive, &src->sketch.positive);
+    if (err) return err;
+    err = store_merge(&dst->sketch.negative, &src->sketch.negative);
+    if (err) return err;
+    dst->sketch.zero += src->sketch.zero;
+
+    dst->n += src->n;
+    dst->sum += src->sum;
+    dst->sum_hm += src->sum_hm;
+    dst->min = src->min < dst->min ? src->min : dst->min;
+    dst->max = src->max > dst->max ? src->max : dst->max;
+    return 0;
+}
+
+int vmaf_pool_accumulator_get(VmafPoolAccumulator *acc,
+                              enum VmafPoolingMethod pool_method,
+                              double *score)
+{
+    if (!acc) return -EINVAL;
+    if (!score) return -EINVAL;
+    if (!acc->n) return -EINVAL;
+
+    switch (pool_method) {
+    case VMAF_POOL_METHOD_MIN:
+        *score = acc->min;
+        return 0;
+    case VMAF_POOL_METHOD_MEAN:
+        *score = acc->sum / acc->n;
+        return 0;
+    case VMAF_POOL_METHOD_HARMONIC_MEAN:
+        *score = acc->n / acc->sum_hm - 1.;
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+int vmaf_pool_accumulator_get_percentile(VmafPoolAccumulator *acc,
+                                         double percentile, double *score)
+{
+    if (!acc) return -EINVAL;
+    if (!score) return -EINVAL;
+    if (!acc->n) return -EINVAL;
+    if (percentile < 0. || percentile > 100.) return -EINVAL;
+
+    const double rank = percentile / 100. * (acc->n - 1);
+    uint64_t cnt = 0;
+    double value = acc->max;
+
+    const SketchStore *neg = &acc->sketch.negative;
+    for (unsigned i = neg->len; i-- > 0;) {
+        cnt += neg->count[i];
+        if (cnt > rank) {
+            value = -sketch_value(acc, neg->offset + i);
+            goto clamp;
+        }
+    }
+
+    cnt += acc->sketch.zero;
+    if (cnt > rank) {
+        value = 0.;
+        goto clamp;
+    }
+
+    const SketchStore *pos = &acc->sketch.positive;
+    for (unsigned i = 0; i < pos->len; i++) {
+        cnt += pos->count[i];
+        if (cnt > rank) {
+            value = sketch_value(acc, pos->offset + i);
+            goto clamp;
+        }
+    }
+
+clamp:
+    value = value < acc->min ? acc->min : value;
+    value = value > acc->max ? acc->max : value;
+    *score = value;
+    return 0;
+}
+
+void vmaf_pool_accumulator_destroy(VmafPoolAccumulator *acc)
+{
+    if (!acc) return;
+    free(acc->sketch.positive.count);
+    free(acc->sketch.negative.count);
+    free(acc);
+}
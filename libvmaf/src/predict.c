@@ -1,8 +1,10 @@
 #include <errno.h>
+#include <math.h>
 #include <stdlib.h>
 
 #include "feature/feature_collector.h"
 #include "model.h"
+#include "predict.h"
 #include "svm.h"
 
 static int normalize(VmafModel *model, double slope, double intercept,
@@ -73,35 +75,47 @@ static int clip(VmafModel *model, double *prediction)
     return 0;
 }
 
-int vmaf_predict_score_at_index(VmafModel *model,
-                                VmafFeatureCollector *feature_collector,
-                                unsigned index, double *vmaf_score)
+static int populate_nodes(VmafModel *model,
+                          VmafFeatureCollector *feature_collector,
+                          unsigned index, struct svm_node *node)
 {
-    if (!model) return -EINVAL;
-    if (!feature_collector) return -EINVAL;
-    if (!vmaf_score) return -EINVAL;
-
     int err = 0;
 
-    struct svm_node *node = malloc(sizeof(*node) * (model->n_features + 1));
-    if (!node) return -ENOMEM;
-
     for (unsigned i = 0; i < model->n_features; i++) {
         double feature_score;
 
         err = vmaf_feature_collector_get_score(feature_collector,
                                                model->feature[i].name,
                                                &feature_score, index);
-        if (err) goto free_node;
+        if (err) return err;
         err = normalize(model, model->feature[i].slope,
                         model->feature[i].intercept, &feature_score);
-        if (err) goto free_node;
+        if (err) return err;
 
         node[i].index = i + 1;
         node[i].value = feature_score;
     }
     node[model->n_features].index = -1;
 
+    return 0;
+}
+
+int vmaf_predict_score_at_index(VmafModel *model,
+                                VmafFeatureCollector *feature_collector,
+                                unsigned index, double *vmaf_score)
+{
+    if (!model) return -EINVAL;
+    if (!feature_collector) return -EINVAL;
+    if (!vmaf_score) return -EINVAL;
+
+    int err = 0;
+
+    struct svm_node *node = malloc(sizeof(*node) * (model->n_features + 1));
+    if (!node) return -ENOMEM;
+
+    err = populate_nodes(model, feature_collector, index, node);
+    if (err) goto free_node;
+
     double prediction = svm_predict(model->svm, node);
 
     err = denormalize(model, &prediction);
@@ -111,13 +125,110 @@ int vmaf_predict_score_at_index(VmafModel *model,
     err = clip(model, &prediction);
     if (err) goto free_node;
 
-    err = vmaf_feature_collector_append(feature_collector, "vmaf",
-                                        prediction, index);
-    if (err) goto free_node;
-
     *vmaf_score = prediction;
 
 free_node:
     free(node);
     return err;
 }
+
+static int compare_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double *sorted, unsigned cnt, double perc)
+{
+    const double pos = perc * (cnt - 1) / 100.;
+    const unsigned pos_left = (unsigned) floor(pos);
+    const unsigned pos_right = (unsigned) ceil(pos);
+    if (pos_left == pos_right)
+        return sorted[pos_left];
+    return sorted[pos_left] * (pos_right - pos) +
+           sorted[pos_right] * (pos - pos_left);
+}
+
+static int transform_clip(VmafModel *model, double *prediction)
+{
+    int err = transform(model, prediction);
+    if (err) return err;
+    return clip(model, prediction);
+}
+
+#define BOOTSTRAP_DELTA 0.01
+
+int vmaf_predict_score_at_index_bootstrap(VmafModel *model,
+                                          VmafFeatureCollector *feature_collector,
+                                          unsigned index,
+                                          VmafBootstrapScore *score)
+{
+    if (!model) return -EINVAL;
+    if (!feature_collector) return -EINVAL;
+    if (!score) return -EINVAL;
+    if (!model->bootstrap.batch) return -EINVAL;
+
+    int err = 0;
+
+    struct svm_node *node = malloc(sizeof(*node) * (model->n_features + 1));
+    if (!node) return -ENOMEM;
+    const unsigned n_models = model->bootstrap.n_models;
+    double *prediction = malloc(sizeof(*prediction) * n_models);
+    if (!prediction) {
+        err = -ENOMEM;
+        goto free_node;
+    }
+
+    err = populate_nodes(model, feature_collector, index, node);
+    if (err) goto free_prediction;
+
+    // prediction[0] is the base model, the rest are the bootstrap models
+    svm_predict_batch(model->bootstrap.batch, node, prediction);
+    for (unsigned i = 0; i < n_models; i++) {
+        err = denormalize(model, &prediction[i]);
+        if (err) goto free_prediction;
+    }
+
+    double *bootstrap = prediction + 1;
+    const unsigned cnt = n_models - 1;
+    double sum = 0., sum_sq = 0.;
+    for (unsigned i = 0; i < cnt; i++) {
+        sum += bootstrap[i];
+        sum_sq += bootstrap[i] * bootstrap[i];
+    }
+    const double mean = sum / cnt;
+    const double var = sum_sq / cnt - mean * mean;
+
+    qsort(bootstrap, cnt, sizeof(*bootstrap), compare_double);
+
+    VmafBootstrapScore s = {
+        .score = prediction[0],
+        .bagging_score = mean,
+        .stddev = sqrt(var > 0. ? var : 0.),
+        .ci95 = {
+            .lo = percentile(bootstrap, cnt, 2.5),
+            .hi = percentile(bootstrap, cnt, 97.5),
+        },
+    };
+
+    // stddev is scaled by the local slope of transform/clip at the mean
+    double plus_delta = mean + BOOTSTRAP_DELTA;
+    double minus_delta = mean - BOOTSTRAP_DELTA;
+    err  = transform_clip(model, &s.score);
+    err |= transform_clip(model, &s.bagging_score);
+    err |= transform_clip(model, &s.ci95.lo);
+    err |= transform_clip(model, &s.ci95.hi);
+    err |= transform_clip(model, &plus_delta);
+    err |= transform_clip(model, &minus_delta);
+    if (err) goto free_prediction;
+    s.stddev *= (plus_delta - minus_delta) / (2. * BOOTSTRAP_DELTA);
+
+    *score = s;
+
+free_prediction:
+    free(prediction);
+free_node:
+    free(node);
+    return err;
+}
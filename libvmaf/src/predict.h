@@ -1,6 +1,8 @@
 #ifndef __VMAF_PREDICT_H__
 #define __VMAF_PREDICT_H__
 
+#include <libvmaf/libvmaf.rc.h>
+
 #include "feature/feature_collector.h"
 #include "model.h"
 
@@ -8,4 +10,9 @@ int vmaf_predict_score_at_index(VmafModel *model,
                                 VmafFeatureCollector *feature_collector,
                                 unsigned index, double *vmaf_score);
 
+int vmaf_predict_score_at_index_bootstrap(VmafModel *model,
+                                          VmafFeatureCollector *feature_collector,
+                                          unsigned index,
+                                          VmafBootstrapScore *score);
+
 #endif /* __VMAF_PREDICT_H__ */
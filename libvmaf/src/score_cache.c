@@ -0,0 +1,221 @@
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "score_cache.h"
+
+static void fenwick_add(double *tree, unsigned capacity, unsigned index,
+                        double value)
+{
+    for (unsigned i = index + 1; i <= capacity; i += i & -i)
+        tree[i] += value;
+}
+
+static double fenwick_prefix(double *tree, unsigned index)
+{
+    double sum = 0.;
+    for (unsigned i = index; i > 0; i -= i & -i)
+        sum += tree[i];
+    return sum;
+}
+
+static double fenwick_range(double *tree, unsigned index_low,
+                            unsigned index_high)
+{
+    return fenwick_prefix(tree, index_high) - fenwick_prefix(tree, index_low);
+}
+
+static void min_tree_set(double *tree, unsigned capacity, unsigned index,
+                         double value)
+{
+    unsigned i = capacity + index;
+    tree[i] = value;
+    for (i >>= 1; i > 0; i >>= 1)
+        tree[i] = fmin(tree[2 * i], tree[2 * i + 1]);
+}
+
+static double min_tree_range(double *tree, unsigned capacity,
+                             unsigned index_low, unsigned index_high)
+{
+    double min = INFINITY;
+    unsigned l = capacity + index_low, r = capacity + index_high;
+    for (; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) min = fmin(min, tree[l++]);
+        if (r & 1) min = fmin(min, tree[--r]);
+    }
+    return min;
+}
+
+static int tree_alloc(VmafScoreCache *sc, unsigned capacity)
+{
+    const size_t fenwick_sz = sizeof(double) * (capacity + 1);
+    double *sum = malloc(fenwick_sz);
+    double *sum_hm = malloc(fenwick_sz);
+    double *cnt = malloc(fenwick_sz);
+    double *min = malloc(sizeof(double) * 2 * capacity);
+    if (!sum || !sum_hm || !cnt || !min) goto fail;
+
+    memset(sum, 0, fenwick_sz);
+    memset(sum_hm, 0, fenwick_sz);
+    memset(cnt, 0, fenwick_sz);
+    for (unsigned i = 0; i < 2 * capacity; i++)
+        min[i] = INFINITY;
+
+    // O(n) rebuild from the per-frame scores
+    for (unsigned i = 0; i < capacity; i++) {
+        if (i >= sc->capacity || !sc->score[i].written) continue;
+        const double value = sc->score[i].value;
+        sum[i + 1] = value;
+        sum_hm[i + 1] = 1. / (value + 1.);
+        cnt[i + 1] = 1.;
+        min[capacity + i] = value;
+    }
+    for (unsigned i = 1; i <= capacity; i++) {
+        const unsigned j = i + (i & -i);
+        if (j > capacity) continue;
+        sum[j] += sum[i];
+        sum_hm[j] += sum_hm[i];
+        cnt[j] += cnt[i];
+    }
+    for (unsigned i = capacity - 1; i > 0; i--)
+        min[i] = fmin(min[2 * i], min[2 * i + 1]);
+
+    free(sc->tree.sum);
+    free(sc->tree.sum_hm);
+    free(sc->tree.cnt);
+    free(sc->tree.min);
+    sc->tree.sum = sum;
+    sc->tree.sum_hm = sum_hm;
+    sc->tree.cnt = cnt;
+    sc->tree.min = min;
+    return 0;
+
+fail:
+    free(sum);
+    free(sum_hm);
+    free(cnt);
+    free(min);
+    return -ENOMEM;
+}
+
+int vmaf_score_cache_init(VmafScoreCache **const score_cache)
+{
+    if (!score_cache) return -EINVAL;
+
+    VmafScoreCache *const sc = *score_cache = malloc(sizeof(*sc));
+    if (!sc) goto fail;
+    memset(sc, 0, sizeof(*sc));
+    sc->capacity = 8;
+    sc->score = malloc(sizeof(sc->score[0]) * sc->capacity);
+    if (!sc->score) goto free_sc;
+    memset(sc->score, 0, sizeof(sc->score[0]) * sc->capacity);
+    int err = tree_alloc(sc, sc->capacity);
+    if (err) goto free_score;
+    return 0;
+
+free_score:
+    free(sc->score);
+free_sc:
+    free(sc);
+fail:
+    return -ENOMEM;
+}
+
+int vmaf_score_cache_append(VmafScoreCache *score_cache, double score,
+                            unsigned index)
+{
+    if (!score_cache) return -EINVAL;
+
+    VmafScoreCache *const sc = score_cache;
+
+    if (index >= sc->capacity) {
+        unsigned capacity = sc->capacity;
+        while (index >= capacity)
+            capacity *= 2;
+        void *s = realloc(sc->score, sizeof(sc->score[0]) * capacity);
+        if (!s) return -ENOMEM;
+        sc->score = s;
+        memset(sc->score + sc->capacity, 0,
+               sizeof(sc->score[0]) * (capacity - sc->capacity));
+        const unsigned old_capacity = sc->capacity;
+        sc->capacity = capacity;
+        int err = tree_alloc(sc, capacity);
+        if (err) {
+            sc->capacity = old_capacity;
+            return err;
+        }
+    }
+
+    if (sc->score[index].written)
+        return -EINVAL;
+
+    sc->score[index].written = true;
+    sc->score[index].value = score;
+
+    fenwick_add(sc->tree.sum, sc->capacity, index, score);
+    fenwick_add(sc->tree.sum_hm, sc->capacity, index, 1. / (score + 1.));
+    fenwick_add(sc->tree.cnt, sc->capacity, index, 1.);
+    min_tree_set(sc->tree.min, sc->capacity, index, score);
+
+    return 0;
+}
+
+int vmaf_score_cache_get_score(VmafScoreCache *score_cache, double *score,
+                               unsigned index)
+{
+    if (!score_cache) return -EINVAL;
+    if (!score) return -EINVAL;
+
+    if (index >= score_cache->capacity) return -EINVAL;
+    if (!score_cache->score[index].written) return -EINVAL;
+
+    *score = score_cache->score[index].value;
+    return 0;
+}
+
+int vmaf_score_cache_pool(VmafScoreCache *score_cache,
+                          enum VmafPoolingMethod pool_method, double *score,
+                          unsigned index_low, unsigned index_high)
+{
+    if (!score_cache) return -EINVAL;
+    if (!score) return -EINVAL;
+    if (index_low >= index_high) return -EINVAL;
+
+    VmafScoreCache *const sc = score_cache;
+
+    if (index_low >= sc->capacity) return -EINVAL;
+    if (index_high > sc->capacity) index_high = sc->capacity;
+
+    const double cnt = fenwick_range(sc->tree.cnt, index_low, index_high);
+    if (cnt < 1.) return -EINVAL;
+
+    switch (pool_method) {
+    case VMAF_POOL_METHOD_MIN:
+        *score = min_tree_range(sc->tree.min, sc->capacity,
+                                index_low, index_high);
+        return 0;
+    case VMAF_POOL_METHOD_MEAN:
+        *score = fenwick_range(sc->tree.sum, index_low, index_high) / cnt;
+        return 0;
+    case VMAF_POOL_METHOD_HARMONIC_MEAN:
+        *score =
+            cnt / fenwick_range(sc->tree.sum_hm, index_low, index_high) - 1.;
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+void vmaf_score_cache_destroy(VmafScoreCache *score_cache)
+{
+    if (!score_cache) return;
+
+    free(score_cache->score);
+    free(score_cache->tree.sum);
+    free(score_cache->tree.sum_hm);
+    free(score_cache->tree.cnt);
+    free(score_cache->tree.min);
+    free(score_cache);
+}
@@ -0,0 +1,41 @@
+#ifndef __VMAF_SRC_SCORE_CACHE_H__
+#define __VMAF_SRC_SCORE_CACHE_H__
+
+#include <stdbool.h>
+
+#include <libvmaf/libvmaf.rc.h>
+
+/*
+ * Per-model cache of predicted scores.
+ * Besides the per-frame scores, Fenwick trees (sum, harmonic sum and count)
+ * and a segment tree (min) are maintained, so that pooling over any interval
+ * is O(log n) regardless of the order in which frames are scored.
+ */
+typedef struct VmafScoreCache {
+    struct {
+        bool written;
+        double value;
+    } *score;
+    unsigned capacity;
+    struct {
+        double *sum, *sum_hm, *cnt;
+        double *min;
+    } tree;
+    unsigned complete; // every frame in [0, complete) has been scored
+} VmafScoreCache;
+
+int vmaf_score_cache_init(VmafScoreCache **const score_cache);
+
+int vmaf_score_cache_append(VmafScoreCache *score_cache, double score,
+                            unsigned index);
+
+int vmaf_score_cache_get_score(VmafScoreCache *score_cache, double *score,
+                               unsigned index);
+
+int vmaf_score_cache_pool(VmafScoreCache *score_cache,
+                          enum VmafPoolingMethod pool_method, double *score,
+                          unsigned index_low, unsigned index_high);
+
+void vmaf_score_cache_destroy(VmafScoreCache *score_cache);
+
+#endif /* __VMAF_SRC_SCORE_CACHE_H__ */
@@ -0,0 +1,196 @@
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "subsample.h"
+
+#define SUBSAMPLE_STEP 4
+
+// scene cut: share of the luma histogram that moved, or the mean luma
+// difference to the previous picture against the average of the scene
+#define SUBSAMPLE_CUT_HISTOGRAM 0.4
+#define SUBSAMPLE_CUT_DIFFERENCE_RATIO 3.
+#define SUBSAMPLE_CUT_DIFFERENCE_MIN 10.
+#define SUBSAMPLE_DIFFERENCE_WEIGHT 0.25
+
+// abrupt distortion change to the previous picture, handled like a scene cut
+#define SUBSAMPLE_STEP_ERROR_DB 2.
+#define SUBSAMPLE_STEP_SHARPNESS 0.3
+
+// budgets since the last extracted picture
+#define SUBSAMPLE_MOTION_BUDGET 40.
+#define SUBSAMPLE_ERROR_BUDGET_DB 0.75
+#define SUBSAMPLE_SHARPNESS_BUDGET 0.1
+
+int vmaf_subsample_init(VmafSubsample **subsample, unsigned max_stride,
+                        unsigned n_dist)
+{
+    if (!subsample) return -EINVAL;
+    if (!max_stride) return -EINVAL;
+    if (!n_dist) return -EINVAL;
+
+    VmafSubsample *const s = *subsample = malloc(sizeof(*s));
+    if (!s) return -ENOMEM;
+    memset(s, 0, sizeof(*s));
+    s->max_stride = max_stride;
+    s->n_dist = n_dist;
+    s->distortion = malloc(sizeof(*s->distortion) * n_dist * 2);
+    if (!s->distortion) {
+        free(s);
+        return -ENOMEM;
+    }
+    s->distortion_last = s->distortion + n_dist;
+    return 0;
+}
+
+static unsigned luma(VmafPicture *pic, unsigned i, unsigned j)
+{
+    // 8-bit scale
+    if (pic->bpc > 8) {
+        const uint16_t *data = pic->data[0];
+        return data[i * (pic->stride[0] / 2) + j] >> (pic->bpc - 8);
+    }
+    const uint8_t *data = pic->data[0];
+    return data[i * pic->stride[0] + j];
+}
+
+static unsigned sample_cnt(VmafPicture *pic)
+{
+    return ((pic->w[0] + SUBSAMPLE_STEP - 1) / SUBSAMPLE_STEP) *
+           ((pic->h[0] + SUBSAMPLE_STEP - 1) / SUBSAMPLE_STEP);
+}
+
+/*
+ * Distance of the luma histogram to the previous picture (share of samples
+ * that moved), and the mean absolute luma difference.
+ */
+static void reference_change(VmafSubsample *s, VmafPicture *ref,
+                             double *histogram_distance, double *difference)
+{
+    unsigned hist[SUBSAMPLE_HIST_BINS] = { 0 };
+    double sum = 0.;
+    unsigned cnt = 0;
+    for (unsigned i = 0; i < ref->h[0]; i += SUBSAMPLE_STEP) {
+        for (unsigned j = 0; j < ref->w[0]; j += SUBSAMPLE_STEP) {
+            const uint8_t y = luma(ref, i, j);
+            hist[y * SUBSAMPLE_HIST_BINS / 256]++;
+            sum += abs((int) y - s->luma[cnt]);
+            s->luma[cnt++] = y;
+        }
+    }
+
+    unsigned moved = 0;
+    for (unsigned i = 0; i < SUBSAMPLE_HIST_BINS; i++)
+        moved += hist[i] > s->hist[i] ? hist[i] - s->hist[i] : 0;
+    memcpy(s->hist, hist, sizeof(hist));
+
+    *histogram_distance = (double) moved / cnt;
+    *difference = sum / cnt;
+}
+
+/*
+ * Cheap distortion estimate: mean squared error in dB, and the log2 ratio
+ * of the horizontal gradients of the distorted and reference pictures,
+ * which moves with blurring and noise.
+ */
+static void distortion(VmafPicture *ref, VmafPicture *dist, double *estimate)
+{
+    double sum = 0., grad_ref = 0., grad_dist = 0.;
+    unsigned cnt = 0;
+    for (unsigned i = 0; i < ref->h[0]; i += SUBSAMPLE_STEP) {
+        for (unsigned j = 0; j + 1 < ref->w[0]; j += SUBSAMPLE_STEP) {
+            const int r = luma(ref, i, j), d = luma(dist, i, j);
+            sum += (double) (r - d) * (r - d);
+            grad_ref += abs((int) luma(ref, i, j + 1) - r);
+            grad_dist += abs((int) luma(dist, i, j + 1) - d);
+            cnt++;
+        }
+    }
+    estimate[0] = 10. * log10(1. + sum / cnt);
+    estimate[1] = log2((1. + grad_dist) / (1. + grad_ref));
+}
+
+static bool distortion_changed(const double *a, const double *b,
+                               double error_db, double sharpness)
+{
+    return fabs(a[0] - b[0]) > error_db || fabs(a[1] - b[1]) > sharpness;
+}
+
+int vmaf_subsample_picture(VmafSubsample *s, VmafPicture *ref,
+                           VmafPicture **dist, unsigned n_dist, double motion,
+                           unsigned index, bool *extract, bool *cut)
+{
+    if (!s) return -EINVAL;
+    if (!ref) return -EINVAL;
+    if (!dist) return -EINVAL;
+    if (n_dist != s->n_dist) return -EINVAL;
+    if (!extract) return -EINVAL;
+    if (!cut) return -EINVAL;
+    if (s->started && index != s->index + 1) return -EINVAL;
+
+    if (!s->luma) {
+        s->luma_cnt = sample_cnt(ref);
+        s->luma = malloc(sizeof(*s->luma) * s->luma_cnt);
+        if (!s->luma) return -ENOMEM;
+        memset(s->luma, 0, sizeof(*s->luma) * s->luma_cnt);
+    }
+    if (sample_cnt(ref) != s->luma_cnt) return -EINVAL;
+
+    double histogram_distance, difference;
+    reference_change(s, ref, &histogram_distance, &difference);
+    *cut = !s->started ||
+           histogram_distance > SUBSAMPLE_CUT_HISTOGRAM ||
+           (s->difference_valid &&
+            difference > SUBSAMPLE_CUT_DIFFERENCE_RATIO * s->difference &&
+            difference > SUBSAMPLE_CUT_DIFFERENCE_MIN);
+
+    bool drift = false;
+    for (unsigned i = 0; i < n_dist; i++) {
+        double estimate[2];
+        distortion(ref, dist[i], estimate);
+        *cut |= s->started &&
+                distortion_changed(estimate, s->distortion[i],
+                                   SUBSAMPLE_STEP_ERROR_DB,
+                                   SUBSAMPLE_STEP_SHARPNESS);
+        drift |= distortion_changed(estimate, s->distortion_last[i],
+                                    SUBSAMPLE_ERROR_BUDGET_DB,
+                                    SUBSAMPLE_SHARPNESS_BUDGET);
+        memcpy(s->distortion[i], estimate, sizeof(estimate));
+    }
+
+    // the average difference restarts with every scene
+    if (*cut) {
+        s->difference_valid = false;
+    } else if (!s->difference_valid) {
+        s->difference = difference;
+        s->difference_valid = true;
+    } else {
+        s->difference += (difference - s->difference) *
+                         SUBSAMPLE_DIFFERENCE_WEIGHT;
+    }
+
+    if (motion > 0.) s->motion += motion;
+    *extract = *cut || drift || s->motion >= SUBSAMPLE_MOTION_BUDGET ||
+               index - s->last >= s->max_stride;
+
+    s->started = true;
+    s->index = index;
+    if (*extract) {
+        s->last = index;
+        s->motion = 0.;
+        memcpy(s->distortion_last, s->distortion,
+               sizeof(*s->distortion) * n_dist);
+    }
+    return 0;
+}
+
+void vmaf_subsample_destroy(VmafSubsample *s)
+{
+    if (!s) return;
+    free(s->distortion);
+    free(s->luma);
+    free(s);
+}
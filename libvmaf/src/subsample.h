@@ -0,0 +1,54 @@
+#ifndef __VMAF_SRC_SUBSAMPLE_H__
+#define __VMAF_SRC_SUBSAMPLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <libvmaf/picture.h>
+
+/*
+ * Adaptive temporal subsampling: decides per picture, in order, whether the
+ * spatial features are extracted. A picture is extracted when
+ *   - it starts a scene, or the distortion changes abruptly (a cut),
+ *   - the motion accumulated since the last extracted picture, or the drift
+ *     of a cheap distortion estimate, exceeds its budget,
+ *   - or max_stride pictures have passed since the last extracted picture.
+ * Pictures are inspected on every 4th pixel of every 4th row of the luma.
+ */
+
+#define SUBSAMPLE_HIST_BINS 64
+
+typedef struct VmafSubsample {
+    unsigned max_stride;
+    unsigned n_dist;
+    bool started;
+    unsigned index; // last picture seen
+    unsigned last; // last extracted picture
+    double motion; // accumulated since last
+    // per distorted picture, of the last picture and last extracted picture
+    double (*distortion)[2], (*distortion_last)[2];
+    // of the previous reference: luma histogram and samples,
+    // average luma difference between the pictures of its scene
+    unsigned hist[SUBSAMPLE_HIST_BINS];
+    uint8_t *luma;
+    unsigned luma_cnt;
+    double difference;
+    bool difference_valid;
+} VmafSubsample;
+
+int vmaf_subsample_init(VmafSubsample **subsample, unsigned max_stride,
+                        unsigned n_dist);
+
+/*
+ * Pictures have to be passed in order. motion is the motion score known at
+ * this picture, negative if there is none. On return, *extract tells if the
+ * spatial features of this picture are extracted, and if so, *cut tells if
+ * the pictures skipped before it belong to another scene.
+ */
+int vmaf_subsample_picture(VmafSubsample *subsample, VmafPicture *ref,
+                           VmafPicture **dist, unsigned n_dist, double motion,
+                           unsigned index, bool *extract, bool *cut);
+
+void vmaf_subsample_destroy(VmafSubsample *subsample);
+
+#endif /* __VMAF_SRC_SUBSAMPLE_H__ */
@@ -317,6 +317,155 @@ double svm_predict(const svm_model *model, const svm_node *x)
     return pred_result;
 }
 
+//
+// Batched prediction
+//
+// Bootstrap models are trained on resamplings of the same training set, so
+// their support vectors overlap heavily. When all models share the same kernel,
+// a batch evaluates the kernel once per unique support vector and reuses the
+// value across models. Per-model sums are accumulated in the original SV
+// order, so results are identical to svm_predict().
+//
+struct svm_model_batch
+{
+    int n;                      /* number of models */
+    const svm_model **model;    /* models (model[n]), not owned */
+    int l;                      /* number of unique SVs */
+    const svm_node **SV;        /* unique SVs (SV[l]), point into model[]->SV */
+    int **sv_index;             /* SV index of model[m]->SV[i] (sv_index[m][i]) */
+    int shared_kernel;          /* 0 if models must be evaluated one by one */
+};
+
+static bool svm_node_equal(const svm_node *x, const svm_node *y)
+{
+    while(x->index != -1 && y->index != -1)
+    {
+        if(x->index != y->index || x->value != y->value)
+            return false;
+        ++x;
+        ++y;
+    }
+    return x->index == y->index;
+}
+
+static bool svm_kernel_shareable(const svm_model *a, const svm_model *b)
+{
+    if(a->param.svm_type != EPSILON_SVR && a->param.svm_type != NU_SVR)
+        return false;
+    return a->param.svm_type == b->param.svm_type &&
+           a->param.kernel_type == b->param.kernel_type &&
+           a->param.degree == b->param.degree &&
+           a->param.gamma == b->param.gamma &&
+           a->param.coef0 == b->param.coef0;
+}
+
+struct svm_model_batch *svm_model_batch_create(struct svm_model **model, int n)
+{
+    if(model == NULL || n <= 0)
+        return NULL;
+
+    svm_model_batch *batch = Malloc(svm_model_batch,1);
+    if(batch == NULL)
+        return NULL;
+    batch->n = n;
+    batch->l = 0;
+    batch->SV = NULL;
+    batch->sv_index = NULL;
+    batch->model = Malloc(const svm_model *,n);
+    if(batch->model == NULL)
+        goto fail;
+
+    batch->shared_kernel = 1;
+    for(int m=0;m<n;m++)
+    {
+        batch->model[m] = model[m];
+        if(!svm_kernel_shareable(model[0], model[m]))
+            batch->shared_kernel = 0;
+    }
+    if(!batch->shared_kernel)
+        return batch;
+
+    {
+        int total_sv = 0;
+        for(int m=0;m<n;m++)
+            total_sv += model[m]->l;
+
+        batch->SV = Malloc(const svm_node *,total_sv);
+        batch->sv_index = (int **) calloc(n, sizeof(int *));
+        if(batch->SV == NULL || batch->sv_index == NULL)
+            goto fail;
+
+        for(int m=0;m<n;m++)
+        {
+            batch->sv_index[m] = Malloc(int,model[m]->l);
+            if(batch->sv_index[m] == NULL)
+                goto fail;
+            for(int i=0;i<model[m]->l;i++)
+            {
+                int j;
+                for(j=0;j<batch->l;j++)
+                    if(svm_node_equal(batch->SV[j], model[m]->SV[i]))
+                        break;
+                if(j == batch->l)
+                    batch->SV[batch->l++] = model[m]->SV[i];
+                batch->sv_index[m][i] = j;
+            }
+        }
+    }
+    return batch;
+
+fail:
+    svm_model_batch_destroy(&batch);
+    return NULL;
+}
+
+void svm_predict_batch(const struct svm_model_batch *batch,
+                       const struct svm_node *x, double *prediction)
+{
+    if(!batch->shared_kernel)
+    {
+        for(int m=0;m<batch->n;m++)
+            prediction[m] = svm_predict(batch->model[m], x);
+        return;
+    }
+
+    const svm_parameter& param = batch->model[0]->param;
+    double *kvalue = Malloc(double,batch->l);
+    for(int j=0;j<batch->l;j++)
+        kvalue[j] = Kernel::k_function(x,batch->SV[j],param);
+
+    for(int m=0;m<batch->n;m++)
+    {
+        const svm_model *model = batch->model[m];
+        const int *sv_index = batch->sv_index[m];
+        double *sv_coef = model->sv_coef[0];
+        double sum = 0;
+        for(int i=0;i<model->l;i++)
+            sum += sv_coef[i] * kvalue[sv_index[i]];
+        sum -= model->rho[0];
+        prediction[m] = sum;
+    }
+    free(kvalue);
+}
+
+void svm_model_batch_destroy(struct svm_model_batch **batch_ptr)
+{
+    if(batch_ptr == NULL || *batch_ptr == NULL)
+        return;
+
+    svm_model_batch *batch = *batch_ptr;
+    if(batch->sv_index)
+    {
+        for(int m=0;m<batch->n;m++)
+            free(batch->sv_index[m]);
+    }
+    free(batch->sv_index);
+    free(batch->SV);
+    free(batch->model);
+    free(batch);
+    *batch_ptr = NULL;
+}
+
 static const char *svm_type_table[] =
 {
     "c_svc","nu_svc","one_class","epsilon_svr","nu_svr",NULL
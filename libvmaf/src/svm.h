@@ -76,6 +76,12 @@ struct svm_model *svm_load_model(const char *model_file_name);
 double svm_predict_values(const struct svm_model *model, const struct svm_node *x, double* dec_values);
 double svm_predict(const struct svm_model *model, const struct svm_node *x);
 
+struct svm_model_batch;
+
+struct svm_model_batch *svm_model_batch_create(struct svm_model **model, int n);
+void svm_predict_batch(const struct svm_model_batch *batch, const struct svm_node *x, double *prediction);
+void svm_model_batch_destroy(struct svm_model_batch **batch_ptr);
+
 void svm_free_model_content(struct svm_model *model_ptr);
 void svm_free_and_destroy_model(struct svm_model** model_ptr_ptr);
 
@@ -0,0 +1,184 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thread_pool.h"
+
+typedef struct VmafThreadPoolJob {
+    void (*func)(void *data);
+    void *data;
+    struct VmafThreadPoolJob *next;
+} VmafThreadPoolJob;
+
+struct VmafThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t queued, done;
+    VmafThreadPoolJob *head, *tail;
+    unsigned n_threads, n_started, n_working;
+    bool stop;
+    pthread_t *thread;
+};
+
+static void *thread_pool_thread(void *arg)
+{
+    VmafThreadPool *pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->head && !pool->stop)
+            pthread_cond_wait(&pool->queued, &pool->lock);
+        if (!pool->head) break;
+
+        VmafThreadPoolJob *job = pool->head;
+        pool->head = job->next;
+        if (!pool->head) pool->tail = NULL;
+        pool->n_working++;
+        pthread_mutex_unlock(&pool->lock);
+
+        job->func(job->data);
+        free(job);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->n_working--;
+        if (!pool->head && !pool->n_working)
+            pthread_cond_broadcast(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int vmaf_thread_pool_create(VmafThreadPool **pool, unsigned n_threads)
+{
+    if (!pool) return -EINVAL;
+    if (!n_threads) return -EINVAL;
+
+    VmafThreadPool *const p = *pool = malloc(sizeof(*p));
+    if (!p) return -ENOMEM;
+    memset(p, 0, sizeof(*p));
+    p->n_threads = n_threads;
+    p->thread = malloc(sizeof(*(p->thread)) * n_threads);
+    if (!p->thread) {
+        free(p);
+        return -ENOMEM;
+    }
+
+    pthread_mutex_init(&(p->lock), NULL);
+    pthread_cond_init(&(p->queued), NULL);
+    pthread_cond_init(&(p->done), NULL);
+    for (; p->n_started < n_threads; p->n_started++) {
+        if (pthread_create(&(p->thread[p->n_started]), NULL,
+                           thread_pool_thread, p))
+        {
+            vmaf_thread_pool_destroy(p);
+            return -ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+int vmaf_thread_pool_enqueue(VmafThreadPool *pool, void (*func)(void *data),
+                             void *data, size_t data_sz)
+{
+    if (!pool) return -EINVAL;
+    if (!func) return -EINVAL;
+
+    // the job and its data in one allocation
+    VmafThreadPoolJob *job = malloc(sizeof(*job) + data_sz);
+    if (!job) return -ENOMEM;
+    job->func = func;
+    job->data = data_sz ? (void *) (job + 1) : data;
+    job->next = NULL;
+    if (data_sz) memcpy(job->data, data, data_sz);
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail)
+        pool->tail->next = job;
+    else
+        pool->head = job;
+    pool->tail = job;
+    pthread_cond_signal(&pool->queued);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+int vmaf_thread_pool_wait(VmafThreadPool *pool)
+{
+    if (!pool) return -EINVAL;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->head || pool->n_working)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    return 0;
+}
+
+int vmaf_thread_pool_destroy(VmafThreadPool *pool)
+{
+    if (!pool) return -EINVAL;
+
+    // queued jobs still run before the threads stop
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->queued);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned i = 0; i < pool->n_started; i++)
+        pthread_join(pool->thread[i], NULL);
+
+    pthread_mutex_destroy(&(pool->lock));
+    pthread_cond_destroy(&(pool->queued));
+    pthread_cond_destroy(&(pool->done));
+    free(pool->thread);
+    free(pool);
+    return 0;
+}
+
+typedef struct ThreadPoolStripe {
+    void (*func)(void *data, unsigned row_begin, unsigned row_end);
+    void *data;
+    unsigned row_begin, row_end;
+} ThreadPoolStripe;
+
+static void thread_pool_stripe(void *data)
+{
+    ThreadPoolStripe *stripe = data;
+    stripe->func(stripe->data, stripe->row_begin, stripe->row_end);
+}
+
+int vmaf_thread_pool_stripes(VmafThreadPool *pool, unsigned h,
+                             unsigned min_rows,
+                             void (*func)(void *data, unsigned row_begin,
+                                          unsigned row_end),
+                             void *data)
+{
+    if (!func) return -EINVAL;
+
+    unsigned n_stripes = pool ? pool->n_threads : 1;
+    if (min_rows && h / min_rows < n_stripes)
+        n_stripes = h / min_rows;
+    if (n_stripes <= 1) {
+        if (h) func(data, 0, h);
+        return 0;
+    }
+
+    int err = 0;
+    for (unsigned i = 0; i < n_stripes; i++) {
+        ThreadPoolStripe stripe = {
+            .func = func,
+            .data = data,
+            .row_begin = (unsigned) ((unsigned long long) h * i / n_stripes),
+            .row_end = (unsigned) ((unsigned long long) h * (i + 1) / n_stripes),
+        };
+        err = vmaf_thread_pool_enqueue(pool, thread_pool_stripe, &stripe,
+                                       sizeof(stripe));
+        if (err) break;
+    }
+    // stripes already queued may still read and write the caller's buffers
+    vmaf_thread_pool_wait(pool);
+    return err;
+}
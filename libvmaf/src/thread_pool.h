@@ -0,0 +1,35 @@
+#ifndef __VMAF_SRC_THREAD_POOL_H__
+#define __VMAF_SRC_THREAD_POOL_H__
+
+#include <stddef.h>
+
+typedef struct VmafThreadPool VmafThreadPool;
+
+int vmaf_thread_pool_create(VmafThreadPool **pool, unsigned n_threads);
+
+/*
+ * Queues func, called with a copy of the data_sz bytes at data, which are
+ * freed once func returns.
+ */
+int vmaf_thread_pool_enqueue(VmafThreadPool *pool, void (*func)(void *data),
+                             void *data, size_t data_sz);
+
+// waits until all queued jobs are done
+int vmaf_thread_pool_wait(VmafThreadPool *pool);
+
+int vmaf_thread_pool_destroy(VmafThreadPool *pool);
+
+/*
+ * Splits the rows [0, h) in horizontal stripes, one per thread of pool and
+ * at least min_rows high, runs func on every stripe [row_begin, row_end)
+ * and waits for them. Stripes read the rows around them (their halo) from
+ * buffers computed before, and only write their own rows. Without a pool,
+ * func runs on all rows on the calling thread.
+ */
+int vmaf_thread_pool_stripes(VmafThreadPool *pool, unsigned h,
+                             unsigned min_rows,
+                             void (*func)(void *data, unsigned row_begin,
+                                          unsigned row_end),
+                             void *data);
+
+#endif /* __VMAF_SRC_THREAD_POOL_H__ */
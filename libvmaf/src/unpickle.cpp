@@ -30,13 +30,24 @@ static int unpickle(VmafModel *model, const char *pickle_path)
 
     if (VAL_EQUAL_STR(model_type, "'RESIDUEBOOTSTRAP_LIBSVMNUSVR'"))
         model->type = VMAF_MODEL_RESIDUE_BOOTSTRAP_SVM_NUSVR;
-    else if (VAL_EQUAL_STR(model_type, "BOOTSTRAP_LIBSVMNUSVR"))
+    else if (VAL_EQUAL_STR(model_type, "'BOOTSTRAP_LIBSVMNUSVR'"))
         model->type = VMAF_MODEL_BOOTSTRAP_SVM_NUSVR;
     else if (VAL_EQUAL_STR(model_type, "'LIBSVMNUSVR'"))
         model->type = VMAF_MODEL_TYPE_SVM_NUSVR;
     else
         return -EINVAL;
 
+    if (model->type == VMAF_MODEL_BOOTSTRAP_SVM_NUSVR ||
+        model->type == VMAF_MODEL_RESIDUE_BOOTSTRAP_SVM_NUSVR)
+    {
+        Val num_models = pickle_model["param_dict"]["num_models"];
+        if (VAL_IS_NONE(num_models))
+            return -EINVAL;
+        model->bootstrap.n_models = int(num_models);
+        if (model->bootstrap.n_models < 2)
+            return -EINVAL;
+    }
+
     if (VAL_EQUAL_STR(norm_type, "'linear_rescale'"))
         model->norm_type = VMAF_MODEL_NORMALIZATION_TYPE_LINEAR_RESCALE;
     else if (VAL_EQUAL_STR(norm_type, "'none'"))
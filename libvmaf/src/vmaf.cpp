@@ -32,6 +32,7 @@
 #include "timer.h"
 #include "jsonprint.h"
 #include "debug.h"
+#include "feature_log.h"
 
 #define VAL_EQUAL_STR(V,S) (Stringize((V)).compare((S))==0)
 #define VAL_IS_LIST(V) ((V).tag=='n') /* check ocval.cc */
@@ -52,6 +53,11 @@ void SvmDelete::operator()(void *svm)
     svm_free_and_destroy_model((svm_model **)&svm);
 }
 
+void SvmBatchDelete::operator()(void *svm_batch)
+{
+    svm_model_batch_destroy((svm_model_batch **)&svm_batch);
+}
+
 void LibsvmNusvrTrainTestModel::_assert_model_type(Val model_type) {
     if (!VAL_EQUAL_STR(model_type, "'LIBSVMNUSVR'")) {
         printf("Expect model type LIBSVMNUSVR, "
@@ -379,17 +385,38 @@ void BootstrapLibsvmNusvrTrainTestModel::load_model()
         }
     }
 
+    /* all models are evaluated in one batched pass, sharing kernel evaluations */
+    std::vector<svm_model*> svm_models;
+    svm_models.push_back(svm_model_ptr.get());
+    for (size_t i=0; i<bootstrap_svm_model_ptrs.size(); i++)
+    {
+        svm_models.push_back(bootstrap_svm_model_ptrs.at(i).get());
+    }
+    svm_model_batch_ptr.reset(svm_model_batch_create(svm_models.data(), svm_models.size()));
+    if (!svm_model_batch_ptr) {
+        printf("Error creating SVM model batch.\n");
+        throw VmafException("Error creating SVM model batch");
+    }
+
 }
 
 VmafPredictionStruct BootstrapLibsvmNusvrTrainTestModel::predict(svm_node* nodes) {
 
-    VmafPredictionStruct predictionStruct = LibsvmNusvrTrainTestModel::predict(nodes);
+    VmafPredictionStruct predictionStruct;
+
+    /* predictions[0] is the base model, the rest are the bootstrap models */
+    std::vector<double> predictions(bootstrap_svm_model_ptrs.size() + 1);
+    svm_predict_batch(svm_model_batch_ptr.get(), nodes, predictions.data());
+
+    double prediction = predictions.at(0);
+    _denormalize_prediction(prediction);
+    predictionStruct.vmafPrediction[VmafPredictionReturnType::SCORE] = prediction;
 
     StatVector bootstrapPredictions;
     double bootstrapPrediction;
 
     for (size_t i=0; i<bootstrap_svm_model_ptrs.size(); i++) {
-        bootstrapPrediction = svm_predict(bootstrap_svm_model_ptrs.at(i).get(), nodes);
+        bootstrapPrediction = predictions.at(i + 1);
         _denormalize_prediction(bootstrapPrediction);
         bootstrapPredictions.append(bootstrapPrediction);
     }
@@ -474,68 +501,161 @@ void VmafQualityRunner::_postproc_transform_clip(
     ;
 }
 
-void VmafQualityRunner::_normalize_predict_denormalize_transform_clip(
-        LibsvmNusvrTrainTestModel& model, size_t num_frms,
-        StatVector& adm2, StatVector& adm_scale0, StatVector& adm_scale1,
-        StatVector& adm_scale2, StatVector& adm_scale3, StatVector& motion,
-        StatVector& vif_scale0, StatVector& vif_scale1, StatVector& vif_scale2,
-        StatVector& vif_scale3, StatVector& vif, StatVector& motion2,
-        bool enable_transform, bool disable_clip,
-        std::vector<VmafPredictionStruct>& predictionStructs) {
+std::unique_ptr<LibsvmNusvrTrainTestModel> VmafQualityRunner::_load_model(const char *model_path)
+{
+    std::unique_ptr<LibsvmNusvrTrainTestModel> model_ptr = std::unique_ptr<LibsvmNusvrTrainTestModel>(new LibsvmNusvrTrainTestModel(model_path));
+    model_ptr->load_model();
+    return model_ptr;
+}
 
-    /* IMPORTANT: always allocate one more spot and put a -1 at the last one's
-     * index, so that libsvm will stop looping when seeing the -1 !!!
-     * see https://github.com/cjlin1/libsvm */
-    svm_node* nodes = (svm_node*) alloca(
-            sizeof(svm_node) * (model.feature_names.length() + 1));
-    nodes[model.feature_names.length()].index = -1;
+/* feature groups computed by combo() */
+enum VmafFeatureMask
+{
+    VMAF_FEATURE_ADM    = 1 << 0,
+    VMAF_FEATURE_MOTION = 1 << 1,
+    VMAF_FEATURE_VIF    = 1 << 2,
+};
+
+/*
+ * returns the feature groups that the model needs, so that combo() can
+ * skip the kernels of all other groups
+ */
+static unsigned _get_feature_mask(LibsvmNusvrTrainTestModel& model)
+{
+    unsigned mask = 0;
+    for (size_t j = 0; j < model.feature_names.length(); j++) {
+        std::string name = Stringize(model.feature_names[j]);
+        if (name.compare(0, 17, "'VMAF_feature_adm") == 0)
+            mask |= VMAF_FEATURE_ADM;
+        else if (name.compare(0, 20, "'VMAF_feature_motion") == 0)
+            mask |= VMAF_FEATURE_MOTION;
+        else if (name.compare(0, 17, "'VMAF_feature_vif") == 0)
+            mask |= VMAF_FEATURE_VIF;
+        else {
+            printf("Unknown feature name: %s.\n", name.c_str());
+            throw VmafException("Unknown feature name");
+        }
+    }
+    return mask;
+}
 
-    size_t i_subsampled;
-    for (size_t i_frm=0; i_frm<num_frms; i_frm++) {
-        model.populate_and_normalize_nodes_at_frm(i_frm, nodes, adm2,
-                adm_scale0, adm_scale1, adm_scale2, adm_scale3, motion,
-                vif_scale0, vif_scale1, vif_scale2, vif_scale3, vif, motion2);
+/*
+ * state shared with _predict_frame(), which combo() calls for every frame
+ * as soon as its atom features are extracted
+ */
+struct VmafPredictFrameContext
+{
+    VmafQualityRunner *runner;
+    LibsvmNusvrTrainTestModel *model;
+    bool do_adm, do_motion, do_vif;
+    bool enable_transform, disable_clip;
+    int n_subsample;
+    DArray *adm_num_array, *adm_den_array, *adm_num_scale0_array,
+            *adm_den_scale0_array, *adm_num_scale1_array, *adm_den_scale1_array,
+            *adm_num_scale2_array, *adm_den_scale2_array, *adm_num_scale3_array,
+            *adm_den_scale3_array, *motion_array, *motion2_array,
+            *vif_num_scale0_array, *vif_den_scale0_array, *vif_num_scale1_array,
+            *vif_den_scale1_array, *vif_num_scale2_array, *vif_den_scale2_array,
+            *vif_num_scale3_array, *vif_den_scale3_array, *vif_array,
+            *psnr_array, *ssim_array, *ms_ssim_array;
+    /* only the feature groups the model uses are filled */
+    StatVector adm2, adm_scale0, adm_scale1, adm_scale2, adm_scale3, motion,
+            vif_scale0, vif_scale1, vif_scale2, vif_scale3, vif, motion2;
+    StatVector psnr, ssim, ms_ssim;
+    std::vector<svm_node> nodes;
+    std::vector<VmafPredictionStruct> predictionStructs;
+    std::string error;
+};
 
-        VmafPredictionStruct predictionStruct = model.predict(nodes);
+int VmafQualityRunner::_predict_frame(int frm_idx, void *user_data)
+{
+    VmafPredictFrameContext& ctx = *(VmafPredictFrameContext *)user_data;
 
-        _postproc_predict(predictionStruct);
+    if (frm_idx % ctx.n_subsample != 0) {
+        return 0;
+    }
 
-        if (enable_transform) {
-            _transform_score(model, predictionStruct);
+    try {
+        double ADM2_CONSTANT = 0.0;
+        double ADM_SCALE_CONSTANT = 0.0;
+        if (ctx.do_adm) {
+            ctx.adm2.append(
+                    (get_at(ctx.adm_num_array, frm_idx) + ADM2_CONSTANT)
+                            / (get_at(ctx.adm_den_array, frm_idx) + ADM2_CONSTANT));
+            ctx.adm_scale0.append(
+                    (get_at(ctx.adm_num_scale0_array, frm_idx) + ADM_SCALE_CONSTANT)
+                            / (get_at(ctx.adm_den_scale0_array, frm_idx) + ADM_SCALE_CONSTANT));
+            ctx.adm_scale1.append(
+                    (get_at(ctx.adm_num_scale1_array, frm_idx) + ADM_SCALE_CONSTANT)
+                            / (get_at(ctx.adm_den_scale1_array, frm_idx) + ADM_SCALE_CONSTANT));
+            ctx.adm_scale2.append(
+                    (get_at(ctx.adm_num_scale2_array, frm_idx) + ADM_SCALE_CONSTANT)
+                            / (get_at(ctx.adm_den_scale2_array, frm_idx) + ADM_SCALE_CONSTANT));
+            ctx.adm_scale3.append(
+                    (get_at(ctx.adm_num_scale3_array, frm_idx) + ADM_SCALE_CONSTANT)
+                            / (get_at(ctx.adm_den_scale3_array, frm_idx) + ADM_SCALE_CONSTANT));
         }
-
-        if (!disable_clip) {
-            _clip_score(model, predictionStruct);
+        if (ctx.do_motion) {
+            ctx.motion.append(get_at(ctx.motion_array, frm_idx));
+            ctx.motion2.append(get_at(ctx.motion2_array, frm_idx));
+        }
+        if (ctx.do_vif) {
+            ctx.vif_scale0.append(
+                    get_at(ctx.vif_num_scale0_array, frm_idx)
+                            / get_at(ctx.vif_den_scale0_array, frm_idx));
+            ctx.vif_scale1.append(
+                    get_at(ctx.vif_num_scale1_array, frm_idx)
+                            / get_at(ctx.vif_den_scale1_array, frm_idx));
+            ctx.vif_scale2.append(
+                    get_at(ctx.vif_num_scale2_array, frm_idx)
+                            / get_at(ctx.vif_den_scale2_array, frm_idx));
+            ctx.vif_scale3.append(
+                    get_at(ctx.vif_num_scale3_array, frm_idx)
+                            / get_at(ctx.vif_den_scale3_array, frm_idx));
+            ctx.vif.append(get_at(ctx.vif_array, frm_idx));
+        }
+        if (ctx.psnr_array != NULL) {
+            ctx.psnr.append(get_at(ctx.psnr_array, frm_idx));
+        }
+        if (ctx.ssim_array != NULL) {
+            ctx.ssim.append(get_at(ctx.ssim_array, frm_idx));
         }
+        if (ctx.ms_ssim_array != NULL) {
+            ctx.ms_ssim.append(get_at(ctx.ms_ssim_array, frm_idx));
+        }
+
+        size_t i_subsampled = ctx.predictionStructs.size();
+        svm_node *nodes = ctx.nodes.data();
+        ctx.model->populate_and_normalize_nodes_at_frm(i_subsampled, nodes,
+                ctx.adm2, ctx.adm_scale0, ctx.adm_scale1, ctx.adm_scale2,
+                ctx.adm_scale3, ctx.motion, ctx.vif_scale0, ctx.vif_scale1,
+                ctx.vif_scale2, ctx.vif_scale3, ctx.vif, ctx.motion2);
+
+        VmafPredictionStruct predictionStruct = ctx.model->predict(nodes);
 
-        _postproc_transform_clip(predictionStruct);
+        ctx.runner->_postproc_predict(predictionStruct);
 
-        dbg_printf("frame: %zu, ", i_frm);
-        dbg_printf("adm2: %f, ", adm2.at(i_frm));
-        dbg_printf("adm_scale0: %f, ", adm_scale0.at(i_frm));
-        dbg_printf("adm_scale1: %f, ", adm_scale1.at(i_frm));
-        dbg_printf("adm_scale2: %f, ", adm_scale2.at(i_frm));
-        dbg_printf("adm_scale3: %f, ", adm_scale3.at(i_frm));
-        dbg_printf("motion: %f, ", motion.at(i_frm));
-        dbg_printf("vif_scale0: %f, ", vif_scale0.at(i_frm));
-        dbg_printf("vif_scale1: %f, ", vif_scale1.at(i_frm));
-        dbg_printf("vif_scale2: %f, ", vif_scale2.at(i_frm));
-        dbg_printf("vif_scale3: %f, ", vif_scale3.at(i_frm));
-        dbg_printf("vif: %f, ", vif.at(i_frm));
-        dbg_printf("motion2: %f, ", motion2.at(i_frm));
+        if (ctx.enable_transform) {
+            ctx.runner->_transform_score(*ctx.model, predictionStruct);
+        }
+
+        if (!ctx.disable_clip) {
+            ctx.runner->_clip_score(*ctx.model, predictionStruct);
+        }
 
-        dbg_printf("\n");
+        ctx.runner->_postproc_transform_clip(predictionStruct);
 
-        predictionStructs.push_back(predictionStruct);
+        dbg_printf("frame: %d, ", frm_idx);
+        dbg_printf("vmaf: %f\n",
+                predictionStruct.vmafPrediction[VmafPredictionReturnType::SCORE]);
 
+        ctx.predictionStructs.push_back(predictionStruct);
+    } catch (const std::exception& e) {
+        ctx.error = e.what();
+        return -1;
     }
-}
 
-std::unique_ptr<LibsvmNusvrTrainTestModel> VmafQualityRunner::_load_model(const char *model_path)
-{
-    std::unique_ptr<LibsvmNusvrTrainTestModel> model_ptr = std::unique_ptr<LibsvmNusvrTrainTestModel>(new LibsvmNusvrTrainTestModel(model_path));
-    model_ptr->load_model();
-    return model_ptr;
+    return 0;
 }
 
 void VmafQualityRunner::_set_prediction_result(
@@ -571,30 +691,34 @@ Result VmafQualityRunner::run(Asset asset, int (*read_frame)(float *ref_data, fl
             ssim_array, ms_ssim_array;
     /* use the following ptrs as flags to turn on/off optional metrics */
     DArray *psnr_array_ptr, *ssim_array_ptr, *ms_ssim_array_ptr;
-    init_array(&adm_num_array, INIT_FRAMES);
-    init_array(&adm_den_array, INIT_FRAMES);
-    init_array(&adm_num_scale0_array, INIT_FRAMES);
-    init_array(&adm_den_scale0_array, INIT_FRAMES);
-    init_array(&adm_num_scale1_array, INIT_FRAMES);
-    init_array(&adm_den_scale1_array, INIT_FRAMES);
-    init_array(&adm_num_scale2_array, INIT_FRAMES);
-    init_array(&adm_den_scale2_array, INIT_FRAMES);
-    init_array(&adm_num_scale3_array, INIT_FRAMES);
-    init_array(&adm_den_scale3_array, INIT_FRAMES);
-    init_array(&motion_array, INIT_FRAMES);
-    init_array(&motion2_array, INIT_FRAMES);
-    init_array(&vif_num_scale0_array, INIT_FRAMES);
-    init_array(&vif_den_scale0_array, INIT_FRAMES);
-    init_array(&vif_num_scale1_array, INIT_FRAMES);
-    init_array(&vif_den_scale1_array, INIT_FRAMES);
-    init_array(&vif_num_scale2_array, INIT_FRAMES);
-    init_array(&vif_den_scale2_array, INIT_FRAMES);
-    init_array(&vif_num_scale3_array, INIT_FRAMES);
-    init_array(&vif_den_scale3_array, INIT_FRAMES);
-    init_array(&vif_array, INIT_FRAMES);
-    init_array(&psnr_array, INIT_FRAMES);
-    init_array(&ssim_array, INIT_FRAMES);
-    init_array(&ms_ssim_array, INIT_FRAMES);
+    /* only compute the feature groups the model needs */
+    unsigned feature_mask = _get_feature_mask(model);
+    bool do_adm = feature_mask & VMAF_FEATURE_ADM;
+    bool do_motion = feature_mask & VMAF_FEATURE_MOTION;
+    bool do_vif = feature_mask & VMAF_FEATURE_VIF;
+    if (!feature_mask) {
+        throw VmafException("Model does not use any feature");
+    }
+    DArray *arrays[] = {
+        &adm_num_array, &adm_den_array, &adm_num_scale0_array,
+        &adm_den_scale0_array, &adm_num_scale1_array, &adm_den_scale1_array,
+        &adm_num_scale2_array, &adm_den_scale2_array, &adm_num_scale3_array,
+        &adm_den_scale3_array, &motion_array, &motion2_array,
+        &vif_num_scale0_array, &vif_den_scale0_array, &vif_num_scale1_array,
+        &vif_den_scale1_array, &vif_num_scale2_array, &vif_den_scale2_array,
+        &vif_num_scale3_array, &vif_den_scale3_array, &vif_array, &psnr_array,
+        &ssim_array, &ms_ssim_array
+    };
+    int err = 0;
+    for (DArray *array : arrays) {
+        err |= init_array(array, INIT_FRAMES);
+    }
+    if (err) {
+        for (DArray *array : arrays) {
+            free_array(array);
+        }
+        throw VmafException("Failed to allocate the feature arrays");
+    }
     /* optional output arrays */
     if (do_psnr) {
         psnr_array_ptr = &psnr_array;
@@ -611,168 +735,105 @@ Result VmafQualityRunner::run(Asset asset, int (*read_frame)(float *ref_data, fl
     } else {
         ms_ssim_array_ptr = NULL;
     }
-    dbg_printf("Extract atom features...\n");
-    int ret = combo(read_frame, user_data, w, h, fmt, &adm_num_array,
-            &adm_den_array, &adm_num_scale0_array, &adm_den_scale0_array,
-            &adm_num_scale1_array, &adm_den_scale1_array, &adm_num_scale2_array,
-            &adm_den_scale2_array, &adm_num_scale3_array, &adm_den_scale3_array,
-            &motion_array, &motion2_array, &vif_num_scale0_array,
-            &vif_den_scale0_array, &vif_num_scale1_array, &vif_den_scale1_array,
-            &vif_num_scale2_array, &vif_den_scale2_array, &vif_num_scale3_array,
-            &vif_den_scale3_array, &vif_array, psnr_array_ptr, ssim_array_ptr,
-            ms_ssim_array_ptr, errmsg, n_thread, n_subsample);
+    VmafPredictFrameContext ctx { };
+    ctx.runner = this;
+    ctx.model = &model;
+    ctx.do_adm = do_adm;
+    ctx.do_motion = do_motion;
+    ctx.do_vif = do_vif;
+    ctx.enable_transform = enable_transform;
+    ctx.disable_clip = disable_clip;
+    ctx.n_subsample = n_subsample;
+    ctx.adm_num_array = &adm_num_array;
+    ctx.adm_den_array = &adm_den_array;
+    ctx.adm_num_scale0_array = &adm_num_scale0_array;
+    ctx.adm_den_scale0_array = &adm_den_scale0_array;
+    ctx.adm_num_scale1_array = &adm_num_scale1_array;
+    ctx.adm_den_scale1_array = &adm_den_scale1_array;
+    ctx.adm_num_scale2_array = &adm_num_scale2_array;
+    ctx.adm_den_scale2_array = &adm_den_scale2_array;
+    ctx.adm_num_scale3_array = &adm_num_scale3_array;
+    ctx.adm_den_scale3_array = &adm_den_scale3_array;
+    ctx.motion_array = &motion_array;
+    ctx.motion2_array = &motion2_array;
+    ctx.vif_num_scale0_array = &vif_num_scale0_array;
+    ctx.vif_den_scale0_array = &vif_den_scale0_array;
+    ctx.vif_num_scale1_array = &vif_num_scale1_array;
+    ctx.vif_den_scale1_array = &vif_den_scale1_array;
+    ctx.vif_num_scale2_array = &vif_num_scale2_array;
+    ctx.vif_den_scale2_array = &vif_den_scale2_array;
+    ctx.vif_num_scale3_array = &vif_num_scale3_array;
+    ctx.vif_den_scale3_array = &vif_den_scale3_array;
+    ctx.vif_array = &vif_array;
+    ctx.psnr_array = psnr_array_ptr;
+    ctx.ssim_array = ssim_array_ptr;
+    ctx.ms_ssim_array = ms_ssim_array_ptr;
+    /* IMPORTANT: always allocate one more spot and put a -1 at the last one's
+     * index, so that libsvm will stop looping when seeing the -1 !!!
+     * see https://github.com/cjlin1/libsvm */
+    ctx.nodes.resize(model.feature_names.length() + 1);
+    ctx.nodes[model.feature_names.length()].index = -1;
+    dbg_printf("Extract atom features, normalize features, SVM regression, "
+            "denormalize score, clip...\n");
+    int ret = combo(read_frame, user_data, w, h, fmt,
+            do_adm ? &adm_num_array : NULL, do_adm ? &adm_den_array : NULL,
+            do_adm ? &adm_num_scale0_array : NULL, do_adm ? &adm_den_scale0_array : NULL,
+            do_adm ? &adm_num_scale1_array : NULL, do_adm ? &adm_den_scale1_array : NULL,
+            do_adm ? &adm_num_scale2_array : NULL, do_adm ? &adm_den_scale2_array : NULL,
+            do_adm ? &adm_num_scale3_array : NULL, do_adm ? &adm_den_scale3_array : NULL,
+            do_motion ? &motion_array : NULL, do_motion ? &motion2_array : NULL,
+            do_vif ? &vif_num_scale0_array : NULL, do_vif ? &vif_den_scale0_array : NULL,
+            do_vif ? &vif_num_scale1_array : NULL, do_vif ? &vif_den_scale1_array : NULL,
+            do_vif ? &vif_num_scale2_array : NULL, do_vif ? &vif_den_scale2_array : NULL,
+            do_vif ? &vif_num_scale3_array : NULL, do_vif ? &vif_den_scale3_array : NULL,
+            do_vif ? &vif_array : NULL, psnr_array_ptr, ssim_array_ptr,
+            ms_ssim_array_ptr, errmsg, n_thread, n_subsample,
+            _predict_frame, &ctx);
     if (ret) {
-        throw VmafException(errmsg);
-    }
-    size_t num_frms = motion_array.used;
-    bool num_frms_is_consistent = (adm_num_array.used == num_frms)
-            && (adm_den_array.used == num_frms)
-            && (motion2_array.used == num_frms)
-            && (adm_num_scale0_array.used == num_frms)
-            && (adm_den_scale0_array.used == num_frms)
-            && (adm_num_scale1_array.used == num_frms)
-            && (adm_den_scale1_array.used == num_frms)
-            && (adm_num_scale2_array.used == num_frms)
-            && (adm_den_scale2_array.used == num_frms)
-            && (adm_num_scale3_array.used == num_frms)
-            && (adm_den_scale3_array.used == num_frms)
-            && (vif_num_scale0_array.used == num_frms)
-            && (vif_den_scale0_array.used == num_frms)
-            && (vif_num_scale1_array.used == num_frms)
-            && (vif_den_scale1_array.used == num_frms)
-            && (vif_num_scale2_array.used == num_frms)
-            && (vif_den_scale2_array.used == num_frms)
-            && (vif_num_scale3_array.used == num_frms)
-            && (vif_den_scale3_array.used == num_frms)
-            && (vif_array.used == num_frms);
-    if (psnr_array_ptr != NULL) {
-        num_frms_is_consistent = num_frms_is_consistent
-                && (psnr_array.used == num_frms);
-    }
-    if (ssim_array_ptr != NULL) {
-        num_frms_is_consistent = num_frms_is_consistent
-                && (ssim_array.used == num_frms);
-    }
-    if (ms_ssim_array_ptr != NULL) {
-        num_frms_is_consistent = num_frms_is_consistent
-                && (ms_ssim_array.used == num_frms);
-    }
-    if (!num_frms_is_consistent) {
-        sprintf(errmsg,
-                "Output feature vectors are of inconsistent dimensions: motion (%zu), motion2 (%zu), adm_num (%zu), adm_den (%zu), vif_num_scale0 (%zu), vif_den_scale0 (%zu), vif_num_scale1 (%zu), vif_den_scale1 (%zu), vif_num_scale2 (%zu), vif_den_scale2 (%zu), vif_num_scale3 (%zu), vif_den_scale3 (%zu), vif (%zu), psnr (%zu), ssim (%zu), ms_ssim (%zu), adm_num_scale0 (%zu), adm_den_scale0 (%zu), adm_num_scale1 (%zu), adm_den_scale1 (%zu), adm_num_scale2 (%zu), adm_den_scale2 (%zu), adm_num_scale3 (%zu), adm_den_scale3 (%zu)",
-                motion_array.used, motion2_array.used, adm_num_array.used,
-                adm_den_array.used, vif_num_scale0_array.used,
-                vif_den_scale0_array.used, vif_num_scale1_array.used,
-                vif_den_scale1_array.used, vif_num_scale2_array.used,
-                vif_den_scale2_array.used, vif_num_scale3_array.used,
-                vif_num_scale3_array.used, vif_array.used, psnr_array.used,
-                ssim_array.used, ms_ssim_array.used, adm_num_scale0_array.used,
-                adm_den_scale0_array.used, adm_num_scale1_array.used,
-                adm_den_scale1_array.used, adm_num_scale2_array.used,
-                adm_den_scale2_array.used, adm_num_scale3_array.used,
-                adm_num_scale3_array.used);
-        throw VmafException(errmsg);
-    }
-    dbg_printf(
-            "Generate final features (including derived atom features)...\n");
-    double ADM2_CONSTANT = 0.0;
-    double ADM_SCALE_CONSTANT = 0.0;
-    StatVector adm2, motion, vif_scale0, vif_scale1, vif_scale2, vif_scale3,
-            vif, motion2;
-    StatVector adm_scale0, adm_scale1, adm_scale2, adm_scale3;
-    StatVector psnr, ssim, ms_ssim;
-    std::vector<VmafPredictionStruct> predictionStructs;
-    for (size_t i = 0; i < num_frms; i += n_subsample) {
-        adm2.append(
-                (get_at(&adm_num_array, i) + ADM2_CONSTANT)
-                        / (get_at(&adm_den_array, i) + ADM2_CONSTANT));
-        adm_scale0.append(
-                (get_at(&adm_num_scale0_array, i) + ADM_SCALE_CONSTANT)
-                        / (get_at(&adm_den_scale0_array, i) + ADM_SCALE_CONSTANT));
-        adm_scale1.append(
-                (get_at(&adm_num_scale1_array, i) + ADM_SCALE_CONSTANT)
-                        / (get_at(&adm_den_scale1_array, i) + ADM_SCALE_CONSTANT));
-        adm_scale2.append(
-                (get_at(&adm_num_scale2_array, i) + ADM_SCALE_CONSTANT)
-                        / (get_at(&adm_den_scale2_array, i) + ADM_SCALE_CONSTANT));
-        adm_scale3.append(
-                (get_at(&adm_num_scale3_array, i) + ADM_SCALE_CONSTANT)
-                        / (get_at(&adm_den_scale3_array, i) + ADM_SCALE_CONSTANT));
-        motion.append(get_at(&motion_array, i));
-        motion2.append(get_at(&motion2_array, i));
-        vif_scale0.append(
-                get_at(&vif_num_scale0_array, i)
-                        / get_at(&vif_den_scale0_array, i));
-        vif_scale1.append(
-                get_at(&vif_num_scale1_array, i)
-                        / get_at(&vif_den_scale1_array, i));
-        vif_scale2.append(
-                get_at(&vif_num_scale2_array, i)
-                        / get_at(&vif_den_scale2_array, i));
-        vif_scale3.append(
-                get_at(&vif_num_scale3_array, i)
-                        / get_at(&vif_den_scale3_array, i));
-        vif.append(get_at(&vif_array, i));
-
-        if (psnr_array_ptr != NULL) {
-            psnr.append(get_at(&psnr_array, i));
-        }
-        if (ssim_array_ptr != NULL) {
-            ssim.append(get_at(&ssim_array, i));
-        }
-        if (ms_ssim_array_ptr != NULL) {
-            ms_ssim.append(get_at(&ms_ssim_array, i));
+        if (!ctx.error.empty()) {
+            throw VmafException(ctx.error.c_str());
         }
+        throw VmafException(errmsg);
     }
-    dbg_printf(
-            "Normalize features, SVM regression, denormalize score, clip...\n");
-    size_t num_frms_subsampled = 0;
-    for (size_t i = 0; i < num_frms; i += n_subsample) {
-        num_frms_subsampled++;
-    }
-    _normalize_predict_denormalize_transform_clip(model, num_frms_subsampled,
-            adm2, adm_scale0, adm_scale1, adm_scale2, adm_scale3, motion,
-            vif_scale0, vif_scale1, vif_scale2, vif_scale3, vif, motion2,
-            enable_transform, disable_clip, predictionStructs);
     Result result { };
     for (size_t j = 0; j < model.feature_names.length(); j++) {
 
         if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_adm2_score'") == 0)
-            result.set_scores("adm2", adm2);
+            result.set_scores("adm2", ctx.adm2);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_adm_scale0_score'") == 0)
-            result.set_scores("adm_scale0", adm_scale0);
+            result.set_scores("adm_scale0", ctx.adm_scale0);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_adm_scale1_score'") == 0)
-            result.set_scores("adm_scale1", adm_scale1);
+            result.set_scores("adm_scale1", ctx.adm_scale1);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_adm_scale2_score'") == 0)
-            result.set_scores("adm_scale2", adm_scale2);
+            result.set_scores("adm_scale2", ctx.adm_scale2);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_adm_scale3_score'") == 0)
-            result.set_scores("adm_scale3", adm_scale3);
+            result.set_scores("adm_scale3", ctx.adm_scale3);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_motion_score'") == 0)
-            result.set_scores("motion", motion);
+            result.set_scores("motion", ctx.motion);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_vif_scale0_score'") == 0)
-            result.set_scores("vif_scale0", vif_scale0);
+            result.set_scores("vif_scale0", ctx.vif_scale0);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_vif_scale1_score'") == 0)
-            result.set_scores("vif_scale1", vif_scale1);
+            result.set_scores("vif_scale1", ctx.vif_scale1);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_vif_scale2_score'") == 0)
-            result.set_scores("vif_scale2", vif_scale2);
+            result.set_scores("vif_scale2", ctx.vif_scale2);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_vif_scale3_score'") == 0)
-            result.set_scores("vif_scale3", vif_scale3);
+            result.set_scores("vif_scale3", ctx.vif_scale3);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_vif_score'") == 0)
-            result.set_scores("vif", vif);
+            result.set_scores("vif", ctx.vif);
         else if (strcmp(Stringize(model.feature_names[j]).c_str(),
                 "'VMAF_feature_motion2_score'") == 0)
-            result.set_scores("motion2", motion2);
+            result.set_scores("motion2", ctx.motion2);
         else {
             printf("Unknown feature name: %s.\n",
                     Stringize(model.feature_names[j]).c_str());
@@ -782,16 +843,16 @@ Result VmafQualityRunner::run(Asset asset, int (*read_frame)(float *ref_data, fl
     }
 
     if (psnr_array_ptr != NULL) {
-        result.set_scores("psnr", psnr);
+        result.set_scores("psnr", ctx.psnr);
     }
     if (ssim_array_ptr != NULL) {
-        result.set_scores("ssim", ssim);
+        result.set_scores("ssim", ctx.ssim);
     }
     if (ms_ssim_array_ptr != NULL) {
-        result.set_scores("ms_ssim", ms_ssim);
+        result.set_scores("ms_ssim", ctx.ms_ssim);
     }
 
-    _set_prediction_result(predictionStructs, result);
+    _set_prediction_result(ctx.predictionStructs, result);
 
     free_array(&adm_num_array);
     free_array(&adm_den_array);
@@ -949,6 +1010,17 @@ void BootstrapVmafQualityRunner::_set_prediction_result(
 
 static const char VMAFOSS_DOC_VERSION[] = "1.3.15";
 
+static int _feature_log_score(void *ctx, unsigned j, unsigned i, double *score)
+{
+    std::vector<std::vector<double> > *columns = (std::vector<std::vector<double> > *)ctx;
+    if (j >= columns->size() || i >= (*columns)[j].size())
+    {
+        return -1;
+    }
+    *score = (*columns)[j][i];
+    return 0;
+}
+
 double RunVmaf(const char* fmt, int width, int height,
                int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data),
                void *user_data, const char *model_path, const char *log_path, const char *log_fmt,
@@ -1144,6 +1216,36 @@ double RunVmaf(const char* fmt, int width, int height,
 		}
 		fclose(csv);
 	}
+    else if (log_path != NULL && log_fmt != NULL && (strcmp(log_fmt, "bin") == 0))
+    {
+        /* output to columnar binary, one contiguous float64 array per metric */
+
+        std::vector<const char *> names;
+        std::vector<std::vector<double> > columns;
+        for (size_t j=0; j<result_keys.size(); j++)
+        {
+            names.push_back(result_keys[j].c_str());
+            columns.push_back(result.get_scores(result_keys[j]).getVector());
+        }
+        std::vector<unsigned> frame_nums;
+        for (size_t i_subsampled=0; i_subsampled<num_frames_subsampled; i_subsampled++)
+        {
+            frame_nums.push_back(i_subsampled * n_subsample);
+        }
+
+        FILE *bin = fopen(log_path, "wb");
+        if (!bin)
+        {
+            throw VmafException("Could not open log file for writing");
+        }
+        int err = vmaf_feature_log_write(bin, names.data(), names.size(),
+                frame_nums.data(), frame_nums.size(), _feature_log_score, &columns);
+        err |= fclose(bin);
+        if (err)
+        {
+            throw VmafException("Error writing binary log file");
+        }
+    }
     else if (log_path != NULL)
     {
         /* output to xml */
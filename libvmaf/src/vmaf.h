@@ -84,6 +84,7 @@ public:
     size_t size();
 private:
     std::vector<double> l;
+    std::vector<double> sorted; // cache for percentile()
     void _assert_size();
 };
 
@@ -139,6 +140,10 @@ struct SvmDelete {
     void operator()(void *svm);
 };
 
+struct SvmBatchDelete {
+    void operator()(void *svm_batch);
+};
+
 enum VmafPredictionReturnType
 {
     SCORE,
@@ -191,6 +196,7 @@ public:
     virtual ~BootstrapLibsvmNusvrTrainTestModel() {}
 private:
     std::vector<std::unique_ptr<svm_model, SvmDelete>> bootstrap_svm_model_ptrs;
+    std::unique_ptr<svm_model_batch, SvmBatchDelete> svm_model_batch_ptr;
     std::string _get_model_i_filename(const char* model_path, int i_model);
     void _read_and_assert_model(const char *model_path, Val& feature_names, Val& norm_type, Val& slopes,
             Val& intercepts, Val& score_clip, Val& score_transform, int& numModels);
@@ -219,14 +225,7 @@ private:
     virtual void _transform_score(LibsvmNusvrTrainTestModel& model, VmafPredictionStruct& predictionStruct);
     virtual void _clip_score(LibsvmNusvrTrainTestModel& model, VmafPredictionStruct& predictionStruct);
     virtual void _postproc_transform_clip(VmafPredictionStruct& predictionStruct);
-    void _normalize_predict_denormalize_transform_clip(LibsvmNusvrTrainTestModel& model,
-            size_t num_frms, StatVector& adm2,
-            StatVector& adm_scale0, StatVector& adm_scale1,
-            StatVector& adm_scale2, StatVector& adm_scale3, StatVector& motion,
-            StatVector& vif_scale0, StatVector& vif_scale1,
-            StatVector& vif_scale2, StatVector& vif_scale3, StatVector& vif,
-            StatVector& motion2, bool enable_transform, bool disable_clip,
-            std::vector<VmafPredictionStruct>& predictionStructs);
+    static int _predict_frame(int frm_idx, void *user_data);
 };
 
 class BootstrapVmafQualityRunner: public VmafQualityRunner
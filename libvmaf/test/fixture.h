@@ -0,0 +1,47 @@
+#ifndef __VMAF_TEST_FIXTURE_H__
+#define __VMAF_TEST_FIXTURE_H__
+
+#include <stdbool.h>
+
+#include "libvmaf/libvmaf.rc.h"
+#include "libvmaf/model.h"
+#include "libvmaf/picture.h"
+
+/*
+ * Synthetic pictures for tests: an 8-bit yuv420p texture selected by
+ * `pattern`, with a pixel-dependent distortion of `strength` added.
+ * The same pattern and strength always give the same picture.
+ */
+int fixture_picture(VmafPicture *pic, unsigned w, unsigned h,
+                    unsigned pattern, unsigned strength);
+
+#define FIXTURE_MAX_PICS 160
+#define FIXTURE_MAX_FEATURES 8
+
+/*
+ * Frame scores collected by fixture_log_frame_score(), the features of the
+ * model in model order. Model feature names outlive the run.
+ */
+typedef struct {
+    double score[FIXTURE_MAX_PICS];
+    double feature[FIXTURE_MAX_PICS][FIXTURE_MAX_FEATURES];
+    const char *name[FIXTURE_MAX_FEATURES];
+    bool delivered[FIXTURE_MAX_PICS];
+    unsigned n_features, cnt;
+} FixtureScores;
+
+void fixture_log_frame_score(void *user_data, const VmafFrameScore *fs);
+
+/*
+ * Scores cnt pictures w x h with the features of model. Picture i pairs
+ * the reference of pattern pair[i][0] with the distorted picture of pattern
+ * pair[i][1] and strength, pair NULL uses pattern i for both.
+ */
+int fixture_score(VmafModel *model, VmafConfiguration cfg, unsigned w,
+                  unsigned h, const unsigned (*pair)[2], unsigned cnt,
+                  unsigned strength, FixtureScores *s);
+
+// index of the model feature whose name contains key, or -1
+int fixture_feature_index(const FixtureScores *s, const char *key);
+
+#endif /* __VMAF_TEST_FIXTURE_H__ */
@@ -0,0 +1,23 @@
+#include <stdint.h>
+
+#include "fixture.h"
+
+int fixture_picture(VmafPicture *pic, unsigned w, unsigned h,
+                    unsigned pattern, unsigned strength)
+{
+    int err = vmaf_picture_alloc(pic, VMAF_PIX_FMT_YUV420P, 8, w, h);
+    if (err) return err;
+
+    for (unsigned p = 0; p < 3; p++) {
+        uint8_t *data = pic->data[p];
+        for (unsigned i = 0; i < pic->h[p]; i++) {
+            for (unsigned j = 0; j < pic->w[p]; j++) {
+                unsigned v = (i * i * 7 + j * 13 + (i * j) % 17 + pattern * 5)
+                             % 200 + 20;
+                v += ((i * 31 + j * 17 + pattern) % 11) * strength / 4;
+                data[i * pic->stride[p] + j] = v > 255 ? 255 : v;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "fixture.h"
+
+void fixture_log_frame_score(void *user_data, const VmafFrameScore *fs)
+{
+    FixtureScores *s = user_data;
+    if (fs->index >= FIXTURE_MAX_PICS) return;
+    if (fs->n_features > FIXTURE_MAX_FEATURES) return;
+
+    s->score[fs->index] = fs->score;
+    for (unsigned i = 0; i < fs->n_features; i++) {
+        s->feature[fs->index][i] = fs->feature[i].value;
+        s->name[i] = fs->feature[i].name;
+    }
+    s->n_features = fs->n_features;
+    s->delivered[fs->index] = true;
+    s->cnt++;
+}
+
+int fixture_score(VmafModel *model, VmafConfiguration cfg, unsigned w,
+                  unsigned h, const unsigned (*pair)[2], unsigned cnt,
+                  unsigned strength, FixtureScores *s)
+{
+    int err = 0;
+    memset(s, 0, sizeof(*s));
+
+    VmafContext *vmaf;
+    err = vmaf_init(&vmaf, cfg);
+    if (err) return err;
+    err = vmaf_use_features_from_model(vmaf, model);
+    if (err) goto close;
+    err = vmaf_register_score_callback(vmaf, model, fixture_log_frame_score,
+                                       s);
+    if (err) goto close;
+
+    for (unsigned i = 0; i < cnt; i++) {
+        VmafPicture ref, dist;
+        err = fixture_picture(&ref, w, h, pair ? pair[i][0] : i, 0);
+        if (err) goto close;
+        err = fixture_picture(&dist, w, h, pair ? pair[i][1] : i, strength);
+        if (err) {
+            vmaf_picture_unref(&ref);
+            goto close;
+        }
+        err = vmaf_read_pictures(vmaf, &ref, &dist, i);
+        if (err) goto close;
+    }
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+
+close:
+    err |= vmaf_close(vmaf);
+    return err;
+}
+
+int fixture_feature_index(const FixtureScores *s, const char *key)
+{
+    for (unsigned i = 0; i < s->n_features; i++) {
+        if (strstr(s->name[i], key)) return i;
+    }
+    return -1;
+}
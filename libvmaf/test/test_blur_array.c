@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "feature/common/blur_array.c"
+
+#define BUF_SZ 64
+#define ARRAY_LENGTH 4
+
+static char *test_blur_array_ring()
+{
+    BLUR_BUF_ARRAY arr;
+    int ok = init_blur_array(&arr, ARRAY_LENGTH, BUF_SZ * sizeof(float), MAX_ALIGN);
+    mu_assert("problem during init_blur_array", ok);
+
+    float *buf[ARRAY_LENGTH + 1];
+    for (int i = 0; i < ARRAY_LENGTH; i++) {
+        buf[i] = get_free_blur_buf_slot(&arr, i);
+        mu_assert("problem during get_free_blur_buf_slot", buf[i]);
+        mu_assert("a claimed slot should hold one reference",
+                  get_blur_buf_reference_count(&arr, i) == 1);
+    }
+    mu_assert("a slot should not be claimed twice",
+              !get_free_blur_buf_slot(&arr, 0));
+    mu_assert("the slot of a frame should be busy until released",
+              !get_free_blur_buf_slot(&arr, ARRAY_LENGTH));
+    mu_assert("an unknown frame should not be found",
+              !get_blur_buf(&arr, ARRAY_LENGTH));
+    mu_assert("an unknown frame should have no reference count",
+              get_blur_buf_reference_count(&arr, ARRAY_LENGTH) == -1);
+
+    mu_assert("get_blur_buf should return the slot buffer",
+              get_blur_buf(&arr, 0) == buf[0]);
+    mu_assert("get_blur_buf should take a reference",
+              get_blur_buf_reference_count(&arr, 0) == 2);
+    release_blur_buf_reference(&arr, 0);
+    mu_assert("a referenced slot should not be released",
+              release_blur_buf_slot(&arr, 0) == -1);
+    release_blur_buf_reference(&arr, 0);
+    mu_assert("releasing the last reference should fail",
+              release_blur_buf_reference(&arr, 0) == -1);
+    mu_assert("problem during release_blur_buf_slot",
+              release_blur_buf_slot(&arr, 0) == 1);
+    mu_assert("a released frame should not be found",
+              !get_blur_buf(&arr, 0));
+
+    buf[ARRAY_LENGTH] = get_free_blur_buf_slot(&arr, ARRAY_LENGTH);
+    mu_assert("a frame should reuse the slot of frame - length",
+              buf[ARRAY_LENGTH] == buf[0]);
+
+    float data[BUF_SZ];
+    for (int j = 0; j < BUF_SZ; j++)
+        data[j] = j;
+    release_blur_buf_reference(&arr, 1);
+    mu_assert("problem during release_blur_buf_slot",
+              release_blur_buf_slot(&arr, 1) == 1);
+    ok = put_blur_buf(&arr, ARRAY_LENGTH + 1, data);
+    mu_assert("problem during put_blur_buf", ok);
+    mu_assert("put_blur_buf should not hold a reference",
+              get_blur_buf_reference_count(&arr, ARRAY_LENGTH + 1) == 0);
+    mu_assert("put_blur_buf should copy the data",
+              !memcmp(buf[1], data, sizeof(data)));
+
+    free_blur_buf(&arr);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_blur_array_ring);
+    return NULL;
+}
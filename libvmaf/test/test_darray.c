@@ -0,0 +1,81 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "test.h"
+#include "darray.c"
+
+#define INIT_SIZE 4
+#define N_THREADS 4
+#define N_FRAMES 1000
+
+static char *test_darray_chunked_growth()
+{
+    DArray a;
+    int err = init_array(&a, INIT_SIZE);
+    mu_assert("problem during init_array", !err && a.chunks);
+    mu_assert("a new array should be empty", get_used(&a) == 0);
+
+    insert_array_at(&a, 1.0, 0);
+    double *first = get_element(&a, 0, false);
+    for (int i = 1; i < 100; i++)
+        insert_array_at(&a, i + 1.0, i);
+    mu_assert("get_used should be one past the last position",
+              get_used(&a) == 100);
+    mu_assert("growing should not move existing elements",
+              get_element(&a, 0, false) == first);
+    for (int i = 0; i < 100; i++)
+        mu_assert("problem during get_at", get_at(&a, i) == i + 1.0);
+
+    insert_array_at(&a, 5.0, 200);
+    mu_assert("get_used should follow the largest position",
+              get_used(&a) == 201);
+    mu_assert("a position that was never written should read as 0",
+              get_at(&a, 150) == 0.0);
+    mu_assert("a position past the end should read as 0",
+              get_at(&a, 100000) == 0.0);
+
+    insert_array(&a, 7.0);
+    mu_assert("insert_array should append", get_at(&a, 201) == 7.0);
+
+    free_array(&a);
+    return NULL;
+}
+
+static DArray shared;
+
+static void *insert_frames(void *arg)
+{
+    int t = *(int *)arg;
+    for (int i = t; i < N_FRAMES; i += N_THREADS)
+        insert_array_at(&shared, i, i);
+    return NULL;
+}
+
+static char *test_darray_concurrent_insert()
+{
+    pthread_t thread[N_THREADS];
+    int t_idx[N_THREADS];
+
+    int err = init_array(&shared, 1);
+    mu_assert("problem during init_array", !err);
+    for (int t = 0; t < N_THREADS; t++) {
+        t_idx[t] = t;
+        pthread_create(&thread[t], NULL, insert_frames, &t_idx[t]);
+    }
+    for (int t = 0; t < N_THREADS; t++)
+        pthread_join(thread[t], NULL);
+
+    mu_assert("get_used should count all frames", get_used(&shared) == N_FRAMES);
+    for (int i = 0; i < N_FRAMES; i++)
+        mu_assert("concurrent inserts should all land", get_at(&shared, i) == i);
+
+    free_array(&shared);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_darray_chunked_growth);
+    mu_run_test(test_darray_concurrent_insert);
+    return NULL;
+}
@@ -0,0 +1,80 @@
+#include <errno.h>
+
+#include "test.h"
+#include "fixture.h"
+
+#define W 128
+#define H 96
+#define N_PICS 4
+#define N_DIST 3
+
+static int score_separately(VmafModel *model, unsigned strength,
+                            FixtureScores *s)
+{
+    VmafConfiguration cfg = { 0 };
+    return fixture_score(model, cfg, W, H, NULL, N_PICS, strength, s);
+}
+
+static char *test_distorted_stream()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    VmafContext *vmaf, *stream[N_DIST];
+    VmafConfiguration cfg = { 0 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+    err = vmaf_use_features_from_model(vmaf, model);
+    mu_assert("problem during vmaf_use_features_from_model", !err);
+
+    stream[0] = vmaf;
+    for (unsigned i = 1; i < N_DIST; i++) {
+        err = vmaf_register_distorted_stream(vmaf, &stream[i]);
+        mu_assert("problem during vmaf_register_distorted_stream", !err);
+    }
+    err = vmaf_register_distorted_stream(stream[1], &stream[0]);
+    mu_assert("a stream can not have streams", err == -EINVAL);
+
+    for (unsigned i = 0; i < N_PICS; i++) {
+        VmafPicture ref, dist[N_DIST], *d[N_DIST];
+        err = fixture_picture(&ref, W, H, i, 0);
+        for (unsigned j = 0; j < N_DIST; j++) {
+            err |= fixture_picture(&dist[j], W, H, i, 2 * j + 1);
+            d[j] = &dist[j];
+        }
+        mu_assert("problem during vmaf_picture_alloc", !err);
+        err = vmaf_read_pictures_multi(vmaf, &ref, d, N_DIST, i);
+        mu_assert("problem during vmaf_read_pictures_multi", !err);
+    }
+    err = vmaf_read_pictures(stream[1], NULL, NULL, 0);
+    mu_assert("problem during vmaf_read_pictures flush", !err);
+
+    for (unsigned j = 0; j < N_DIST; j++) {
+        static FixtureScores expected;
+        err = score_separately(model, 2 * j + 1, &expected);
+        mu_assert("problem during separate scoring", !err);
+        for (unsigned i = 0; i < N_PICS; i++) {
+            double score;
+            err = vmaf_score_at_index(stream[j], model, &score, i);
+            mu_assert("problem during vmaf_score_at_index", !err);
+            mu_assert("shared reference changed the score",
+                      score == expected.score[i]);
+        }
+    }
+
+    err = vmaf_close(stream[1]);
+    mu_assert("a stream is closed with its parent", err == -EINVAL);
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_distorted_stream);
+    return NULL;
+}
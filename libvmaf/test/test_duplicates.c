@@ -0,0 +1,125 @@
+#include <string.h>
+
+#include "test.h"
+#include "fixture.h"
+
+#define W 64
+#define H 64
+
+static int score(VmafModel *model, unsigned n_subsample,
+                 const unsigned (*pair)[2], unsigned cnt, FixtureScores *s)
+{
+    VmafConfiguration cfg = { .n_subsample = n_subsample };
+    return fixture_score(model, cfg, W, H, pair, cnt, 5, s);
+}
+
+// the spatial features of picture index of s match those of pair scored alone
+static int matches_pair(VmafModel *model, const FixtureScores *s,
+                        unsigned index, const unsigned pair[2])
+{
+    static FixtureScores alone;
+    const unsigned p[1][2] = { { pair[0], pair[1] } };
+    if (score(model, 0, p, 1, &alone)) return 0;
+    if (!s->delivered[index] || alone.n_features != s->n_features) return 0;
+    for (unsigned i = 0; i < s->n_features; i++) {
+        if (strstr(s->name[i], "motion")) continue;
+        if (s->feature[index][i] != alone.feature[0][i]) return 0;
+    }
+    return 1;
+}
+
+static char *test_duplicates()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    // pairs sharing only their reference or their distorted picture
+    // are not duplicates of each other
+    const unsigned pair[][2] = {
+        { 0, 0 }, { 0, 1 }, { 1, 0 }, { 0, 0 }, { 1, 1 }, { 0, 1 }, { 0, 0 },
+        { 1, 0 }, { 1, 1 },
+    };
+    const unsigned cnt = sizeof(pair) / sizeof(pair[0]);
+    static FixtureScores s;
+    err = score(model, 0, pair, cnt, &s);
+    mu_assert("problem during score", !err);
+    mu_assert("every picture should be scored", s.cnt == cnt);
+    for (unsigned i = 0; i < cnt; i++) {
+        mu_assert("reused scores should match scoring the pair alone",
+                  matches_pair(model, &s, i, pair[i]));
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+static char *test_duplicates_grow()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    // enough distinct pairs to grow the table past its first capacity,
+    // followed by repeats of the first ones
+    static unsigned pair[FIXTURE_MAX_PICS][2];
+    const unsigned distinct = 140;
+    for (unsigned i = 0; i < FIXTURE_MAX_PICS; i++)
+        pair[i][0] = pair[i][1] = i < distinct ? i : i - distinct;
+    static FixtureScores s;
+    err = score(model, 0, (const unsigned (*)[2]) pair, FIXTURE_MAX_PICS,
+                &s);
+    mu_assert("problem during score", !err);
+    mu_assert("every picture should be scored", s.cnt == FIXTURE_MAX_PICS);
+    for (unsigned i = distinct; i < FIXTURE_MAX_PICS; i++) {
+        mu_assert("repeats should match scoring the pair alone",
+                  matches_pair(model, &s, i, pair[i]));
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+static char *test_duplicates_subsample()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    // with n_subsample 2 the odd pictures are skipped: the first occurrence
+    // of { 1, 1 } is skipped, and so is a repeat of { 0, 0 }
+    const unsigned pair[][2] = {
+        { 0, 0 }, { 1, 1 }, { 1, 1 }, { 0, 0 }, { 0, 0 }, { 1, 1 }, { 1, 1 },
+    };
+    const unsigned cnt = sizeof(pair) / sizeof(pair[0]);
+    static FixtureScores s;
+    err = score(model, 2, pair, cnt, &s);
+    mu_assert("problem during score", !err);
+    mu_assert("only the even pictures should be scored", s.cnt == 4);
+    for (unsigned i = 0; i < cnt; i++) {
+        if (i % 2) {
+            mu_assert("skipped picture should not be scored",
+                      !s.delivered[i]);
+            continue;
+        }
+        mu_assert("subsampled scores should match scoring the pair alone",
+                  matches_pair(model, &s, i, pair[i]));
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_duplicates);
+    mu_run_test(test_duplicates_grow);
+    mu_run_test(test_duplicates_subsample);
+    return NULL;
+}
@@ -0,0 +1,141 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "picture.c"
+#include "feature/feature_cache.c"
+
+static const char *provided_features[] = { "a", "b", NULL };
+
+static VmafFeatureExtractor fex = {
+    .name = "test",
+    .version = "1.0",
+    .provided_features = provided_features,
+};
+
+static void cache_path(char *path, size_t sz, const char *dir)
+{
+    snprintf(path, sz, "%s/%s-%s.vfc", dir, fex.name, fex.version);
+}
+
+// drops the last n bytes of the file at path
+static int drop_tail(const char *path, size_t n)
+{
+    uint8_t buf[1024];
+    FILE *file = fopen(path, "rb");
+    if (!file) return -EIO;
+    const size_t sz = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+    if (sz < n) return -EINVAL;
+    file = fopen(path, "wb");
+    if (!file) return -EIO;
+    const size_t written = fwrite(buf, 1, sz - n, file);
+    fclose(file);
+    return written == sz - n ? 0 : -EIO;
+}
+
+static char *test_feature_cache()
+{
+    int err;
+    double score[2];
+    const uint64_t hash[2][6] = { { 1, 2, 3, 4, 5, 6 }, { 1, 2, 3, 4, 5, 7 } };
+
+    char dir[64];
+    snprintf(dir, sizeof(dir), "/tmp/vmaf_feature_cache_%ld", (long) getpid());
+    mu_assert("problem creating temporary directory", !mkdir(dir, 0700));
+    char path[256];
+    cache_path(path, sizeof(path), dir);
+
+    VmafFeatureCache *cache;
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[0], score);
+    mu_assert("empty cache should not have scores", err);
+    err = vmaf_feature_cache_put(cache, &fex, hash[0],
+                                 (double[]) { 1. / 3., 2. / 3. });
+    mu_assert("problem during vmaf_feature_cache_put", !err);
+    err = vmaf_feature_cache_write(cache);
+    mu_assert("problem during vmaf_feature_cache_write", !err);
+    vmaf_feature_cache_destroy(cache);
+
+    // scores are appended by later runs
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[0], score);
+    mu_assert("cached score missing", !err);
+    mu_assert("cached score not bit-exact",
+              score[0] == 1. / 3. && score[1] == 2. / 3.);
+    err = vmaf_feature_cache_get(cache, &fex, hash[1], score);
+    mu_assert("score served for a different picture", err);
+    err = vmaf_feature_cache_put(cache, &fex, hash[1],
+                                 (double[]) { 4., 5. });
+    mu_assert("problem during vmaf_feature_cache_put", !err);
+    err = vmaf_feature_cache_write(cache);
+    mu_assert("problem during vmaf_feature_cache_write", !err);
+    vmaf_feature_cache_destroy(cache);
+
+    // an interrupted write only loses the broken record
+    FILE *file = fopen(path, "r+b");
+    mu_assert("problem opening cache file", file);
+    fseek(file, -1, SEEK_END);
+    const int c = fgetc(file);
+    fseek(file, -1, SEEK_END);
+    fputc(c ^ 0xff, file);
+    fclose(file);
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[0], score);
+    mu_assert("cached score missing", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[1], score);
+    mu_assert("broken record should not be served", err);
+    vmaf_feature_cache_destroy(cache);
+
+    // as does an interrupted append, later records stay aligned
+    mu_assert("problem truncating cache file", !drop_tail(path, 5));
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[1], score);
+    mu_assert("partial record should not be served", err);
+    err = vmaf_feature_cache_put(cache, &fex, hash[1],
+                                 (double[]) { 4., 5. });
+    mu_assert("problem during vmaf_feature_cache_put", !err);
+    err = vmaf_feature_cache_write(cache);
+    mu_assert("problem during vmaf_feature_cache_write", !err);
+    vmaf_feature_cache_destroy(cache);
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[0], score);
+    mu_assert("cached score missing", !err);
+    err = vmaf_feature_cache_get(cache, &fex, hash[1], score);
+    mu_assert("score appended after a partial record missing",
+              !err && score[0] == 4. && score[1] == 5.);
+    vmaf_feature_cache_destroy(cache);
+
+    // other versions have their own file
+    VmafFeatureExtractor fex2 = fex;
+    fex2.version = "2.0";
+    err = vmaf_feature_cache_init(&cache, dir);
+    mu_assert("problem during vmaf_feature_cache_init", !err);
+    err = vmaf_feature_cache_get(cache, &fex2, hash[0], score);
+    mu_assert("score served for another version", err);
+    vmaf_feature_cache_destroy(cache);
+
+    // temporal extractors are not cached
+    fex2.version = fex.version;
+    fex2.flags = VMAF_FEATURE_EXTRACTOR_TEMPORAL;
+    mu_assert("temporal extractor should not be cached",
+              !vmaf_feature_cache_score_cnt(&fex2));
+
+    unlink(path);
+    rmdir(dir);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_feature_cache);
+    return NULL;
+}
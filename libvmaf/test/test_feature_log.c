@@ -0,0 +1,98 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "feature_log.c"
+
+static const double score[2][3] = {
+    { 0.25, 1. / 3., 12345.678901234567 },
+    { -1.5, 0., 1e-300 },
+};
+
+static int get_score(void *ctx, unsigned j, unsigned i, double *s)
+{
+    (void) ctx;
+    if (j == 1 && i == 1) return -1; // missing score
+    *s = score[j][i];
+    return 0;
+}
+
+static uint64_t read_le(const uint8_t *buf, unsigned n)
+{
+    uint64_t v = 0;
+    for (unsigned i = 0; i < n; i++)
+        v |= (uint64_t) buf[i] << (8 * i);
+    return v;
+}
+
+static char *test_feature_log_write()
+{
+    int err;
+
+    FILE *log = tmpfile();
+    mu_assert("problem creating temporary file", log);
+    const char *name[] = { "adm2", "motion2" };
+    const unsigned frame_num[] = { 0, 2, 4 };
+    err = vmaf_feature_log_write(log, name, 2, frame_num, 3, get_score, NULL);
+    mu_assert("problem during vmaf_feature_log_write", !err);
+
+    uint8_t buf[1024];
+    rewind(log);
+    const size_t sz = fread(buf, 1, sizeof(buf), log);
+    fclose(log);
+
+    mu_assert("bad magic", !memcmp(buf, "VMAFCOL", 8));
+    mu_assert("bad version", read_le(buf + 8, 4) == VMAF_FEATURE_LOG_VERSION);
+    mu_assert("bad feature count", read_le(buf + 12, 4) == 2);
+    mu_assert("bad frame count", read_le(buf + 16, 8) == 3);
+    const uint64_t data_offset = read_le(buf + 24, 8);
+    mu_assert("data should be aligned",
+              data_offset == 192 && !(data_offset % VMAF_FEATURE_LOG_ALIGN));
+    mu_assert("bad file size", sz == data_offset + 3 * 8 + 2 * 3 * 8);
+    mu_assert("bad feature name", !strcmp((char *) buf + 32, "adm2"));
+    mu_assert("bad feature name", !strcmp((char *) buf + 32 + 64, "motion2"));
+
+    for (unsigned i = 0; i < 3; i++) {
+        mu_assert("bad frame number",
+                  read_le(buf + data_offset + 8 * i, 8) == frame_num[i]);
+    }
+    const uint8_t *column = buf + data_offset + 3 * 8;
+    for (unsigned j = 0; j < 2; j++) {
+        for (unsigned i = 0; i < 3; i++) {
+            const uint64_t u = read_le(column + 8 * (3 * j + i), 8);
+            double s;
+            memcpy(&s, &u, sizeof(s));
+            if (j == 1 && i == 1)
+                mu_assert("missing scores should be NaN", isnan(s));
+            else
+                mu_assert("scores should round-trip exactly", s == score[j][i]);
+        }
+    }
+
+    return NULL;
+}
+
+static char *test_feature_log_invalid_name()
+{
+    FILE *log = tmpfile();
+    mu_assert("problem creating temporary file", log);
+    char long_name[VMAF_FEATURE_LOG_NAME_SIZE + 1];
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    const char *name[] = { long_name };
+    const unsigned frame_num[] = { 0 };
+    int err = vmaf_feature_log_write(log, name, 1, frame_num, 1, get_score,
+                                     NULL);
+    mu_assert("feature names that do not fit should fail", err);
+    fclose(log);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_feature_log_write);
+    mu_run_test(test_feature_log_invalid_name);
+    return NULL;
+}
@@ -0,0 +1,65 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "feature/frame_cache.c"
+
+#define FRAME_SZ 256
+#define FRAME_CNT 10
+
+static char *check_frame_cache(size_t mem_limit)
+{
+    int err;
+
+    FrameCache *cache;
+    err = frame_cache_init(&cache, FRAME_SZ * sizeof(float), mem_limit);
+    mu_assert("problem during frame_cache_init", !err);
+
+    float frame[FRAME_SZ];
+    for (unsigned i = 0; i < FRAME_CNT; i++) {
+        for (unsigned j = 0; j < FRAME_SZ; j++)
+            frame[j] = i * FRAME_SZ + j;
+        err = frame_cache_append(cache, frame);
+        mu_assert("problem during frame_cache_append", !err);
+    }
+    mu_assert("frames should not be readable before sealing",
+              !frame_cache_get(cache, 0));
+
+    err = frame_cache_seal(cache);
+    mu_assert("problem during frame_cache_seal", !err);
+    err = frame_cache_append(cache, frame);
+    mu_assert("appending to a sealed cache should fail", err);
+    mu_assert("bad frame count", frame_cache_count(cache) == FRAME_CNT);
+
+    for (unsigned i = 0; i < FRAME_CNT; i++) {
+        const float *f = frame_cache_get(cache, i);
+        mu_assert("problem during frame_cache_get", f);
+        for (unsigned j = 0; j < FRAME_SZ; j++)
+            mu_assert("cached frame does not match", f[j] == i * FRAME_SZ + j);
+    }
+    mu_assert("frames past the end should not be readable",
+              !frame_cache_get(cache, FRAME_CNT));
+
+    frame_cache_destroy(cache);
+    return NULL;
+}
+
+static char *test_frame_cache_in_memory()
+{
+    return check_frame_cache(FRAME_CNT * FRAME_SZ * sizeof(float));
+}
+
+static char *test_frame_cache_spill()
+{
+    // spills after the third frame
+    return check_frame_cache(3 * FRAME_SZ * sizeof(float));
+}
+
+char *run_tests()
+{
+    mu_run_test(test_frame_cache_in_memory);
+    mu_run_test(test_frame_cache_spill);
+    return NULL;
+}
@@ -25,8 +25,28 @@ static char *test_model_load_and_destroy()
     return NULL;
 }
 
+static char *test_bootstrap_model_load_and_destroy()
+{
+    int err;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model,
+                    "../../model/vmaf_b_v0.6.3/vmaf_b_v0.6.3.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+    mu_assert("model should be of type VMAF_MODEL_BOOTSTRAP_SVM_NUSVR",
+              model->type == VMAF_MODEL_BOOTSTRAP_SVM_NUSVR);
+    mu_assert("bootstrap model should contain 21 models",
+              model->bootstrap.n_models == 21);
+    mu_assert("bootstrap model batch was not created", model->bootstrap.batch);
+
+    vmaf_model_destroy(model);
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_model_load_and_destroy);
+    mu_run_test(test_bootstrap_model_load_and_destroy);
     return NULL;
 }
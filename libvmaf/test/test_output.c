@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "model.h"
+#include "libvmaf/libvmaf.rc.h"
+
+static const double feature_value[] = { 0.97, 6.9, 0.51, 0.90, 0.94, 0.99 };
+
+static int import_features(VmafContext *vmaf, VmafModel *model,
+                           unsigned index, unsigned lo, unsigned hi)
+{
+    int err = 0;
+    for (unsigned i = lo; i < hi; i++) {
+        err |= vmaf_import_feature_score(vmaf, model->feature[i].name,
+                                         feature_value[i % 6], index);
+    }
+    return err;
+}
+
+static unsigned line_cnt(FILE *f)
+{
+    fflush(f);
+    rewind(f);
+    unsigned cnt = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF)
+        cnt += c == '\n';
+    fseek(f, 0, SEEK_END);
+    return cnt;
+}
+
+static char *test_output_csv_streaming()
+{
+    int err = 0;
+
+    VmafContext *vmaf;
+    VmafConfiguration cfg = { 0 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    FILE *outfile = tmpfile();
+    mu_assert("problem creating temporary file", outfile);
+    err = vmaf_register_output(vmaf, outfile, VMAF_OUTPUT_FORMAT_CSV, model);
+    mu_assert("problem during vmaf_register_output", !err);
+    err = vmaf_register_output(vmaf, outfile, VMAF_OUTPUT_FORMAT_CSV, model);
+    mu_assert("registering a second output should fail", err);
+
+    // frame 1 completes before frame 0, frames have to be written in order
+    const unsigned last = model->n_features - 1;
+    err  = import_features(vmaf, model, 1, 0, last + 1);
+    err |= import_features(vmaf, model, 0, 0, last);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("incomplete frame was written", line_cnt(outfile) == 0);
+    err = import_features(vmaf, model, 0, last, last + 1);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("complete frames were not written", line_cnt(outfile) == 3);
+
+    // incomplete frames are written with the available features on flush
+    err = import_features(vmaf, model, 2, 0, last);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("incomplete frame was written", line_cnt(outfile) == 3);
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    mu_assert("problem during vmaf_read_pictures flush", !err);
+    mu_assert("incomplete frame was not written on flush",
+              line_cnt(outfile) == 4);
+
+    char line[1024];
+    rewind(outfile);
+    mu_assert("problem reading csv header", fgets(line, sizeof(line), outfile));
+    mu_assert("csv header should start with the frame number",
+              !strncmp(line, "Frame,", 6));
+    mu_assert("csv header should contain the model score", strstr(line, "vmaf,"));
+
+    double score;
+    err = vmaf_score_at_index(vmaf, model, &score, 1);
+    mu_assert("problem during vmaf_score_at_index", !err);
+    mu_assert("problem reading csv row", fgets(line, sizeof(line), outfile));
+    mu_assert("problem reading csv row", fgets(line, sizeof(line), outfile));
+    char expected[32];
+    snprintf(expected, sizeof(expected), ",%.6f,\n", score);
+    mu_assert("csv row should end with the model score",
+              strlen(line) > strlen(expected) &&
+              !strcmp(line + strlen(line) - strlen(expected), expected));
+
+    fclose(outfile);
+    vmaf_model_destroy(model);
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+    return NULL;
+}
+
+static char *test_output_json()
+{
+    int err = 0;
+
+    VmafContext *vmaf;
+    VmafConfiguration cfg = { 0 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+
+    err  = vmaf_import_feature_score(vmaf, "float_psnr", 30.5, 0);
+    err |= vmaf_import_feature_score(vmaf, "float_psnr", 31.5, 1);
+    err |= vmaf_import_feature_score(vmaf, "float_ssim", 0.5, 1);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+
+    FILE *outfile = tmpfile();
+    mu_assert("problem creating temporary file", outfile);
+    err = vmaf_write_output(vmaf, outfile, VMAF_OUTPUT_FORMAT_JSON);
+    mu_assert("problem during vmaf_write_output", !err);
+
+    char buf[1024];
+    rewind(outfile);
+    const size_t sz = fread(buf, 1, sizeof(buf) - 1, outfile);
+    buf[sz] = '\0';
+    mu_assert("json output should list every frame",
+              strstr(buf, "\"frameNum\": 0") && strstr(buf, "\"frameNum\": 1"));
+    mu_assert("json output should contain the feature scores",
+              strstr(buf, "\"float_psnr\": 31.500000,") &&
+              strstr(buf, "\"float_ssim\": 0.500000\n"));
+    mu_assert("json output should be terminated",
+              sz >= 4 && !strcmp(buf + sz - 4, "]\n}\n"));
+
+    fclose(outfile);
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_output_csv_streaming);
+    mu_run_test(test_output_json);
+    return NULL;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+
+#include "test.h"
+#include "feature/feature_collector.c"
+#include "partial.c"
+
+static char *test_partial_write_and_read()
+{
+    int err;
+
+    VmafFeatureCollector *shard;
+    err = vmaf_feature_collector_init(&shard);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    // picture 0 and 4 are context, only [1, 4) belongs to the shard
+    const double value[] = { 0.1, 1. / 3., 2. / 3., 1e-300, 12345.678901234567 };
+    for (unsigned i = 0; i < 5; i++) {
+        err  = vmaf_feature_collector_append(shard, "feature_a", value[i], i);
+        err |= vmaf_feature_collector_append(shard, "feature_b", -value[i], i);
+        // model outputs, as written by a streaming output
+        err |= vmaf_feature_collector_append(shard, "vmaf", 90. + i, i);
+        err |= vmaf_feature_collector_append(shard, "vmaf_stddev", 1., i);
+        mu_assert("problem during vmaf_feature_collector_append", !err);
+    }
+
+    FILE *partial = tmpfile();
+    mu_assert("problem creating temporary file", partial);
+    err = vmaf_partial_write(shard, partial, 1, 4, 99);
+    mu_assert("problem during vmaf_partial_write", !err);
+
+    VmafFeatureCollector *merged;
+    err = vmaf_feature_collector_init(&merged);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    rewind(partial);
+    unsigned index_low, index_high;
+    err = vmaf_partial_read(merged, partial, &index_low, &index_high);
+    mu_assert("problem during vmaf_partial_read", !err);
+    mu_assert("partial interval should be offset",
+              index_low == 100 && index_high == 103);
+
+    double score;
+    for (unsigned i = 1; i < 4; i++) {
+        err = vmaf_feature_collector_get_score(merged, "feature_a", &score,
+                                               i + 99);
+        mu_assert("problem during vmaf_feature_collector_get_score", !err);
+        mu_assert("partial scores should round-trip exactly",
+                  score == value[i]);
+        err = vmaf_feature_collector_get_score(merged, "feature_b", &score,
+                                               i + 99);
+        mu_assert("problem during vmaf_feature_collector_get_score", !err);
+        mu_assert("partial scores should round-trip exactly",
+                  score == -value[i]);
+    }
+    err = vmaf_feature_collector_get_score(merged, "feature_a", &score, 99);
+    mu_assert("context pictures should not be written", err);
+
+    // the merged context predicts the model outputs again
+    for (unsigned i = 1; i < 4; i++) {
+        err = vmaf_feature_collector_append(merged, "vmaf", 90. + i, i + 99);
+        err |= vmaf_feature_collector_append(merged, "vmaf_stddev", 1.,
+                                             i + 99);
+        mu_assert("model outputs should not be written", !err);
+    }
+    err = vmaf_feature_collector_get_score(merged, "feature_a", &score, 103);
+    mu_assert("context pictures should not be written", err);
+
+    rewind(partial);
+    err = vmaf_partial_read(merged, partial, NULL, NULL);
+    mu_assert("reading an overlapping partial result should fail", err);
+
+    fclose(partial);
+    vmaf_feature_collector_destroy(merged);
+    vmaf_feature_collector_destroy(shard);
+    return NULL;
+}
+
+static char *test_partial_read_invalid()
+{
+    int err;
+
+    VmafFeatureCollector *fc;
+    err = vmaf_feature_collector_init(&fc);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    FILE *partial = tmpfile();
+    mu_assert("problem creating temporary file", partial);
+    fprintf(partial, "VMAF_PARTIAL 1 0 2\nfeature feature_a 2\n0 1.5\n7 2.5\n");
+    rewind(partial);
+    err = vmaf_partial_read(fc, partial, NULL, NULL);
+    mu_assert("scores outside of the partial interval should fail", err);
+    fclose(partial);
+
+    partial = tmpfile();
+    mu_assert("problem creating temporary file", partial);
+    fprintf(partial, "VMAF_PARTIAL 2 0 2\n");
+    rewind(partial);
+    err = vmaf_partial_read(fc, partial, NULL, NULL);
+    mu_assert("unknown partial result versions should fail", err);
+    fclose(partial);
+
+    vmaf_feature_collector_destroy(fc);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_partial_write_and_read);
+    mu_run_test(test_partial_read_invalid);
+    return NULL;
+}
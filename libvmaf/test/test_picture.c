@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <string.h>
 
 #include "test.h"
 #include "picture.h"
@@ -46,9 +47,53 @@ static char *test_picture_data_alignment()
     return NULL;
 }
 
+static char *test_picture_hash()
+{
+    int err;
+
+    VmafPicture pic_a, pic_b;
+    err  = vmaf_picture_alloc(&pic_a, VMAF_PIX_FMT_YUV420P, 8, 99, 37);
+    err |= vmaf_picture_alloc(&pic_b, VMAF_PIX_FMT_YUV420P, 8, 99, 37);
+    mu_assert("problem during vmaf_picture_alloc", !err);
+    for (unsigned p = 0; p < 3; p++) {
+        uint8_t *a = pic_a.data[p], *b = pic_b.data[p];
+        for (unsigned i = 0; i < pic_a.h[p]; i++) {
+            for (unsigned j = 0; j < pic_a.stride[p]; j++) {
+                a[i * pic_a.stride[p] + j] = i * 7 + j * 3 + p;
+                // padding is not part of the content
+                b[i * pic_b.stride[p] + j] = j < pic_b.w[p] ? i * 7 + j * 3 + p
+                                                             : 0;
+            }
+        }
+    }
+
+    uint64_t hash_a[3], hash_b[3];
+    err  = vmaf_picture_hash(&pic_a, hash_a);
+    err |= vmaf_picture_hash(&pic_b, hash_b);
+    mu_assert("problem during vmaf_picture_hash", !err);
+    mu_assert("identical pictures should have identical hashes",
+              !memcmp(hash_a, hash_b, sizeof(hash_a)));
+
+    // last sample of the chroma plane, in the tail of a row
+    uint8_t *cr = pic_b.data[2];
+    cr[(pic_b.h[2] - 1) * pic_b.stride[2] + pic_b.w[2] - 1] ^= 1;
+    err = vmaf_picture_hash(&pic_b, hash_b);
+    mu_assert("problem during vmaf_picture_hash", !err);
+    mu_assert("only the hash of the changed plane should change",
+              hash_a[0] == hash_b[0] && hash_a[1] == hash_b[1] &&
+              hash_a[2] != hash_b[2]);
+
+    err  = vmaf_picture_unref(&pic_a);
+    err |= vmaf_picture_unref(&pic_b);
+    mu_assert("problem during vmaf_picture_unref", !err);
+
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_picture_alloc_ref_and_unref);
     mu_run_test(test_picture_data_alignment);
+    mu_run_test(test_picture_hash);
     return NULL;
 }
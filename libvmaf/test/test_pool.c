@@ -0,0 +1,141 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "pool.c"
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double exact_percentile(double *sorted, unsigned n, double percentile)
+{
+    // lower nearest rank, matches the sketch bucket walk
+    return sorted[(unsigned) (percentile / 100. * (n - 1))];
+}
+
+static bool within_relative_accuracy(double estimate, double value)
+{
+    return fabs(estimate - value) <=
+           2. * SKETCH_RELATIVE_ACCURACY * fabs(value) + 1e-9;
+}
+
+static char *test_pool_accumulator()
+{
+    int err;
+
+    VmafPoolAccumulator *acc;
+    err = vmaf_pool_accumulator_init(&acc);
+    mu_assert("problem during vmaf_pool_accumulator_init", !err);
+
+    double score;
+    err = vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_MEAN, &score);
+    mu_assert("pooling an empty accumulator should fail", err);
+    err = vmaf_pool_accumulator_append(acc, NAN);
+    mu_assert("appending a non-finite score should fail", err);
+
+    const unsigned n = 1000;
+    double s[n];
+    double sum = 0., sum_hm = 0., min = INFINITY;
+    srand(0);
+    for (unsigned i = 0; i < n; i++) {
+        // a few negative and zero scores, as unclipped predictions can be
+        s[i] = i % 97 ? 110. * rand() / RAND_MAX - 5. : 0.;
+        sum += s[i];
+        sum_hm += 1. / (s[i] + 1.);
+        min = s[i] < min ? s[i] : min;
+        err = vmaf_pool_accumulator_append(acc, s[i]);
+        mu_assert("problem during vmaf_pool_accumulator_append", !err);
+    }
+
+    double mean, harmonic_mean, minimum;
+    err  = vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_MEAN, &mean);
+    err |= vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_HARMONIC_MEAN,
+                                     &harmonic_mean);
+    err |= vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_MIN, &minimum);
+    mu_assert("problem during vmaf_pool_accumulator_get", !err);
+    mu_assert("pooled mean is incorrect", fabs(mean - sum / n) < 1e-9);
+    mu_assert("pooled harmonic mean is incorrect",
+              fabs(harmonic_mean - (n / sum_hm - 1.)) < 1e-9);
+    mu_assert("pooled min is incorrect", minimum == min);
+
+    qsort(s, n, sizeof(*s), cmp_double);
+    const double percentile[] = { 0., 1., 5., 10., 20., 50., 90., 100. };
+    for (unsigned i = 0; i < sizeof(percentile) / sizeof(*percentile); i++) {
+        err = vmaf_pool_accumulator_get_percentile(acc, percentile[i], &score);
+        mu_assert("problem during vmaf_pool_accumulator_get_percentile", !err);
+        mu_assert("percentile estimate is outside of relative accuracy",
+                  within_relative_accuracy(score,
+                      exact_percentile(s, n, percentile[i])));
+    }
+    err = vmaf_pool_accumulator_get_percentile(acc, 101., &score);
+    mu_assert("out of range percentile should fail", err);
+
+    vmaf_pool_accumulator_destroy(acc);
+    return NULL;
+}
+
+static char *test_pool_accumulator_merge()
+{
+    int err;
+
+    VmafPoolAccumulator *acc, *shard[3];
+    err = vmaf_pool_accumulator_init(&acc);
+    mu_assert("problem during vmaf_pool_accumulator_init", !err);
+    for (unsigned i = 0; i < 3; i++) {
+        err = vmaf_pool_accumulator_init(&shard[i]);
+        mu_assert("problem during vmaf_pool_accumulator_init", !err);
+    }
+
+    // shards cover disjoint score ranges to exercise store growth on merge
+    srand(1);
+    for (unsigned i = 0; i < 900; i++) {
+        const double s = (i / 300) * 30. + 30. * rand() / RAND_MAX;
+        err  = vmaf_pool_accumulator_append(acc, s);
+        err |= vmaf_pool_accumulator_append(shard[2 - i / 300], s);
+        mu_assert("problem during vmaf_pool_accumulator_append", !err);
+    }
+
+    VmafPoolAccumulator *merged;
+    err = vmaf_pool_accumulator_init(&merged);
+    mu_assert("problem during vmaf_pool_accumulator_init", !err);
+    for (unsigned i = 0; i < 3; i++) {
+        err = vmaf_pool_accumulator_merge(merged, shard[i]);
+        mu_assert("problem during vmaf_pool_accumulator_merge", !err);
+    }
+
+    for (double p = 0.; p <= 100.; p += 0.5) {
+        double a, b;
+        err  = vmaf_pool_accumulator_get_percentile(acc, p, &a);
+        err |= vmaf_pool_accumulator_get_percentile(merged, p, &b);
+        mu_assert("problem during vmaf_pool_accumulator_get_percentile", !err);
+        mu_assert("merged percentile differs from single accumulator", a == b);
+    }
+
+    double a, b;
+    err  = vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_MIN, &a);
+    err |= vmaf_pool_accumulator_get(merged, VMAF_POOL_METHOD_MIN, &b);
+    mu_assert("problem during vmaf_pool_accumulator_get", !err);
+    mu_assert("merged min differs from single accumulator", a == b);
+    err  = vmaf_pool_accumulator_get(acc, VMAF_POOL_METHOD_MEAN, &a);
+    err |= vmaf_pool_accumulator_get(merged, VMAF_POOL_METHOD_MEAN, &b);
+    mu_assert("problem during vmaf_pool_accumulator_get", !err);
+    mu_assert("merged mean differs from single accumulator",
+              fabs(a - b) < 1e-9);
+
+    for (unsigned i = 0; i < 3; i++)
+        vmaf_pool_accumulator_destroy(shard[i]);
+    vmaf_pool_accumulator_destroy(merged);
+    vmaf_pool_accumulator_destroy(acc);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_pool_accumulator);
+    mu_run_test(test_pool_accumulator_merge);
+    return NULL;
+}
@@ -2,6 +2,7 @@
 
 #include "test.h"
 #include "predict.h"
+#include "svm.h"
 
 static char *test_predict_score_at_index()
 {
@@ -30,8 +31,65 @@ static char *test_predict_score_at_index()
     return NULL;
 }
 
+static char *test_predict_score_at_index_bootstrap()
+{
+    int err;
+
+    VmafFeatureCollector *feature_collector;
+    err = vmaf_feature_collector_init(&feature_collector);
+    mu_assert("problem during vmaf_feature_collector_init", !err);
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model,
+                    "../../model/vmaf_b_v0.6.3/vmaf_b_v0.6.3.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    // adm2, motion2, vif_scale0, vif_scale1, vif_scale2, vif_scale3
+    const double feature_score[] = { 0.97, 6.9, 0.51, 0.90, 0.94, 0.99 };
+    mu_assert("this test assumes a model with 6 features",
+              model->n_features == 6);
+    for (unsigned i = 0; i < model->n_features; i++) {
+        err = vmaf_feature_collector_append(feature_collector,
+                                            model->feature[i].name,
+                                            feature_score[i], 0);
+        mu_assert("problem during vmaf_feature_collector_append", !err);
+    }
+
+    VmafBootstrapScore score;
+    err = vmaf_predict_score_at_index_bootstrap(model, feature_collector, 0,
+                                                &score);
+    mu_assert("problem during vmaf_predict_score_at_index_bootstrap", !err);
+    mu_assert("bagging score is outside of the 95% confidence interval",
+              score.ci95.lo <= score.bagging_score &&
+              score.bagging_score <= score.ci95.hi);
+    mu_assert("bootstrap stddev should be positive", score.stddev > 0.);
+
+    struct svm_node node[model->n_features + 1];
+    for (unsigned i = 0; i < model->n_features; i++) {
+        node[i].index = i + 1;
+        node[i].value = model->feature[i].slope * feature_score[i] +
+                        model->feature[i].intercept;
+    }
+    node[model->n_features].index = -1;
+
+    double prediction[model->bootstrap.n_models];
+    svm_predict_batch(model->bootstrap.batch, node, prediction);
+    mu_assert("batched prediction does not match svm_predict()",
+              prediction[0] == svm_predict(model->svm, node));
+    for (unsigned i = 1; i < model->bootstrap.n_models; i++) {
+        mu_assert("batched prediction does not match svm_predict()",
+                  prediction[i] ==
+                  svm_predict(model->bootstrap.svm[i - 1], node));
+    }
+
+    vmaf_model_destroy(model);
+    vmaf_feature_collector_destroy(feature_collector);
+    return NULL;
+}
+
 char *run_tests()
 {
     mu_run_test(test_predict_score_at_index);
+    mu_run_test(test_predict_score_at_index_bootstrap);
     return NULL;
 }
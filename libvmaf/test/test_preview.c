@@ -0,0 +1,135 @@
+#include <math.h>
+
+#include "test.h"
+#include "fixture.h"
+
+#define W 256
+#define H 192
+#define N_PICS 3
+
+static int score(VmafModel *model, unsigned preview, unsigned strength,
+                 FixtureScores *s)
+{
+    VmafConfiguration cfg = { .preview = preview };
+    return fixture_score(model, cfg, W, H, NULL, N_PICS, strength, s);
+}
+
+static char *test_preview_init()
+{
+    int err = 0;
+    VmafContext *vmaf;
+
+    const unsigned valid[] = { 0, 1, 2, 4 };
+    for (unsigned i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+        VmafConfiguration cfg = { .preview = valid[i] };
+        err = vmaf_init(&vmaf, cfg);
+        mu_assert("problem during vmaf_init", !err);
+        vmaf_close(vmaf);
+    }
+
+    VmafConfiguration cfg = { .preview = 3 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("preview 3 should be rejected", err);
+    return NULL;
+}
+
+static char *test_preview_feature_cache()
+{
+    int err = 0;
+    VmafContext *vmaf;
+
+    for (unsigned preview = 2; preview <= 4; preview += 2) {
+        VmafConfiguration cfg = { .preview = preview };
+        err = vmaf_init(&vmaf, cfg);
+        mu_assert("problem during vmaf_init", !err);
+        err = vmaf_use_feature_cache(vmaf, "/tmp");
+        mu_assert("preview scores should not use a feature cache", err);
+        vmaf_close(vmaf);
+    }
+    return NULL;
+}
+
+static char *test_preview_scores()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    static FixtureScores full, s;
+    err = score(model, 0, 5, &full);
+    mu_assert("problem scoring at full resolution", !err);
+    mu_assert("model features missing", full.n_features);
+
+    // preview 1 is full resolution
+    err = score(model, 1, 5, &s);
+    mu_assert("problem scoring with preview 1", !err);
+    for (unsigned i = 0; i < N_PICS; i++) {
+        for (unsigned j = 0; j < full.n_features; j++) {
+            mu_assert("preview 1 feature differs from full resolution",
+                      s.feature[i][j] == full.feature[i][j]);
+        }
+        mu_assert("preview 1 score differs from full resolution",
+                  s.score[i] == full.score[i]);
+    }
+
+    // preview 2 and 4 compute the VIF scales from 1 and 2 on respectively,
+    // and estimate the finer ones
+    const char *vif[] = { "vif_scale0", "vif_scale1", "vif_scale2",
+                          "vif_scale3" };
+    for (unsigned preview = 2, skipped = 1; preview <= 4;
+         preview += 2, skipped++)
+    {
+        err = score(model, preview, 5, &s);
+        mu_assert("problem scoring with preview", !err);
+        mu_assert("preview should provide the model features",
+                  s.n_features == full.n_features);
+
+        const int adm = fixture_feature_index(&s, "adm2");
+        mu_assert("preview should provide adm2", adm >= 0);
+        for (unsigned i = 0; i < N_PICS; i++) {
+            mu_assert("estimated adm2 should be in (0, 1]",
+                      s.feature[i][adm] > 0. && s.feature[i][adm] <= 1.);
+        }
+        for (unsigned scale = 0; scale < 4; scale++) {
+            const int k = fixture_feature_index(&s, vif[scale]);
+            mu_assert("preview should provide every VIF scale", k >= 0);
+            for (unsigned i = 0; i < N_PICS; i++) {
+                if (scale < skipped) {
+                    mu_assert("estimated VIF scale should be in (0, 1]",
+                              s.feature[i][k] > 0. && s.feature[i][k] <= 1.);
+                } else {
+                    mu_assert("computed VIF scale differs from full resolution",
+                              s.feature[i][k] == full.feature[i][k]);
+                }
+            }
+        }
+
+        // identical pictures keep their estimated scales at 1, up to the
+        // rounding of the computed scale they are estimated from
+        static FixtureScores same;
+        err = score(model, preview, 0, &same);
+        mu_assert("problem scoring identical pictures with preview", !err);
+        for (unsigned i = 0; i < N_PICS; i++) {
+            mu_assert("identical pictures should keep adm2 at 1",
+                      fabs(same.feature[i][adm] - 1.) < 1e-5);
+            for (unsigned scale = 0; scale < skipped; scale++) {
+                const int k = fixture_feature_index(&same, vif[scale]);
+                mu_assert("identical pictures should keep VIF at 1",
+                          fabs(same.feature[i][k] - 1.) < 1e-5);
+            }
+        }
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_preview_init);
+    mu_run_test(test_preview_feature_cache);
+    mu_run_test(test_preview_scores);
+    return NULL;
+}
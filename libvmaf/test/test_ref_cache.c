@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "test.h"
+#include "fixture.h"
+#include "picture.c"
+#include "feature/feature_collector.c"
+#include "feature/ref_cache.c"
+
+#define PIC_CNT 4
+#define W 16
+#define H 8
+
+// reads pictures 0..PIC_CNT, picture `changed` differs from the first run
+static int read_pictures(VmafRefCache *cache, unsigned changed)
+{
+    for (unsigned i = 0; i < PIC_CNT; i++) {
+        VmafPicture pic;
+        int err = fixture_picture(&pic, W, H, i, 0);
+        if (err) return err;
+        if (i == changed)
+            ((uint8_t *) pic.data[0])[0] ^= 1;
+        err = vmaf_ref_cache_frame(cache, &pic, i);
+        err |= vmaf_picture_unref(&pic);
+        if (err) return err;
+    }
+    return 0;
+}
+
+static char *test_ref_cache()
+{
+    int err;
+    double value;
+
+    VmafRefCache *cache;
+    err = vmaf_ref_cache_init(&cache, NULL);
+    mu_assert("problem during vmaf_ref_cache_init", !err);
+    err = read_pictures(cache, PIC_CNT);
+    mu_assert("problem during vmaf_ref_cache_frame", !err);
+    for (unsigned i = 0; i < PIC_CNT; i++) {
+        err = vmaf_ref_cache_get(cache, "value", i, &value);
+        mu_assert("empty cache should not have values", err);
+        err = vmaf_ref_cache_put(cache, "value", i, i / 3.);
+        mu_assert("problem during vmaf_ref_cache_put", !err);
+    }
+
+    FILE *file = tmpfile();
+    mu_assert("problem creating temporary file", file);
+    err = vmaf_ref_cache_write(cache, file);
+    mu_assert("problem during vmaf_ref_cache_write", !err);
+    vmaf_ref_cache_destroy(cache);
+
+    // same reference, all values are served
+    rewind(file);
+    err = vmaf_ref_cache_init(&cache, file);
+    mu_assert("problem reading cache", !err);
+    err = read_pictures(cache, PIC_CNT);
+    mu_assert("problem during vmaf_ref_cache_frame", !err);
+    for (unsigned i = 0; i < PIC_CNT; i++) {
+        err = vmaf_ref_cache_get(cache, "value", i, &value);
+        mu_assert("cached value missing", !err);
+        mu_assert("cached value not bit-exact", value == i / 3.);
+    }
+    vmaf_ref_cache_destroy(cache);
+
+    // picture 2 changed, only pictures 0 and 1 are served
+    rewind(file);
+    err = vmaf_ref_cache_init(&cache, file);
+    mu_assert("problem reading cache", !err);
+    err = read_pictures(cache, 2);
+    mu_assert("problem during vmaf_ref_cache_frame", !err);
+    for (unsigned i = 0; i < PIC_CNT; i++) {
+        err = vmaf_ref_cache_get(cache, "value", i, &value);
+        mu_assert("value served for a changed reference", (i < 2) == !err);
+    }
+    vmaf_ref_cache_destroy(cache);
+
+    // pictures have to be read in order
+    err = vmaf_ref_cache_init(&cache, NULL);
+    mu_assert("problem during vmaf_ref_cache_init", !err);
+    VmafPicture pic;
+    err = fixture_picture(&pic, W, H, 1, 0);
+    mu_assert("problem during vmaf_picture_alloc", !err);
+    err = vmaf_ref_cache_frame(cache, &pic, 1);
+    mu_assert("out of order picture should fail", err);
+    vmaf_picture_unref(&pic);
+    vmaf_ref_cache_destroy(cache);
+
+    // a truncated cache serves nothing
+    uint8_t buf[512];
+    rewind(file);
+    const size_t sz = fread(buf, 1, sizeof(buf), file);
+    FILE *truncated = tmpfile();
+    mu_assert("problem creating temporary file", truncated);
+    fwrite(buf, 1, sz - 4, truncated);
+    rewind(truncated);
+    err = vmaf_ref_cache_init(&cache, truncated);
+    mu_assert("truncated cache should be used as an empty one", !err);
+    err = read_pictures(cache, PIC_CNT);
+    mu_assert("problem during vmaf_ref_cache_frame", !err);
+    err = vmaf_ref_cache_get(cache, "value", 0, &value);
+    mu_assert("truncated cache should not serve values", err);
+    vmaf_ref_cache_destroy(cache);
+    fclose(truncated);
+
+    // neither does something which is not a cache
+    rewind(file);
+    fwrite("garbage!", 8, 1, file);
+    rewind(file);
+    err = vmaf_ref_cache_init(&cache, file);
+    mu_assert("malformed cache should be used as an empty one", !err);
+    err = read_pictures(cache, PIC_CNT);
+    mu_assert("problem during vmaf_ref_cache_frame", !err);
+    err = vmaf_ref_cache_get(cache, "value", 0, &value);
+    mu_assert("malformed cache should not serve values", err);
+    vmaf_ref_cache_destroy(cache);
+
+    fclose(file);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_ref_cache);
+    return NULL;
+}
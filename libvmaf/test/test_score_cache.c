@@ -0,0 +1,100 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "score_cache.c"
+
+static bool almost_equal(double a, double b)
+{
+    return fabs(a - b) < 1e-9;
+}
+
+static char *test_score_cache_append_and_get()
+{
+    int err;
+
+    VmafScoreCache *score_cache;
+    err = vmaf_score_cache_init(&score_cache);
+    mu_assert("problem during vmaf_score_cache_init", !err);
+
+    double score;
+    err = vmaf_score_cache_get_score(score_cache, &score, 3);
+    mu_assert("vmaf_score_cache_get_score should fail for unwritten index",
+              err);
+    err = vmaf_score_cache_append(score_cache, 42., 3);
+    mu_assert("problem during vmaf_score_cache_append", !err);
+    err = vmaf_score_cache_append(score_cache, 42., 3);
+    mu_assert("vmaf_score_cache_append should not overwrite", err);
+    err = vmaf_score_cache_get_score(score_cache, &score, 3);
+    mu_assert("problem during vmaf_score_cache_get_score", !err);
+    mu_assert("vmaf_score_cache_get_score did not get the expected score",
+              score == 42.);
+
+    vmaf_score_cache_destroy(score_cache);
+    return NULL;
+}
+
+static char *test_score_cache_pool()
+{
+    int err;
+
+    VmafScoreCache *score_cache;
+    err = vmaf_score_cache_init(&score_cache);
+    mu_assert("problem during vmaf_score_cache_init", !err);
+
+    // out of order, with every 5th frame missing (i.e. subsampled)
+    const unsigned n = 1000;
+    double score[n];
+    srand(0);
+    for (unsigned i = 0; i < n; i++)
+        score[i] = 100. * rand() / RAND_MAX;
+    for (unsigned i = n; i-- > 0;) {
+        if (!(i % 5)) continue;
+        err = vmaf_score_cache_append(score_cache, score[i], i);
+        mu_assert("problem during vmaf_score_cache_append", !err);
+    }
+
+    for (unsigned k = 0; k < 500; k++) {
+        unsigned lo = rand() % n, hi = rand() % n;
+        if (lo > hi) { unsigned t = lo; lo = hi; hi = t; }
+        hi++;
+
+        double sum = 0., sum_hm = 0., min = INFINITY;
+        unsigned cnt = 0;
+        for (unsigned i = lo; i < hi; i++) {
+            if (!(i % 5)) continue;
+            sum += score[i];
+            sum_hm += 1. / (score[i] + 1.);
+            min = score[i] < min ? score[i] : min;
+            cnt++;
+        }
+
+        double mean, harmonic_mean, minimum;
+        err  = vmaf_score_cache_pool(score_cache, VMAF_POOL_METHOD_MEAN,
+                                     &mean, lo, hi);
+        err |= vmaf_score_cache_pool(score_cache,
+                                     VMAF_POOL_METHOD_HARMONIC_MEAN,
+                                     &harmonic_mean, lo, hi);
+        err |= vmaf_score_cache_pool(score_cache, VMAF_POOL_METHOD_MIN,
+                                     &minimum, lo, hi);
+        if (!cnt) {
+            mu_assert("pooling an empty interval should fail", err);
+            continue;
+        }
+        mu_assert("problem during vmaf_score_cache_pool", !err);
+        mu_assert("pooled mean is incorrect", almost_equal(mean, sum / cnt));
+        mu_assert("pooled harmonic mean is incorrect",
+                  almost_equal(harmonic_mean, cnt / sum_hm - 1.));
+        mu_assert("pooled min is incorrect", minimum == min);
+    }
+
+    vmaf_score_cache_destroy(score_cache);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_score_cache_append_and_get);
+    mu_run_test(test_score_cache_pool);
+    return NULL;
+}
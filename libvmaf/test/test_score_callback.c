@@ -0,0 +1,138 @@
+#include <stdlib.h>
+
+#include "test.h"
+#include "model.h"
+#include "libvmaf/libvmaf.rc.h"
+
+typedef struct {
+    unsigned cnt;
+    unsigned index[8];
+    double score[8];
+    unsigned n_features;
+} CallbackLog;
+
+static void log_frame_score(void *user_data, const VmafFrameScore *fs)
+{
+    CallbackLog *log = user_data;
+    if (log->cnt >= 8) return;
+    log->index[log->cnt] = fs->index;
+    log->score[log->cnt] = fs->score;
+    log->n_features = fs->n_features;
+    log->cnt++;
+}
+
+static const double feature_value[] = { 0.97, 6.9, 0.51, 0.90, 0.94, 0.99 };
+
+static int import_features(VmafContext *vmaf, VmafModel *model,
+                           unsigned index, unsigned lo, unsigned hi)
+{
+    int err = 0;
+    for (unsigned i = lo; i < hi; i++) {
+        err |= vmaf_import_feature_score(vmaf, model->feature[i].name,
+                                         feature_value[i % 6], index);
+    }
+    return err;
+}
+
+static char *test_score_callback()
+{
+    int err = 0;
+
+    VmafContext *vmaf;
+    VmafConfiguration cfg = { 0 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    CallbackLog log = { 0 };
+    err = vmaf_register_score_callback(vmaf, model, log_frame_score, &log);
+    mu_assert("problem during vmaf_register_score_callback", !err);
+
+    // frame 1 completes before frame 0, delivery has to stay in order
+    err = import_features(vmaf, model, 1, 0, model->n_features);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("callback invoked before frame 0 is complete", log.cnt == 0);
+    const unsigned last = model->n_features - 1;
+    err = import_features(vmaf, model, 0, 0, last);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("callback invoked for incomplete frame", log.cnt == 0);
+    err = import_features(vmaf, model, 0, last, last + 1);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("callback not invoked for complete frames", log.cnt == 2);
+    mu_assert("callback delivered out of order",
+              log.index[0] == 0 && log.index[1] == 1);
+    mu_assert("callback did not deliver model features",
+              log.n_features == model->n_features);
+
+    double score;
+    err = vmaf_score_at_index(vmaf, model, &score, 1);
+    mu_assert("problem during vmaf_score_at_index", !err);
+    mu_assert("callback score differs from vmaf_score_at_index",
+              score == log.score[1]);
+
+    // incomplete frames are skipped once flushed
+    err  = import_features(vmaf, model, 2, 0, last);
+    err |= import_features(vmaf, model, 3, 0, last + 1);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+    mu_assert("callback invoked for incomplete frame", log.cnt == 2);
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    mu_assert("problem during vmaf_read_pictures flush", !err);
+    mu_assert("callback not invoked after flush",
+              log.cnt == 3 && log.index[2] == 3);
+
+    vmaf_model_destroy(model);
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+    return NULL;
+}
+
+static char *test_score_at_index_bootstrap()
+{
+    int err = 0;
+
+    VmafContext *vmaf;
+    VmafConfiguration cfg = { 0 };
+    err = vmaf_init(&vmaf, cfg);
+    mu_assert("problem during vmaf_init", !err);
+
+    VmafModel *model[2];
+    for (unsigned i = 0; i < 2; i++) {
+        err = vmaf_model_load_from_path(&model[i],
+                        "../../model/vmaf_b_v0.6.3/vmaf_b_v0.6.3.pkl");
+        mu_assert("problem during vmaf_model_load_from_path", !err);
+    }
+    err = import_features(vmaf, model[0], 0, 0, model[0]->n_features);
+    mu_assert("problem during vmaf_import_feature_score", !err);
+
+    // scores are predicted once per model, repeated calls are served
+    VmafBootstrapScore score[3];
+    err = vmaf_score_at_index_bootstrap(vmaf, model[0], &score[0], 0);
+    mu_assert("problem during vmaf_score_at_index_bootstrap", !err);
+    err = vmaf_score_at_index_bootstrap(vmaf, model[0], &score[1], 0);
+    mu_assert("repeated vmaf_score_at_index_bootstrap should not fail", !err);
+    err = vmaf_score_at_index_bootstrap(vmaf, model[1], &score[2], 0);
+    mu_assert("second bootstrap model should not fail", !err);
+    for (unsigned i = 1; i < 3; i++) {
+        mu_assert("bootstrap scores differ",
+                  score[i].bagging_score == score[0].bagging_score &&
+                  score[i].stddev == score[0].stddev &&
+                  score[i].ci95.lo == score[0].ci95.lo &&
+                  score[i].ci95.hi == score[0].ci95.hi);
+    }
+
+    for (unsigned i = 0; i < 2; i++)
+        vmaf_model_destroy(model[i]);
+    err = vmaf_close(vmaf);
+    mu_assert("problem during vmaf_close", !err);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_score_callback);
+    mu_run_test(test_score_at_index_bootstrap);
+    return NULL;
+}
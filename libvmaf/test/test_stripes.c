@@ -0,0 +1,49 @@
+#include "test.h"
+#include "fixture.h"
+
+#define N_PICS 3
+
+static char *test_stripes()
+{
+    int err = 0;
+
+    VmafModel *model;
+    err = vmaf_model_load_from_path(&model, "../../model/vmaf_v0.6.1.pkl");
+    mu_assert("problem during vmaf_model_load_from_path", !err);
+
+    // several stripes on the finer scales, odd heights on the coarser ones
+    const unsigned size[][2] = { { 256, 192 }, { 248, 170 } };
+    for (unsigned k = 0; k < 2; k++) {
+        const unsigned w = size[k][0], h = size[k][1];
+        static FixtureScores serial, striped;
+        VmafConfiguration cfg = { .n_threads = 1 };
+        err = fixture_score(model, cfg, w, h, NULL, N_PICS, 5, &serial);
+        mu_assert("problem scoring with one thread", !err);
+        mu_assert("model features missing", serial.n_features);
+
+        for (unsigned n_threads = 2; n_threads <= 4; n_threads++) {
+            cfg.n_threads = n_threads;
+            err = fixture_score(model, cfg, w, h, NULL, N_PICS, 5, &striped);
+            mu_assert("problem scoring with a thread pool", !err);
+            mu_assert("model features missing",
+                      striped.n_features == serial.n_features);
+            for (unsigned i = 0; i < N_PICS; i++) {
+                for (unsigned j = 0; j < serial.n_features; j++) {
+                    mu_assert("striped feature differs from serial",
+                              striped.feature[i][j] == serial.feature[i][j]);
+                }
+                mu_assert("striped score differs from serial",
+                          striped.score[i] == serial.score[i]);
+            }
+        }
+    }
+
+    vmaf_model_destroy(model);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_stripes);
+    return NULL;
+}
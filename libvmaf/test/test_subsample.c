@@ -0,0 +1,93 @@
+#include <stdint.h>
+
+#include "test.h"
+#include "fixture.h"
+#include "picture.c"
+#include "subsample.c"
+
+#define MAX_STRIDE 4
+
+// the fixture texture with its luma moved to the lower half for scene 0
+// and the upper half for scene 1, so a new scene moves the histogram
+static int fill_picture(VmafPicture *pic, unsigned scene, unsigned noise)
+{
+    int err = fixture_picture(pic, 64, 32, scene, noise);
+    if (err) return err;
+    uint8_t *data = pic->data[0];
+    for (unsigned i = 0; i < pic->h[0]; i++) {
+        for (unsigned j = 0; j < pic->w[0]; j++) {
+            uint8_t *y = &data[i * pic->stride[0] + j];
+            *y = *y / 2 + scene * 128;
+        }
+    }
+    return 0;
+}
+
+static int picture(VmafSubsample *s, unsigned scene, unsigned noise,
+                   double motion, unsigned index, bool *extract, bool *cut)
+{
+    VmafPicture ref, dist;
+    int err = fill_picture(&ref, scene, 0);
+    if (err) return err;
+    err = fill_picture(&dist, scene, noise);
+    if (err) return err;
+    VmafPicture *d = &dist;
+    err = vmaf_subsample_picture(s, &ref, &d, 1, motion, index, extract, cut);
+    vmaf_picture_unref(&ref);
+    vmaf_picture_unref(&dist);
+    return err;
+}
+
+static char *test_subsample()
+{
+    int err;
+    bool extract, cut;
+    unsigned index = 0;
+
+    VmafSubsample *s;
+    err = vmaf_subsample_init(&s, MAX_STRIDE, 1);
+    mu_assert("problem during vmaf_subsample_init", !err);
+
+    err = picture(s, 0, 2, -1., index++, &extract, &cut);
+    mu_assert("problem during vmaf_subsample_picture", !err);
+    mu_assert("first picture should be extracted as a cut", extract && cut);
+
+    // a static scene is extracted every MAX_STRIDE pictures
+    for (unsigned i = 1; i <= MAX_STRIDE; i++) {
+        err = picture(s, 0, 2, 0., index++, &extract, &cut);
+        mu_assert("problem during vmaf_subsample_picture", !err);
+        mu_assert("static picture should only be extracted at max stride",
+                  extract == (i == MAX_STRIDE) && !cut);
+    }
+
+    // motion fills the budget earlier
+    err = picture(s, 0, 2, SUBSAMPLE_MOTION_BUDGET, index++, &extract, &cut);
+    mu_assert("problem during vmaf_subsample_picture", !err);
+    mu_assert("motion should be extracted", extract && !cut);
+
+    // distortion steps are cuts
+    err = picture(s, 0, 24, 0., index++, &extract, &cut);
+    mu_assert("problem during vmaf_subsample_picture", !err);
+    mu_assert("distortion step should be extracted as a cut", extract && cut);
+
+    // as are new scenes
+    err = picture(s, 1, 24, 0., index++, &extract, &cut);
+    mu_assert("problem during vmaf_subsample_picture", !err);
+    mu_assert("scene cut should be extracted as a cut", extract && cut);
+    err = picture(s, 1, 24, 0., index++, &extract, &cut);
+    mu_assert("problem during vmaf_subsample_picture", !err);
+    mu_assert("static picture should not be extracted", !extract);
+
+    // pictures are passed in order
+    err = picture(s, 1, 24, 0., index + 1, &extract, &cut);
+    mu_assert("out of order picture should fail", err);
+
+    vmaf_subsample_destroy(s);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_subsample);
+    return NULL;
+}
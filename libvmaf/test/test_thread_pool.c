@@ -0,0 +1,77 @@
+#include <stdint.h>
+
+#include "test.h"
+#include "thread_pool.c"
+
+#define ROWS 1080
+
+static void count_rows(void *data, unsigned row_begin, unsigned row_end)
+{
+    unsigned *cnt = data;
+    for (unsigned i = row_begin; i < row_end; i++)
+        cnt[i]++;
+}
+
+static void add(void *data)
+{
+    unsigned *value = *((unsigned **) data);
+    __atomic_fetch_add(value, 1, __ATOMIC_SEQ_CST);
+}
+
+static char *test_thread_pool_enqueue()
+{
+    int err;
+    unsigned value = 0;
+    unsigned *ptr = &value;
+
+    VmafThreadPool *pool;
+    err = vmaf_thread_pool_create(&pool, 4);
+    mu_assert("problem during vmaf_thread_pool_create", !err);
+
+    for (unsigned i = 0; i < 100; i++) {
+        err = vmaf_thread_pool_enqueue(pool, add, &ptr, sizeof(ptr));
+        mu_assert("problem during vmaf_thread_pool_enqueue", !err);
+    }
+    err = vmaf_thread_pool_wait(pool);
+    mu_assert("problem during vmaf_thread_pool_wait", !err);
+    mu_assert("every job should have run once", value == 100);
+
+    err = vmaf_thread_pool_destroy(pool);
+    mu_assert("problem during vmaf_thread_pool_destroy", !err);
+    return NULL;
+}
+
+static char *test_thread_pool_stripes()
+{
+    int err;
+    unsigned cnt[ROWS];
+
+    VmafThreadPool *pool;
+    err = vmaf_thread_pool_create(&pool, 3);
+    mu_assert("problem during vmaf_thread_pool_create", !err);
+
+    // with and without a pool, every row is in exactly one stripe
+    for (unsigned p = 0; p < 2; p++) {
+        for (unsigned h = 0; h <= ROWS; h += 7) {
+            memset(cnt, 0, sizeof(cnt));
+            err = vmaf_thread_pool_stripes(p ? pool : NULL, h, 16, count_rows,
+                                           cnt);
+            mu_assert("problem during vmaf_thread_pool_stripes", !err);
+            for (unsigned i = 0; i < ROWS; i++)
+                mu_assert("row should be in one stripe", cnt[i] == (i < h));
+        }
+    }
+
+    err = vmaf_thread_pool_stripes(pool, ROWS, 16, NULL, cnt);
+    mu_assert("stripes without a function should fail", err);
+
+    vmaf_thread_pool_destroy(pool);
+    return NULL;
+}
+
+char *run_tests()
+{
+    mu_run_test(test_thread_pool_enqueue);
+    mu_run_test(test_thread_pool_stripes);
+    return NULL;
+}
@@ -9,7 +9,21 @@
 
 #include <libvmaf/libvmaf.rc.h>
 
-static const char short_opts[] = "r:d:w:h:p:b:m:o:x:t:f:i:s:n:v:";
+static const char short_opts[] = "r:d:w:h:p:b:m:o:x:t:f:i:s:n:v:c";
+
+enum {
+    ARG_PREFETCH = 256,
+    ARG_FRAME_START,
+    ARG_FRAME_CNT,
+    ARG_PARTIAL,
+    ARG_REF_CACHE,
+    ARG_FEATURE_CACHE,
+    ARG_PREVIEW,
+    ARG_ADAPTIVE_SUBSAMPLE,
+    ARG_JSON,
+    ARG_CSV,
+    ARG_BIN,
+};
 
 static const struct option long_opts[] = {
     { "reference",        1, NULL, 'r' },
@@ -21,11 +35,23 @@ static const struct option long_opts[] = {
     { "model",            1, NULL, 'm' },
     { "output",           1, NULL, 'o' },
     { "xml",              0, NULL, 'x' },
+    { "json",             0, NULL, ARG_JSON },
+    { "csv",              0, NULL, ARG_CSV },
+    { "bin",              0, NULL, ARG_BIN },
     { "threads",          1, NULL, 't' },
     { "feature",          1, NULL, 'f' },
     { "import",           1, NULL, 'i' },
     { "subsample",        1, NULL, 's' },
     { "no_prediction",    0, NULL, 'n' },
+    { "ci",               0, NULL, 'c' },
+    { "prefetch",         1, NULL, ARG_PREFETCH },
+    { "frame-start",      1, NULL, ARG_FRAME_START },
+    { "frame-count",      1, NULL, ARG_FRAME_CNT },
+    { "partial",          1, NULL, ARG_PARTIAL },
+    { "ref-cache",        1, NULL, ARG_REF_CACHE },
+    { "feature-cache",    1, NULL, ARG_FEATURE_CACHE },
+    { "preview",          1, NULL, ARG_PREVIEW },
+    { "adaptive-subsample", 1, NULL, ARG_ADAPTIVE_SUBSAMPLE },
     { "version",          0, NULL, 'v' },
     { NULL,               0, NULL, 0 },
 };
@@ -49,11 +75,23 @@ static void usage(const char *const app, const char *const reason, ...) {
             " --model/-m $path:          path to model file\n"
             " --output/-o $path:         path to output file\n"
             " --xml/-x:                  write output file as XML (default)\n"
-            " --threads/-t $unsigned:    number of threads to use\n"
+            " --json:                    write output file as JSON\n"
+            " --csv:                     write output file as CSV\n"
+            " --bin:                     write output file as columnar binary\n"
+            " --threads/-t $unsigned:    threads splitting each picture (ADM, VIF)\n"
             " --feature/-f $string:      additional feature\n"
             " --import/-i $path:         path to precomputed feature log\n"
             " --subsample/-s: $unsigned  compute scores only every N frames\n"
             " --no_prediction/-n:        no prediction, extract features only\n"
+            " --ci/-c:                   bootstrap confidence interval (bootstrap models only)\n"
+            " --prefetch $unsigned:      pictures to read ahead per input (default: 4, 0: off)\n"
+            " --frame-start $unsigned:   index of the first frame to score (default: 0)\n"
+            " --frame-count $unsigned:   number of frames to score (default: all)\n"
+            " --partial $path:           write scored frames as a partial result for vmaf_merge\n"
+            " --ref-cache $path:         reuse/store reference-only intermediates in a cache file\n"
+            " --feature-cache $dir:      reuse/store per-frame feature scores in a cache directory\n"
+            " --preview $unsigned:       fast approximate scores from 2x or 4x decimated ADM/VIF\n"
+            " --adaptive-subsample $unsigned: ADM/VIF only on motion, scene cuts and distortion changes, at most N frames apart\n"
             " --version/-v:              print version and exit\n"
            );
     exit(1);
@@ -120,6 +158,7 @@ void cli_parse(const int argc, char *const *const argv,
                CLISettings *const settings)
 {
     memset(settings, 0, sizeof(*settings));
+    settings->prefetch = 4;
     int o;
 
     while ((o = getopt_long(argc, argv, short_opts, long_opts, NULL)) >= 0) {
@@ -152,6 +191,15 @@ void cli_parse(const int argc, char *const *const argv,
         case 'x':
             settings->output_fmt = VMAF_OUTPUT_FORMAT_XML;
             break;
+        case ARG_JSON:
+            settings->output_fmt = VMAF_OUTPUT_FORMAT_JSON;
+            break;
+        case ARG_CSV:
+            settings->output_fmt = VMAF_OUTPUT_FORMAT_CSV;
+            break;
+        case ARG_BIN:
+            settings->output_fmt = VMAF_OUTPUT_FORMAT_BINARY;
+            break;
         case 'm':
             if (settings->model_cnt == CLI_SETTINGS_STATIC_ARRAY_LEN) {
                 usage(argv[0], "A maximum of %d models is supported\n",
@@ -182,6 +230,40 @@ void cli_parse(const int argc, char *const *const argv,
         case 'n':
             settings->no_prediction = true;
             break;
+        case 'c':
+            settings->enable_conf_interval = true;
+            break;
+        case ARG_PREFETCH:
+            settings->prefetch = parse_unsigned(optarg, ARG_PREFETCH, argv[0]);
+            break;
+        case ARG_FRAME_START:
+            settings->frame_start =
+                parse_unsigned(optarg, ARG_FRAME_START, argv[0]);
+            break;
+        case ARG_FRAME_CNT:
+            settings->frame_cnt =
+                parse_unsigned(optarg, ARG_FRAME_CNT, argv[0]);
+            break;
+        case ARG_PARTIAL:
+            settings->partial_path = optarg;
+            break;
+        case ARG_REF_CACHE:
+            settings->ref_cache_path = optarg;
+            break;
+        case ARG_FEATURE_CACHE:
+            settings->feature_cache_dir = optarg;
+            break;
+        case ARG_PREVIEW:
+            settings->preview = parse_unsigned(optarg, ARG_PREVIEW, argv[0]);
+            if (settings->preview != 2 && settings->preview != 4)
+                error(argv[0], optarg, ARG_PREVIEW, "2 or 4");
+            break;
+        case ARG_ADAPTIVE_SUBSAMPLE:
+            settings->adaptive_subsample =
+                parse_unsigned(optarg, ARG_ADAPTIVE_SUBSAMPLE, argv[0]);
+            if (settings->adaptive_subsample < 2)
+                error(argv[0], optarg, ARG_ADAPTIVE_SUBSAMPLE, "at least 2");
+            break;
         case 'v':
             fprintf(stderr, "%s\n", vmaf_version());
             exit(0);
@@ -205,6 +287,12 @@ void cli_parse(const int argc, char *const *const argv,
                        "  --pixel_format/-p\n"
                        "  --bitdepth/-b\n");
     }
+    if (settings->partial_path && settings->subsample > 1)
+        usage(argv[0], "--partial does not support --subsample");
+    if (settings->feature_cache_dir && settings->preview)
+        usage(argv[0], "--feature-cache does not support --preview");
+    if (settings->adaptive_subsample && settings->subsample > 1)
+        usage(argv[0], "--adaptive-subsample does not support --subsample");
     if ((settings->model_cnt == 0) && !settings->no_prediction)
         usage(argv[0], "At least one model file (-m/--model) is required");
 }
@@ -25,6 +25,14 @@ typedef struct {
     unsigned subsample;
     unsigned thread_cnt;
     bool no_prediction;
+    bool enable_conf_interval;
+    unsigned prefetch;
+    unsigned frame_start, frame_cnt;
+    char *partial_path;
+    char *ref_cache_path;
+    char *feature_cache_dir;
+    unsigned preview;
+    unsigned adaptive_subsample;
 } CLISettings;
 
 void cli_parse(const int argc, char *const *const argv,
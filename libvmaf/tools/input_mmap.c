@@ -0,0 +1,106 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <string.h>
+
+#include "input_mmap.h"
+
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#define HAVE_MMAP 1
+#else
+#define HAVE_MMAP 0
+#endif
+
+int input_mmap_open(input_mmap *m, FILE *fin)
+{
+    memset(m, 0, sizeof(*m));
+
+#if HAVE_MMAP
+    const int fd = fileno(fin);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0)
+        return -1;
+    if ((uintmax_t) st.st_size > SIZE_MAX) return -1;
+
+    const off_t pos = ftello(fin);
+    if (pos < 0 || pos > st.st_size) return -1;
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return -1;
+    posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    m->data = data;
+    m->size = st.st_size;
+    m->pos = pos;
+    m->dev = st.st_dev;
+    m->ino = st.st_ino;
+    return 0;
+#else
+    (void) fin;
+    return -1;
+#endif
+}
+
+const uint8_t *input_mmap_at(input_mmap *m, size_t pos, size_t sz)
+{
+    if (!m->data) return NULL;
+    if (pos > m->size || sz > m->size - pos) return NULL;
+    return m->data + pos;
+}
+
+const uint8_t *input_mmap_read(input_mmap *m, size_t sz)
+{
+    const uint8_t *data = input_mmap_at(m, m->pos, sz);
+    if (data) m->pos += sz;
+    return data;
+}
+
+int input_mmap_sync_from_file(input_mmap *m, FILE *fin)
+{
+#if HAVE_MMAP
+    const off_t pos = ftello(fin);
+    if (pos < 0 || (uintmax_t) pos > m->size) return -1;
+    m->pos = pos;
+    return 0;
+#else
+    (void) m;
+    (void) fin;
+    return -1;
+#endif
+}
+
+int input_mmap_sync_to_file(input_mmap *m, FILE *fin)
+{
+#if HAVE_MMAP
+    return fseeko(fin, m->pos, SEEK_SET);
+#else
+    (void) m;
+    (void) fin;
+    return -1;
+#endif
+}
+
+int input_mmap_matches(input_mmap *m, FILE *fin)
+{
+    if (!m->data) return 0;
+
+#if HAVE_MMAP
+    struct stat st;
+    if (fstat(fileno(fin), &st)) return 0;
+    return st.st_dev == m->dev && st.st_ino == m->ino &&
+           (uintmax_t) st.st_size == m->size;
+#else
+    (void) fin;
+    return 0;
+#endif
+}
+
+void input_mmap_close(input_mmap *m)
+{
+#if HAVE_MMAP
+    if (m->data) munmap((void *) m->data, m->size);
+#endif
+    memset(m, 0, sizeof(*m));
+}
@@ -0,0 +1,56 @@
+#ifndef __VMAF_TOOLS_INPUT_MMAP_H__
+#define __VMAF_TOOLS_INPUT_MMAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Read-only mapping of a regular input file.
+ * Frames are handed out as pointers into the mapping (zero-copy), pages are
+ * faulted in by the kernel with sequential read-ahead.
+ */
+typedef struct input_mmap {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    uintmax_t dev, ino;
+} input_mmap;
+
+/**
+ * Map `fin`, starting at its current position.
+ * Returns < 0 if `fin` can not be mapped (pipe, empty file, unsupported
+ * platform, ...), in which case the caller should keep using stdio.
+ */
+int input_mmap_open(input_mmap *m, FILE *fin);
+
+/**
+ * Return a pointer to the next `sz` bytes and advance, or NULL if fewer
+ * than `sz` bytes are left.
+ */
+const uint8_t *input_mmap_read(input_mmap *m, size_t sz);
+
+/**
+ * Return a pointer to the byte at absolute offset `pos`, or NULL if fewer
+ * than `sz` bytes are left from there. Does not move the read position.
+ */
+const uint8_t *input_mmap_at(input_mmap *m, size_t pos, size_t sz);
+
+/**
+ * Move the read position of `m` to the current position of `fin`.
+ */
+int input_mmap_sync_from_file(input_mmap *m, FILE *fin);
+
+/**
+ * Move the position of `fin` to the read position of `m`.
+ */
+int input_mmap_sync_to_file(input_mmap *m, FILE *fin);
+
+/**
+ * Return 1 if `fin` is (still) the file mapped by `m`, 0 otherwise.
+ */
+int input_mmap_matches(input_mmap *m, FILE *fin);
+
+void input_mmap_close(input_mmap *m);
+
+#endif /* __VMAF_TOOLS_INPUT_MMAP_H__ */
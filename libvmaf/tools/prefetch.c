@@ -0,0 +1,142 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prefetch.h"
+
+struct PrefetchReader {
+    video_input *vid;
+    prefetch_fetch_func fetch;
+    struct {
+        VmafPicture pic;
+        int ret;
+    } *slot;
+    unsigned depth, head, cnt;
+    bool stop;
+    bool done; // end of input or error was handed to the consumer
+    int done_ret;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+    pthread_t thread;
+};
+
+static void *prefetch_thread(void *arg)
+{
+    PrefetchReader *r = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&r->lock);
+        while (r->cnt == r->depth && !r->stop)
+            pthread_cond_wait(&r->not_full, &r->lock);
+        const bool stop = r->stop;
+        pthread_mutex_unlock(&r->lock);
+        if (stop) break;
+
+        VmafPicture pic;
+        const int ret = r->fetch(r->vid, &pic);
+
+        pthread_mutex_lock(&r->lock);
+        if (r->stop) {
+            pthread_mutex_unlock(&r->lock);
+            if (!ret) vmaf_picture_unref(&pic);
+            break;
+        }
+        const unsigned tail = (r->head + r->cnt) % r->depth;
+        r->slot[tail].ret = ret;
+        if (!ret) r->slot[tail].pic = pic;
+        r->cnt++;
+        pthread_cond_signal(&r->not_empty);
+        pthread_mutex_unlock(&r->lock);
+
+        if (ret) break;
+    }
+
+    return NULL;
+}
+
+int prefetch_reader_open(PrefetchReader **reader, video_input *vid,
+                         prefetch_fetch_func fetch, unsigned depth)
+{
+    if (!reader) return -EINVAL;
+    if (!vid) return -EINVAL;
+    if (!fetch) return -EINVAL;
+    if (!depth) return -EINVAL;
+
+    PrefetchReader *const r = *reader = malloc(sizeof(*r));
+    if (!r) goto fail;
+    memset(r, 0, sizeof(*r));
+    r->vid = vid;
+    r->fetch = fetch;
+    r->depth = depth;
+    r->slot = malloc(sizeof(*(r->slot)) * depth);
+    if (!r->slot) goto free_r;
+    memset(r->slot, 0, sizeof(*(r->slot)) * depth);
+
+    pthread_mutex_init(&(r->lock), NULL);
+    pthread_cond_init(&(r->not_empty), NULL);
+    pthread_cond_init(&(r->not_full), NULL);
+    if (pthread_create(&(r->thread), NULL, prefetch_thread, r))
+        goto free_sync;
+
+    return 0;
+
+free_sync:
+    pthread_cond_destroy(&(r->not_full));
+    pthread_cond_destroy(&(r->not_empty));
+    pthread_mutex_destroy(&(r->lock));
+    free(r->slot);
+free_r:
+    free(r);
+fail:
+    return -ENOMEM;
+}
+
+int prefetch_reader_fetch(PrefetchReader *reader, VmafPicture *pic)
+{
+    if (!reader) return -EINVAL;
+    if (!pic) return -EINVAL;
+
+    PrefetchReader *const r = reader;
+    if (r->done) return r->done_ret;
+
+    pthread_mutex_lock(&r->lock);
+    while (!r->cnt)
+        pthread_cond_wait(&r->not_empty, &r->lock);
+    const int ret = r->slot[r->head].ret;
+    if (!ret) *pic = r->slot[r->head].pic;
+    r->head = (r->head + 1) % r->depth;
+    r->cnt--;
+    pthread_cond_signal(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+
+    if (ret) {
+        r->done = true;
+        r->done_ret = ret;
+    }
+    return ret;
+}
+
+void prefetch_reader_close(PrefetchReader *reader)
+{
+    if (!reader) return;
+
+    PrefetchReader *const r = reader;
+    pthread_mutex_lock(&r->lock);
+    r->stop = true;
+    pthread_cond_signal(&r->not_full);
+    pthread_mutex_unlock(&r->lock);
+    pthread_join(r->thread, NULL);
+
+    for (; r->cnt; r->cnt--, r->head = (r->head + 1) % r->depth) {
+        if (!r->slot[r->head].ret)
+            vmaf_picture_unref(&(r->slot[r->head].pic));
+    }
+
+    pthread_cond_destroy(&(r->not_full));
+    pthread_cond_destroy(&(r->not_empty));
+    pthread_mutex_destroy(&(r->lock));
+    free(r->slot);
+    free(r);
+}
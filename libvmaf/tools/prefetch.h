@@ -0,0 +1,34 @@
+#ifndef __VMAF_TOOLS_PREFETCH_H__
+#define __VMAF_TOOLS_PREFETCH_H__
+
+#include "vidinput.h"
+
+#include "libvmaf/picture.h"
+
+/*
+ * Reads pictures from a video_input on a dedicated thread, up to `depth`
+ * pictures ahead of the consumer, so that I/O overlaps with scoring.
+ */
+typedef struct PrefetchReader PrefetchReader;
+
+/*
+ * Reads the next picture from `vid` into `pic`.
+ * Returns 0 on success, 1 at end of input, < 0 on error.
+ */
+typedef int (*prefetch_fetch_func)(video_input *vid, VmafPicture *pic);
+
+int prefetch_reader_open(PrefetchReader **reader, video_input *vid,
+                         prefetch_fetch_func fetch, unsigned depth);
+
+/*
+ * Same contract as `prefetch_fetch_func`, once end of input or an error is
+ * reached, every further call returns the same value.
+ */
+int prefetch_reader_fetch(PrefetchReader *reader, VmafPicture *pic);
+
+/*
+ * Stops the reader thread and unrefs pictures which were never fetched.
+ */
+void prefetch_reader_close(PrefetchReader *reader);
+
+#endif /* __VMAF_TOOLS_PREFETCH_H__ */
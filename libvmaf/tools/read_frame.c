@@ -16,14 +16,148 @@
  *
  */
 
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200112L
+
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include "file_io.h"
+#include "input_mmap.h"
 #include "read_frame.h"
 
+#if defined(_WIN32)
+#define fseeko _fseeki64
+#endif
+
+/**
+ * Regular input files are mmap()'d: luma is converted straight from the
+ * mapping and chroma is skipped without being read. The FILE position is
+ * kept in sync, so callers may still fseek() (see read_noref_frame()).
+ */
+#define MAX_MAPPED_INPUTS 4
+
+static struct
+{
+    FILE *rfile;
+    input_mmap map;
+} mapped_inputs[MAX_MAPPED_INPUTS];
+
+static input_mmap *map_input(FILE *rfile)
+{
+    int i, free_slot = -1;
+
+    for (i = 0; i < MAX_MAPPED_INPUTS; ++i)
+    {
+        if (mapped_inputs[i].rfile == rfile)
+        {
+            if (input_mmap_matches(&mapped_inputs[i].map, rfile))
+            {
+                return &mapped_inputs[i].map;
+            }
+            // stale: the FILE was closed and its address reused
+            input_mmap_close(&mapped_inputs[i].map);
+            mapped_inputs[i].rfile = NULL;
+        }
+        if (!mapped_inputs[i].rfile && free_slot < 0)
+        {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot < 0 || input_mmap_open(&mapped_inputs[free_slot].map, rfile))
+    {
+        return NULL;
+    }
+    mapped_inputs[free_slot].rfile = rfile;
+    return &mapped_inputs[free_slot].map;
+}
+
+static void unmap_input(FILE *rfile)
+{
+    int i;
+
+    for (i = 0; i < MAX_MAPPED_INPUTS; ++i)
+    {
+        if (mapped_inputs[i].rfile == rfile)
+        {
+            input_mmap_close(&mapped_inputs[i].map);
+            mapped_inputs[i].rfile = NULL;
+        }
+    }
+}
+
+/**
+ * Bytes per sample, 0 for unknown formats.
+ */
+static int get_elem_size(const char *fmt)
+{
+    if (!strcmp(fmt, "yuv420p") || !strcmp(fmt, "yuv422p") || !strcmp(fmt, "yuv444p"))
+    {
+        return 1;
+    }
+    if (!strcmp(fmt, "yuv420p10le") || !strcmp(fmt, "yuv422p10le") || !strcmp(fmt, "yuv444p10le"))
+    {
+        return 2;
+    }
+    return 0;
+}
+
+/**
+ * Convert the luma of the next frame straight from the mapping and skip
+ * (offset samples of) chroma. Returns 2 at end of file.
+ * Note: stride is in terms of bytes
+ */
+static int read_image_mapped(FILE *rfile, input_mmap *map, float *buf, int width, int height, int stride, int elem_size, size_t offset)
+{
+    char *byte_ptr = (char *)buf;
+    const unsigned char *y, *uv;
+    int i, j;
+
+    if (input_mmap_sync_from_file(map, rfile))
+    {
+        return 1;
+    }
+
+    y = input_mmap_read(map, (size_t)width * height * elem_size);
+    uv = y ? input_mmap_read(map, offset * elem_size) : NULL;
+    if (!y || !uv)
+    {
+        unmap_input(rfile);
+        return 2; // OK if end of file
+    }
+
+    for (i = 0; i < height; ++i)
+    {
+        float *row_ptr = (float *)byte_ptr;
+
+        if (elem_size == 1)
+        {
+            for (j = 0; j < width; ++j)
+            {
+                row_ptr[j] = y[j];
+            }
+        }
+        else
+        {
+            for (j = 0; j < width; ++j)
+            {
+                unsigned short w;
+                memcpy(&w, y + 2 * j, 2); // little-endian, may be unaligned
+                row_ptr[j] = w / 4.0; // '/4' to convert from 10 to 8-bit
+            }
+        }
+
+        y += (size_t)width * elem_size;
+        byte_ptr += stride;
+    }
+
+    return input_mmap_sync_to_file(map, rfile) ? 1 : 0;
+}
+
 /**
  * Note: stride is in terms of bytes
  */
@@ -154,6 +288,26 @@ int read_frame(float *ref_data, float *dis_data, float *temp_data, int stride_by
     int h = user_data->height;
     int ret;
 
+    int elem_size = get_elem_size(fmt);
+    input_mmap *ref_map = elem_size ? map_input(user_data->ref_rfile) : NULL;
+    input_mmap *dis_map = elem_size ? map_input(user_data->dis_rfile) : NULL;
+    if (ref_map && dis_map)
+    {
+        ret = read_image_mapped(user_data->ref_rfile, ref_map, ref_data, w, h, stride_byte, elem_size, user_data->offset);
+        if (ret)
+        {
+            return ret;
+        }
+        ret = read_image_mapped(user_data->dis_rfile, dis_map, dis_data, w, h, stride_byte, elem_size, user_data->offset);
+        if (ret)
+        {
+            return ret;
+        }
+
+        fprintf(stderr, "Frame: %d/%d\r", completed_frames++, user_data->num_frames);
+        return 0;
+    }
+
     // read ref y
     if (!strcmp(fmt, "yuv420p") || !strcmp(fmt, "yuv422p") || !strcmp(fmt, "yuv444p"))
     {
@@ -253,7 +407,7 @@ fail_or_end:
     return ret;
 }
 
-int read_noref_frame(float *dis_data, float *temp_data, int stride_byte, void *s, int offset)
+int read_noref_frame(float *dis_data, float *temp_data, int stride_byte, void *s, int64_t offset)
 {
     struct noref_data *user_data = (struct noref_data *)s;
     char *fmt = user_data->format;
@@ -264,8 +418,16 @@ int read_noref_frame(float *dis_data, float *temp_data, int stride_byte, void *s
     // if we have given a valid (non-negative) offset value, seek to that frame. This if statement
     // should only be entered from the second pass in motion.c for comparing motion between all frames.
     if (offset >= 0){
-        fseek(user_data->dis_rfile, offset, SEEK_SET);
+        fseeko(user_data->dis_rfile, offset, SEEK_SET);
     }
+
+    int elem_size = get_elem_size(fmt);
+    input_mmap *dis_map = elem_size ? map_input(user_data->dis_rfile) : NULL;
+    if (dis_map)
+    {
+        return read_image_mapped(user_data->dis_rfile, dis_map, dis_data, w, h, stride_byte, elem_size, user_data->offset);
+    }
+
     // read dis y
     if (!strcmp(fmt, "yuv420p") || !strcmp(fmt, "yuv422p") || !strcmp(fmt, "yuv444p"))
     {
@@ -19,6 +19,9 @@
 #ifndef READ_FRAME_H_
 #define READ_FRAME_H_
 
+#include <stdint.h>
+#include <stdio.h>
+
 struct data
 {
     char* format; /* yuv420p, yuv422p, yuv444p, yuv420p10le, yuv422p10le, yuv444p10le */
@@ -41,7 +44,7 @@ struct noref_data
 
 int read_frame(float *ref_data, float *dis_data, float *temp_data, int stride_byte, void *s);
 
-int read_noref_frame(float *dis_data, float *temp_data, int stride_byte, void *s, int offset);
+int read_noref_frame(float *dis_data, float *temp_data, int stride_byte, void *s, int64_t offset);
 
 int get_frame_offset(const char *fmt, int w, int h, size_t *offset);
 
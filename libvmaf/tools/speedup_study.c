@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libvmaf/libvmaf.rc.h"
+
+/*
+ * Measures the error of a faster scoring mode in the mean pooled score
+ * against the default one, and its speedup. $mode is one of
+ *   preview    VmafConfiguration.preview of 2 and 4
+ *   subsample  VmafConfiguration.adaptive_subsample of 4, 8 and 16
+ *
+ * Usage: speedup_study $mode $model $list
+ *
+ * Every line of $list is a pair of 8-bit yuv420p files:
+ *   $width $height $reference $distorted
+ */
+
+#define STUDY_MAX_PAIRS 4096
+
+#define STUDY_MAX_SETTINGS 4
+
+typedef struct {
+    const char *name;
+    unsigned setting[STUDY_MAX_SETTINGS];
+    unsigned cnt;
+} StudyMode;
+
+static const StudyMode study_mode[] = {
+    { "preview", { 0, 2, 4 }, 3 },
+    { "subsample", { 0, 4, 8, 16 }, 4 },
+};
+#define STUDY_MODE_CNT (sizeof(study_mode) / sizeof(study_mode[0]))
+
+static void configure(VmafConfiguration *cfg, const StudyMode *mode,
+                      unsigned setting)
+{
+    if (!strcmp(mode->name, "preview"))
+        cfg->preview = setting;
+    else
+        cfg->adaptive_subsample = setting;
+}
+
+static double seconds(struct timespec a, struct timespec b)
+{
+    return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) * 1e-9;
+}
+
+static int read_picture(FILE *in, VmafPicture *pic, unsigned w, unsigned h)
+{
+    int err = vmaf_picture_alloc(pic, VMAF_PIX_FMT_YUV420P, 8, w, h);
+    if (err) return err;
+
+    for (unsigned p = 0; p < 3; p++) {
+        unsigned char *data = pic->data[p];
+        for (unsigned i = 0; i < pic->h[p]; i++) {
+            if (fread(data, pic->w[p], 1, in) != 1) {
+                vmaf_picture_unref(pic);
+                return -EIO;
+            }
+            data += pic->stride[p];
+        }
+    }
+    return 0;
+}
+
+static int score(VmafModel *model, const StudyMode *mode, unsigned setting,
+                 unsigned w, unsigned h, const char *path_ref,
+                 const char *path_dist, double *vmaf_score, double *time)
+{
+    int err = -EINVAL;
+    FILE *ref = fopen(path_ref, "rb");
+    FILE *dist = fopen(path_dist, "rb");
+    if (!ref || !dist) goto close_files;
+
+    VmafConfiguration cfg = { 0 };
+    configure(&cfg, mode, setting);
+    VmafContext *vmaf;
+    err = vmaf_init(&vmaf, cfg);
+    if (err) goto close_files;
+    err = vmaf_use_features_from_model(vmaf, model);
+    if (err) goto close_vmaf;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned index = 0;
+    for (;; index++) {
+        VmafPicture pic_ref, pic_dist;
+        if (read_picture(ref, &pic_ref, w, h)) break;
+        if (read_picture(dist, &pic_dist, w, h)) {
+            vmaf_picture_unref(&pic_ref);
+            break;
+        }
+        err = vmaf_read_pictures(vmaf, &pic_ref, &pic_dist, index);
+        if (err) goto close_vmaf;
+    }
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    if (err) goto close_vmaf;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *time = seconds(start, end);
+
+    // pooling needs at least 2 pictures
+    if (index > 1)
+        err = vmaf_score_pooled(vmaf, model, VMAF_POOL_METHOD_MEAN, vmaf_score,
+                                0, index - 1);
+    else
+        err = index ? vmaf_score_at_index(vmaf, model, vmaf_score, 0) : -EINVAL;
+
+close_vmaf:
+    vmaf_close(vmaf);
+close_files:
+    if (ref) fclose(ref);
+    if (dist) fclose(dist);
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    const StudyMode *mode = NULL;
+    for (unsigned i = 0; argc == 4 && i < STUDY_MODE_CNT; i++) {
+        if (!strcmp(argv[1], study_mode[i].name))
+            mode = &study_mode[i];
+    }
+    if (!mode) {
+        fprintf(stderr, "Usage: %s preview|subsample $model $list\n", argv[0]);
+        return 1;
+    }
+
+    VmafModel *model;
+    if (vmaf_model_load_from_path(&model, argv[2])) {
+        fprintf(stderr, "problem loading model: %s\n", argv[2]);
+        return 1;
+    }
+    FILE *list = fopen(argv[3], "r");
+    if (!list) {
+        fprintf(stderr, "problem opening list: %s\n", argv[3]);
+        return 1;
+    }
+
+    static double vmaf_score[STUDY_MAX_PAIRS][STUDY_MAX_SETTINGS];
+    double time[STUDY_MAX_SETTINGS] = { 0 };
+    unsigned n = 0;
+    unsigned w, h;
+    char path_ref[1024], path_dist[1024];
+    while (n < STUDY_MAX_PAIRS &&
+           fscanf(list, "%u %u %1023s %1023s", &w, &h, path_ref,
+                  path_dist) == 4)
+    {
+        printf("%s %s", path_ref, path_dist);
+        for (unsigned i = 0; i < mode->cnt; i++) {
+            double t;
+            if (score(model, mode, mode->setting[i], w, h, path_ref, path_dist,
+                      &vmaf_score[n][i], &t))
+            {
+                fprintf(stderr, "\nproblem scoring: %s %s\n", path_ref,
+                        path_dist);
+                return 1;
+            }
+            time[i] += t;
+            printf(" %f", vmaf_score[n][i]);
+        }
+        printf("\n");
+        n++;
+    }
+    fclose(list);
+    if (!n) return 1;
+
+    printf("\n%9s  mean abs err  max abs err  pearson r  speedup\n",
+           mode->name);
+    for (unsigned i = 1; i < mode->cnt; i++) {
+        double err_sum = 0., err_max = 0.;
+        double sx = 0., sy = 0., sxx = 0., syy = 0., sxy = 0.;
+        for (unsigned j = 0; j < n; j++) {
+            const double x = vmaf_score[j][0], y = vmaf_score[j][i];
+            const double err = fabs(y - x);
+            err_sum += err;
+            if (err > err_max) err_max = err;
+            sx += x; sy += y; sxx += x * x; syy += y * y; sxy += x * y;
+        }
+        const double r = (n * sxy - sx * sy) /
+                         sqrt((n * sxx - sx * sx) * (n * syy - sy * sy));
+        printf("%9u  %12.3f  %11.3f  %9.4f  %6.2fx\n", mode->setting[i],
+               err_sum / n, err_max, r, time[0] / time[i]);
+    }
+
+    vmaf_model_destroy(model);
+    return 0;
+}
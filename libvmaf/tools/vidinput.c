@@ -22,6 +22,8 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#define _POSIX_C_SOURCE 200112L
+
 #include "vidinput.h"
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +42,7 @@ int raw_input_open(video_input *_vid,FILE *_fin,
     _vid->vtbl=&YUV_INPUT_VTBL;
     _vid->ctx=ctx;
     _vid->fin=_fin;
+    _vid->frame_index=0;
     return 0;
   }
   else fprintf(stderr,"Unknown file type.\n");
@@ -52,6 +55,7 @@ int video_input_open(video_input *_vid,FILE *_fin){
     _vid->vtbl=&Y4M_INPUT_VTBL;
     _vid->ctx=ctx;
     _vid->fin=_fin;
+    _vid->frame_index=0;
     return 0;
   }
   else fprintf(stderr,"Unknown file type.\n");
@@ -64,7 +68,26 @@ void video_input_get_info(video_input *_vid,video_input_info *_info){
 
 int video_input_fetch_frame(video_input *_vid,
  video_input_ycbcr _ycbcr,char _tag[5]){
-  return (*_vid->vtbl->fetch_frame)(_vid->ctx,_vid->fin,_ycbcr,_tag);
+  int ret;
+  ret=(*_vid->vtbl->fetch_frame)(_vid->ctx,_vid->fin,_ycbcr,_tag);
+  if(ret>0)_vid->frame_index++;
+  return ret;
+}
+
+int video_input_seek(video_input *_vid,uint64_t _frame_index){
+  if(_frame_index==_vid->frame_index)return 0;
+  if(video_input_ftell(_vid->fin)>=0){
+    if((*_vid->vtbl->seek)(_vid->ctx,_vid->fin,_frame_index)<0)return -1;
+    _vid->frame_index=_frame_index;
+    return 0;
+  }
+  /*Pipes can only move forward.*/
+  if(_frame_index<_vid->frame_index)return -1;
+  while(_vid->frame_index<_frame_index){
+    video_input_ycbcr ycbcr;
+    if(video_input_fetch_frame(_vid,ycbcr,NULL)<=0)return -1;
+  }
+  return 0;
 }
 
 void video_input_close(video_input *_vid){
@@ -36,6 +36,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 # include <stdio.h>
 # include <stdint.h>
 
+# if defined(_WIN32)
+#  define video_input_fseek _fseeki64
+#  define video_input_ftell _ftelli64
+# else
+#  define video_input_fseek fseeko
+#  define video_input_ftell ftello
+# endif
+
 # if defined(__cplusplus)
 extern "C" {
 # endif
@@ -56,6 +64,11 @@ typedef void (*video_input_get_info_func)(void *_ctx,video_input_info *_ti);
 typedef int (*video_input_fetch_frame_func)(void *_ctx,FILE *_fin,
  video_input_ycbcr _ycbcr,char _tag[5]);
 typedef void (*video_input_close_func)(void *_ctx);
+/*Position _fin at the start of frame _frame_index.
+  Only called for seekable inputs.
+  Return: 0 on success, or a negative value if the frame does not exist.*/
+typedef int (*video_input_seek_func)(void *_ctx,FILE *_fin,
+ uint64_t _frame_index);
 
 /**Pluggable method table for accessing different formats.*/
 struct video_input_vtbl{
@@ -63,12 +76,15 @@ struct video_input_vtbl{
   video_input_get_info_func     get_info;
   video_input_fetch_frame_func  fetch_frame;
   video_input_close_func        close;
+  video_input_seek_func         seek;
 };
 
 struct video_input{
   const video_input_vtbl *vtbl;
   void                   *ctx;
   FILE                   *fin;
+  /*Index of the next frame to be fetched.*/
+  uint64_t                frame_index;
 };
 
 typedef void* (*raw_input_open_func)(FILE *_fin,
@@ -85,6 +101,7 @@ typedef struct raw_input_vtbl {
   video_input_get_info_func     get_info;
   video_input_fetch_frame_func  fetch_frame;
   video_input_close_func        close;
+  video_input_seek_func         seek;
 } raw_input_vtbl;
 
 int video_input_open(video_input *_vid,FILE *_fin);
@@ -93,6 +110,11 @@ void video_input_close(video_input *_vid);
 void video_input_get_info(video_input *_vid,video_input_info *_ti);
 int video_input_fetch_frame(video_input *_vid,
  video_input_ycbcr _ycbcr,char _tag[5]);
+/*Position the input so that the next fetched frame is _frame_index.
+  Regular files are seeked directly (y4m frames are indexed on first use),
+   other inputs can only skip forward by reading and discarding frames.
+  Return: 0 on success, or -1 on error or if the frame does not exist.*/
+int video_input_seek(video_input *_vid,uint64_t _frame_index);
 
 typedef enum{
   /**Chroma decimation by 2 in both the X and Y directions (4:2:0).
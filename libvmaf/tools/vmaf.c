@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "cli_parse.h"
+#include "prefetch.h"
 #include "vidinput.h"
 
 #include "libvmaf/picture.h"
@@ -70,7 +71,8 @@ static int fetch_picture(video_input *vid, VmafPicture *pic)
     video_input_info info;
 
     ret = video_input_fetch_frame(vid, ycbcr, NULL);
-    if (ret < 1) return !ret;
+    if (ret < 0) return -1;
+    if (ret == 0) return 1;
 
     video_input_get_info(vid, &info);
     ret = vmaf_picture_alloc(pic, pix_fmt_map(info.pixel_fmt), info.depth,
@@ -163,6 +165,8 @@ int main(int argc, char *argv[])
         .log_level = VMAF_LOG_LEVEL_INFO,
         .n_threads = c.thread_cnt,
         .n_subsample = c.subsample,
+        .preview = c.preview,
+        .adaptive_subsample = c.adaptive_subsample,
     };
 
     VmafContext *vmaf;
@@ -198,17 +202,98 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (c.ref_cache_path) {
+        err = vmaf_use_reference_cache(vmaf, c.ref_cache_path);
+        if (err) {
+            fprintf(stderr, "problem using reference cache: %s\n",
+                    c.ref_cache_path);
+            return -1;
+        }
+    }
+
+    if (c.feature_cache_dir) {
+        err = vmaf_use_feature_cache(vmaf, c.feature_cache_dir);
+        if (err) {
+            fprintf(stderr, "problem using feature cache: %s\n",
+                    c.feature_cache_dir);
+            return -1;
+        }
+    }
+
+    // frames are written as soon as they are scored, bootstrap scores are
+    // only computed at the end and need the whole output written at once,
+    // as does the columnar binary format
+    const bool stream_output = !c.enable_conf_interval &&
+                               c.output_fmt != VMAF_OUTPUT_FORMAT_BINARY;
+    FILE *outfile = NULL;
+    if (c.output_path) {
+        outfile = fopen(c.output_path,
+                        c.output_fmt == VMAF_OUTPUT_FORMAT_BINARY ? "wb" : "w");
+        if (!outfile) {
+            fprintf(stderr, "could not open file: %s\n", c.output_path);
+            return -1;
+        }
+        if (stream_output) {
+            err = vmaf_register_output(vmaf, outfile, c.output_fmt,
+                                       c.model_cnt ? model[0] : NULL);
+            if (err) {
+                fprintf(stderr, "problem registering output file\n");
+                return -1;
+            }
+        }
+    }
+
+    // a shard reads one frame of context on either side of its frames,
+    // so that temporal features match those of an unsharded run
+    const unsigned context_before = c.partial_path && c.frame_start ? 1 : 0;
+    const unsigned context_after = c.partial_path && c.frame_cnt ? 1 : 0;
+    const unsigned frame_cnt =
+        c.frame_cnt ? context_before + c.frame_cnt + context_after : 0;
+
+    // pictures are indexed from 0 relative to the first frame read
+    const unsigned frame_start = c.frame_start - context_before;
+    if (frame_start) {
+        if (video_input_seek(&vid_ref, frame_start) ||
+            video_input_seek(&vid_dist, frame_start))
+        {
+            fprintf(stderr, "could not seek to frame %u\n", frame_start);
+            return -1;
+        }
+    }
+
+    // one reader thread per input, reading ahead while pictures are scored
+    PrefetchReader *reader_ref = NULL, *reader_dist = NULL;
+    if (c.prefetch) {
+        err  = prefetch_reader_open(&reader_ref, &vid_ref, fetch_picture,
+                                    c.prefetch);
+        err |= prefetch_reader_open(&reader_dist, &vid_dist, fetch_picture,
+                                    c.prefetch);
+        if (err) {
+            fprintf(stderr, "problem starting prefetch reader\n");
+            return -1;
+        }
+    }
+
     unsigned picture_index;
     for (picture_index = 0 ;; picture_index++) {
-        VmafPicture pic_ref, pic_dist;
-        int ret1 = fetch_picture(&vid_ref, &pic_ref);
-        int ret2 = fetch_picture(&vid_dist, &pic_dist);
-
-        if (ret1 && ret2) {
+        if (frame_cnt && picture_index == frame_cnt)
             break;
-        } else if (ret1 < 0 || ret2 < 0) {
-            fprintf(stderr, "problem while reading pictures\n",
-                    c.path_ref, c.path_dist);
+
+        VmafPicture pic_ref, pic_dist;
+        int ret1 = reader_ref ? prefetch_reader_fetch(reader_ref, &pic_ref) :
+                                fetch_picture(&vid_ref, &pic_ref);
+        int ret2 = reader_dist ? prefetch_reader_fetch(reader_dist, &pic_dist) :
+                                 fetch_picture(&vid_dist, &pic_dist);
+
+        // a read error is not the end of either stream
+        if (ret1 < 0 || ret2 < 0) {
+            fprintf(stderr, "\nproblem while reading pictures\n");
+            if (!ret1) vmaf_picture_unref(&pic_ref);
+            if (!ret2) vmaf_picture_unref(&pic_dist);
+            prefetch_reader_close(reader_ref);
+            prefetch_reader_close(reader_dist);
+            return -1;
+        } else if (ret1 && ret2) {
             break;
         } else if (ret1) {
             fprintf(stderr, "\"%s\" ended before \"%s\".\n",
@@ -228,26 +313,77 @@ int main(int argc, char *argv[])
         }
     }
     fprintf(stderr, "\n");
+    prefetch_reader_close(reader_ref);
+    prefetch_reader_close(reader_dist);
+
+    err = vmaf_read_pictures(vmaf, NULL, NULL, 0);
+    if (err) {
+        fprintf(stderr, "problem flushing context\n");
+        return -1;
+    }
+
+    // context frames are not scored
+    const unsigned index_low = context_before;
+    unsigned index_high = picture_index;
+    if (c.frame_cnt && index_high > index_low + c.frame_cnt)
+        index_high = index_low + c.frame_cnt;
+
+    if (c.partial_path) {
+        FILE *partial = fopen(c.partial_path, "w");
+        if (!partial) {
+            fprintf(stderr, "could not open file: %s\n", c.partial_path);
+            return -1;
+        }
+        err = vmaf_write_partial(vmaf, partial, index_low, index_high,
+                                 frame_start);
+        fclose(partial);
+        if (err) {
+            fprintf(stderr, "problem writing partial result\n");
+            return -1;
+        }
+    }
 
     for (unsigned i = 0; i < c.model_cnt; i++) {
         double vmaf_score;
         err = vmaf_score_pooled(vmaf, model[i], VMAF_POOL_METHOD_MEAN,
-                                &vmaf_score, 0, picture_index);
+                                &vmaf_score, index_low, index_high);
         if (err) {
             fprintf(stderr, "problem generating pooled VMAF score\n");
             return -1;
         }
 
         fprintf(stderr, "%s: %f\n", c.model_path[i], vmaf_score);
-    }
 
-    if (c.output_path) {
-        FILE *outfile = fopen(c.output_path, "w");
-        if (!outfile) {
-            fprintf(stderr, "could not open file: %s\n", c.output_path);
-            return -1;
+        if (!c.enable_conf_interval) continue;
+
+        VmafBootstrapScore sum = { 0 };
+        unsigned cnt = 0;
+        for (unsigned j = index_low; j < index_high; j++) {
+            if ((c.subsample > 1) && (j % c.subsample))
+                continue;
+            VmafBootstrapScore s;
+            err = vmaf_score_at_index_bootstrap(vmaf, model[i], &s, j);
+            if (err) {
+                fprintf(stderr, "problem generating bootstrap VMAF score, "
+                                "is %s a bootstrap model?\n", c.model_path[i]);
+                return -1;
+            }
+            sum.bagging_score += s.bagging_score;
+            sum.stddev += s.stddev;
+            sum.ci95.lo += s.ci95.lo;
+            sum.ci95.hi += s.ci95.hi;
+            cnt++;
         }
-        vmaf_write_output(vmaf, outfile, c.output_fmt);
+        if (!cnt) continue;
+
+        fprintf(stderr, "%s: bagging: %f, stddev: %f, ci95: [%f, %f]\n",
+                c.model_path[i], sum.bagging_score / cnt, sum.stddev / cnt,
+                sum.ci95.lo / cnt, sum.ci95.hi / cnt);
+    }
+
+    if (outfile) {
+        if (!stream_output)
+            vmaf_write_output(vmaf, outfile, c.output_fmt);
         fclose(outfile);
     }
 
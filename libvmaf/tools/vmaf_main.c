@@ -21,17 +21,19 @@
 #include <string.h>
 
 #include "read_frame.h"
+#include "motion_map.h"
+#include "cpu_info.h"
 
 int adm(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
 int ansnr(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
 int vif(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
 int vifdiff(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
-int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
+int motion(int (*read_noref_frame)(float *main_data, float *temp_data, int stride, void *user_data, int64_t offset), void *user_data, int w, int h, const char *fmt, MotionMapSink *map, int n_threads);
 int all(int (*read_frame)(float *ref_data, float *main_data, float *temp_data, int stride, void *user_data), void *user_data, int w, int h, const char *fmt);
 
 static void usage(void)
 {
-    puts("usage: vmaf app fmt ref dis w h\n"
+    puts("usage: vmaf app fmt ref dis w h [motion map options]\n"
          "apps:\n"
          "\tadm\n"
          "\tansnr\n"
@@ -45,17 +47,30 @@ static void usage(void)
          "\tyuv444p\n"
          "\tyuv420p10le\n"
          "\tyuv422p10le\n"
-         "\tyuv444p10le"
+         "\tyuv444p10le\n"
+         "motion options:\n"
+         "\t--threads n: threads for the loop search (default: all cores)\n"
+         "\t--motion-map path: write raw motion maps to a file or pipe\n"
+         "\t--motion-map-fmt float32|uint16: map sample format (default float32)\n"
+         "\t--motion-map-block n: average over n x n blocks (default 1)"
     );
 }
 
-int run_vmaf(const char *app, const char *fmt, const char *ref_path, const char *dis_path, int w, int h)
+typedef struct {
+    const char *path;
+    enum MotionMapFormat fmt;
+    int block;
+} MotionMapOptions;
+
+int run_vmaf(const char *app, const char *fmt, const char *ref_path, const char *dis_path, int w, int h, const MotionMapOptions *map_opts, int n_threads)
 {
     int ret = 0;
 
     if (!strcmp(app, "motion"))
     {
         struct noref_data *s;
+        MotionMapSink *map = NULL;
+        FILE *map_file = NULL;
         s = (struct noref_data *)malloc(sizeof(struct noref_data));
         s->format = fmt;
         s->width = w;
@@ -77,9 +92,34 @@ int run_vmaf(const char *app, const char *fmt, const char *ref_path, const char
             goto fail_or_end_noref;
         }
 
-        ret = motion(read_noref_frame, s, w, h, fmt);
+        if (map_opts->path)
+        {
+            if (!(map_file = fopen(map_opts->path, "wb")))
+            {
+                fprintf(stderr, "fopen motion map %s failed.\n", map_opts->path);
+                ret = 1;
+                goto fail_or_end_noref;
+            }
+            if (motion_map_sink_init(&map, map_file, map_opts->fmt, map_opts->block, w, h))
+            {
+                fprintf(stderr, "motion_map_sink_init failed.\n");
+                ret = 1;
+                goto fail_or_end_noref;
+            }
+        }
+
+        ret = motion(read_noref_frame, s, w, h, fmt, map, n_threads);
 
 fail_or_end_noref:
+        if (map && motion_map_sink_close(map))
+        {
+            fprintf(stderr, "error writing motion map %s.\n", map_opts->path);
+            ret = 1;
+        }
+        if (map_file)
+        {
+            fclose(map_file);
+        }
         if (s->dis_rfile)
         {
             fclose(s->dis_rfile);
@@ -174,5 +214,45 @@ int main(int argc, const char **argv)
         return 2;
     }
 
-    return run_vmaf(app, fmt, ref_path, dis_path, w, h);
+    MotionMapOptions map_opts = { .path = NULL, .fmt = MOTION_MAP_FMT_FLOAT32, .block = 1 };
+    int n_threads = 0;
+    for (int i = 7; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        if (!strcmp(argv[i], "--motion-map")) {
+            map_opts.path = argv[i + 1];
+        } else if (!strcmp(argv[i], "--motion-map-fmt")) {
+            if (!strcmp(argv[i + 1], "float32")) {
+                map_opts.fmt = MOTION_MAP_FMT_FLOAT32;
+            } else if (!strcmp(argv[i + 1], "uint16")) {
+                map_opts.fmt = MOTION_MAP_FMT_UINT16;
+            } else {
+                usage();
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--threads")) {
+            n_threads = atoi(argv[i + 1]);
+            if (n_threads < 0) {
+                usage();
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--motion-map-block")) {
+            map_opts.block = atoi(argv[i + 1]);
+            if (map_opts.block <= 0) {
+                usage();
+                return 2;
+            }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (n_threads == 0) {
+        n_threads = getNumCores();
+    }
+
+    return run_vmaf(app, fmt, ref_path, dis_path, w, h, &map_opts, n_threads);
 }
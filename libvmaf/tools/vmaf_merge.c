@@ -0,0 +1,156 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libvmaf/libvmaf.rc.h"
+
+#define MERGE_MAX_MODELS 256
+
+static const char short_opts[] = "m:o:v";
+
+static const struct option long_opts[] = {
+    { "model",            1, NULL, 'm' },
+    { "output",           1, NULL, 'o' },
+    { "version",          0, NULL, 'v' },
+    { NULL,               0, NULL, 0 },
+};
+
+static void usage(const char *const app, const char *const reason)
+{
+    if (reason)
+        fprintf(stderr, "%s\n\n", reason);
+    fprintf(stderr, "Usage: %s [options] $partial...\n\n", app);
+    fprintf(stderr, "Merge partial results written by `vmaf_rc --partial`.\n"
+            "The partial results must cover a whole video without gaps.\n\n"
+            "Supported options:\n"
+            " --model/-m $path:          path to model file\n"
+            " --output/-o $path:         path to output file (XML)\n"
+            " --version/-v:              print version and exit\n"
+           );
+    exit(1);
+}
+
+typedef struct {
+    unsigned index_low, index_high;
+    const char *path;
+} Shard;
+
+static int cmp_shard(const void *a, const void *b)
+{
+    const Shard *x = a, *y = b;
+    return (x->index_low > y->index_low) - (x->index_low < y->index_low);
+}
+
+int main(int argc, char *argv[])
+{
+    int err = 0;
+
+    char *model_path[MERGE_MAX_MODELS];
+    unsigned model_cnt = 0;
+    char *output_path = NULL;
+
+    int o;
+    while ((o = getopt_long(argc, argv, short_opts, long_opts, NULL)) >= 0) {
+        switch (o) {
+        case 'm':
+            if (model_cnt == MERGE_MAX_MODELS)
+                usage(argv[0], "Too many models");
+            model_path[model_cnt++] = optarg;
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        case 'v':
+            fprintf(stderr, "%s\n", vmaf_version());
+            return 0;
+        default:
+            usage(argv[0], NULL);
+        }
+    }
+    const unsigned shard_cnt = argc - optind;
+    if (!shard_cnt)
+        usage(argv[0], "At least one partial result is required");
+    if (!model_cnt && !output_path)
+        usage(argv[0], "Nothing to do, use -m/--model and/or -o/--output");
+
+    VmafConfiguration cfg = {
+        .log_level = VMAF_LOG_LEVEL_INFO,
+    };
+
+    VmafContext *vmaf;
+    err = vmaf_init(&vmaf, cfg);
+    if (err) {
+        fprintf(stderr, "problem initializing VMAF context\n");
+        return -1;
+    }
+
+    Shard shard[shard_cnt];
+    for (unsigned i = 0; i < shard_cnt; i++) {
+        shard[i].path = argv[optind + i];
+        FILE *partial = fopen(shard[i].path, "r");
+        if (!partial) {
+            fprintf(stderr, "could not open file: %s\n", shard[i].path);
+            return -1;
+        }
+        err = vmaf_read_partial(vmaf, partial, &shard[i].index_low,
+                                &shard[i].index_high);
+        fclose(partial);
+        if (err) {
+            fprintf(stderr, "problem reading partial result: %s\n",
+                    shard[i].path);
+            return -1;
+        }
+    }
+
+    // shards may be given in any order, but must tile the whole video
+    qsort(shard, shard_cnt, sizeof(*shard), cmp_shard);
+    unsigned index_high = 0;
+    for (unsigned i = 0; i < shard_cnt; i++) {
+        if (shard[i].index_low != index_high) {
+            fprintf(stderr, "partial results do not cover frames [%u, %u)\n",
+                    index_high, shard[i].index_low);
+            return -1;
+        }
+        index_high = shard[i].index_high;
+    }
+
+    for (unsigned i = 0; i < model_cnt; i++) {
+        VmafModel *model;
+        err = vmaf_model_load_from_path(&model, model_path[i]);
+        if (err) {
+            fprintf(stderr, "problem loading model file: %s\n",
+                    model_path[i]);
+            return -1;
+        }
+
+        double vmaf_score;
+        err = vmaf_score_pooled(vmaf, model, VMAF_POOL_METHOD_MEAN,
+                                &vmaf_score, 0, index_high);
+        if (err) {
+            fprintf(stderr, "problem generating pooled VMAF score, "
+                            "do the partial results provide the features "
+                            "required by %s?\n", model_path[i]);
+            return -1;
+        }
+        fprintf(stderr, "%s: %f\n", model_path[i], vmaf_score);
+        vmaf_model_destroy(model);
+    }
+
+    if (output_path) {
+        FILE *outfile = fopen(output_path, "w");
+        if (!outfile) {
+            fprintf(stderr, "could not open file: %s\n", output_path);
+            return -1;
+        }
+        err = vmaf_write_output(vmaf, outfile, VMAF_OUTPUT_FORMAT_XML);
+        fclose(outfile);
+        if (err) {
+            fprintf(stderr, "problem writing output file: %s\n", output_path);
+            return -1;
+        }
+    }
+
+    vmaf_close(vmaf);
+    return 0;
+}
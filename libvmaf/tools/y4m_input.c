@@ -22,6 +22,9 @@ CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
 OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
+#define _POSIX_C_SOURCE 200112L
+
+#include "input_mmap.h"
 #include "vidinput.h"
 #include <stdlib.h>
 #include <string.h>
@@ -73,6 +76,16 @@ struct y4m_input{
   y4m_convert_func  convert;
   unsigned char    *dst_buf;
   unsigned char    *aux_buf;
+  /*Mapped input, frames which need no conversion are read in place.*/
+  input_mmap        map;
+  /*The offset of the first FRAME header.*/
+  uint64_t          data_start;
+  /*The offsets of the FRAME headers indexed so far, built on demand when
+     seeking; index_end is the end of the last indexed frame.*/
+  uint64_t         *frame_offset;
+  size_t            nframe_offsets;
+  size_t            cframe_offsets;
+  uint64_t          index_end;
 };
 
 static int y4m_parse_tags(y4m_input *_y4m,char *_tags){
@@ -561,6 +574,9 @@ static int y4m_input_open_impl(y4m_input *_y4m,FILE *_fin){
   int  ret;
   int  i;
   int  xstride;
+  memset(&_y4m->map,0,sizeof(_y4m->map));
+  _y4m->frame_offset=NULL;
+  _y4m->nframe_offsets=_y4m->cframe_offsets=0;
   /*Read until newline, or 80 cols, whichever happens first.*/
   for(i=0;i<79;i++){
     ret=fread(buffer+i,1,1,_fin);
@@ -695,6 +711,11 @@ static int y4m_input_open_impl(y4m_input *_y4m,FILE *_fin){
      expect.*/
   _y4m->pic_x=(_y4m->frame_w-_y4m->pic_w)>>1&~1;
   _y4m->pic_y=(_y4m->frame_h-_y4m->pic_h)>>1&~1;
+  _y4m->data_start=OC_MAXI(video_input_ftell(_fin),0);
+  if(_y4m->convert==y4m_convert_null&&!input_mmap_open(&_y4m->map,_fin)){
+    _y4m->dst_buf=_y4m->aux_buf=NULL;
+    return 0;
+  }
   _y4m->dst_buf=(unsigned char *)malloc(_y4m->dst_buf_sz);
   _y4m->aux_buf=_y4m->aux_buf_sz?(unsigned char *)malloc(_y4m->aux_buf_sz):NULL;
   return 0;
@@ -730,9 +751,58 @@ static void y4m_input_get_info(y4m_input *_y4m,video_input_info *_info){
   _info->depth=_y4m->depth;
 }
 
+/*Return the size of the FRAME header at _offset, 0 at the end of the input,
+   or -1 on error.*/
+static int y4m_frame_header_size(y4m_input *_y4m,FILE *_fin,
+ uint64_t _offset){
+  unsigned char        buf[80];
+  const unsigned char *hdr;
+  const unsigned char *eol;
+  size_t               hdr_sz;
+  if(_y4m->map.data!=NULL){
+    if(_offset>=_y4m->map.size)return 0;
+    hdr_sz=OC_MINI(80,_y4m->map.size-_offset);
+    hdr=input_mmap_at(&_y4m->map,_offset,hdr_sz);
+  }
+  else{
+    if(video_input_fseek(_fin,_offset,SEEK_SET))return -1;
+    hdr_sz=fread(buf,1,sizeof(buf),_fin);
+    if(hdr_sz==0)return 0;
+    hdr=buf;
+  }
+  if(hdr_sz<6||memcmp(hdr,"FRAME",5)){
+    fprintf(stderr,"Loss of framing in YUV input data\n");
+    return -1;
+  }
+  eol=memchr(hdr+5,'\n',hdr_sz-5);
+  if(eol==NULL){
+    fprintf(stderr,"Error parsing YUV frame header\n");
+    return -1;
+  }
+  return eol+1-hdr;
+}
+
+/*Index the next frame in the mapped input: skip its FRAME header and return
+   a pointer to the frame data, or NULL at the end of the input or on error.*/
+static unsigned char *y4m_map_frame(y4m_input *_y4m){
+  const unsigned char *data;
+  int                  hdr_sz;
+  hdr_sz=y4m_frame_header_size(_y4m,NULL,_y4m->map.pos);
+  if(hdr_sz<=0)return NULL;
+  _y4m->map.pos+=hdr_sz;
+  data=input_mmap_read(&_y4m->map,_y4m->dst_buf_read_sz);
+  /*Data that needs no conversion but is discarded (i.e., alpha).*/
+  if(data==NULL||input_mmap_read(&_y4m->map,_y4m->aux_buf_read_sz)==NULL){
+    fprintf(stderr,"Error reading YUV frame data.\n");
+    return NULL;
+  }
+  return (unsigned char *)data;
+}
+
 static int y4m_input_fetch_frame(y4m_input *_y4m,FILE *_fin,
  video_input_ycbcr _ycbcr,char _tag[5]){
   char frame[6];
+  unsigned char *dst_buf;
   int  pic_sz;
   int  frame_c_w;
   int  frame_c_h;
@@ -748,6 +818,11 @@ static int y4m_input_fetch_frame(y4m_input *_y4m,FILE *_fin,
   c_w=(_y4m->pic_w+_y4m->dst_c_dec_h-1)/_y4m->dst_c_dec_h;
   c_h=(_y4m->pic_h+_y4m->dst_c_dec_v-1)/_y4m->dst_c_dec_v;
   c_sz=c_w*c_h*xstride;
+  if(_y4m->map.data!=NULL){
+    dst_buf=y4m_map_frame(_y4m);
+    if(dst_buf==NULL)return _y4m->map.pos==_y4m->map.size?0:-1;
+    goto views;
+  }
   /*Read and skip the frame header.*/
   ret=fread(frame,1,6,_fin);
   if(ret<6)return 0;
@@ -776,15 +851,17 @@ static int y4m_input_fetch_frame(y4m_input *_y4m,FILE *_fin,
   }
   /*Now convert the just read frame.*/
   (*_y4m->convert)(_y4m,_y4m->dst_buf,_y4m->aux_buf);
+  dst_buf=_y4m->dst_buf;
+views:
   /*Fill in the frame buffer pointers.*/
   _ycbcr[0].width=_y4m->frame_w;
   _ycbcr[0].height=_y4m->frame_h;
   _ycbcr[0].stride=_y4m->pic_w*xstride;
-  _ycbcr[0].data=_y4m->dst_buf-(_y4m->pic_x+_y4m->pic_y*_y4m->pic_w)*xstride;
+  _ycbcr[0].data=dst_buf-(_y4m->pic_x+_y4m->pic_y*_y4m->pic_w)*xstride;
   _ycbcr[1].width=frame_c_w;
   _ycbcr[1].height=frame_c_h;
   _ycbcr[1].stride=c_w*xstride;
-  _ycbcr[1].data=_y4m->dst_buf+pic_sz-((_y4m->pic_x/_y4m->dst_c_dec_h)+
+  _ycbcr[1].data=dst_buf+pic_sz-((_y4m->pic_x/_y4m->dst_c_dec_h)+
    (_y4m->pic_y/_y4m->dst_c_dec_v)*c_w)*xstride;
   _ycbcr[2].width=frame_c_w;
   _ycbcr[2].height=frame_c_h;
@@ -794,7 +871,46 @@ static int y4m_input_fetch_frame(y4m_input *_y4m,FILE *_fin,
   return 1;
 }
 
+/*Extend the frame index until it contains _frame_index.
+  Frames are located by parsing their headers only, the frame data is
+   skipped.*/
+static int y4m_index_frames(y4m_input *_y4m,FILE *_fin,uint64_t _frame_index){
+  while(_y4m->nframe_offsets<=_frame_index){
+    uint64_t offset;
+    int      hdr_sz;
+    offset=_y4m->nframe_offsets?_y4m->index_end:_y4m->data_start;
+    hdr_sz=y4m_frame_header_size(_y4m,_fin,offset);
+    if(hdr_sz<=0)return -1;
+    if(_y4m->nframe_offsets==_y4m->cframe_offsets){
+      size_t    cframe_offsets;
+      uint64_t *frame_offset;
+      cframe_offsets=_y4m->cframe_offsets?2*_y4m->cframe_offsets:1024;
+      frame_offset=(uint64_t *)realloc(_y4m->frame_offset,
+       cframe_offsets*sizeof(*frame_offset));
+      if(frame_offset==NULL)return -1;
+      _y4m->frame_offset=frame_offset;
+      _y4m->cframe_offsets=cframe_offsets;
+    }
+    _y4m->frame_offset[_y4m->nframe_offsets++]=offset;
+    _y4m->index_end=offset+hdr_sz+_y4m->dst_buf_read_sz+_y4m->aux_buf_read_sz;
+  }
+  return 0;
+}
+
+static int y4m_input_seek(y4m_input *_y4m,FILE *_fin,uint64_t _frame_index){
+  uint64_t offset;
+  if(y4m_index_frames(_y4m,_fin,_frame_index)<0)return -1;
+  offset=_y4m->frame_offset[_frame_index];
+  if(_y4m->map.data!=NULL){
+    _y4m->map.pos=offset;
+    return 0;
+  }
+  return video_input_fseek(_fin,offset,SEEK_SET);
+}
+
 static void y4m_input_close(y4m_input *_y4m){
+  input_mmap_close(&_y4m->map);
+  free(_y4m->frame_offset);
   free(_y4m->dst_buf);
   free(_y4m->aux_buf);
 }
@@ -803,5 +919,6 @@ OC_EXTERN const video_input_vtbl Y4M_INPUT_VTBL={
   (video_input_open_func)y4m_input_open,
   (video_input_get_info_func)y4m_input_get_info,
   (video_input_fetch_frame_func)y4m_input_fetch_frame,
-  (video_input_close_func)y4m_input_close
+  (video_input_close_func)y4m_input_close,
+  (video_input_seek_func)y4m_input_seek
 };
@@ -1,7 +1,10 @@
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "input_mmap.h"
 #include "vidinput.h"
 
 #include <libvmaf/libvmaf.rc.h>
@@ -23,6 +26,8 @@ typedef struct yuv_input {
     uint8_t *dst_buf;
     int src_c_dec_v, src_c_dec_h;
     int dst_c_dec_h, dst_c_dec_v;
+    uint64_t data_start;
+    input_mmap map;
 } yuv_input;
 
 
@@ -63,6 +68,15 @@ static yuv_input *yuv_input_open(FILE *_fin,
         goto fail; 
     }
 
+    // regular files are read in place, frames are views into the mapping
+    yuv->dst_buf = NULL;
+    if (!input_mmap_open(&yuv->map, _fin)) {
+        yuv->data_start = yuv->map.pos;
+        return yuv;
+    }
+    const int64_t pos = video_input_ftell(_fin);
+    yuv->data_start = pos > 0 ? pos : 0;
+
     yuv->dst_buf = malloc(yuv->dst_buf_sz);
     if (!yuv->dst_buf) {
         fprintf(stderr, "Could not allocate yuv reader buffer.\n");
@@ -102,13 +116,25 @@ static void yuv_input_get_info(yuv_input *_yuv, video_input_info *_info)
 static int yuv_input_fetch_frame(yuv_input *yuv, FILE *fin,
                                  video_input_ycbcr _ycbcr, char _tag[5])
 {
-    size_t bytes_read = fread(yuv->dst_buf, 1, yuv->dst_buf_sz, fin); 
-    if (bytes_read == 0) return 0;
-    if (bytes_read != yuv->dst_buf_sz) {
-        fprintf(stderr, "Error reading YUV frame data.\n");
-        return -1;
+    const uint8_t *buf;
+    if (yuv->map.data) {
+        buf = input_mmap_read(&yuv->map, yuv->dst_buf_sz);
+        if (!buf && yuv->map.pos == yuv->map.size) return 0;
+        if (!buf) {
+            fprintf(stderr, "Error reading YUV frame data.\n");
+            return -1;
+        }
+    } else {
+        size_t bytes_read = fread(yuv->dst_buf, 1, yuv->dst_buf_sz, fin);
+        if (bytes_read == 0) return 0;
+        if (bytes_read != yuv->dst_buf_sz) {
+            fprintf(stderr, "Error reading YUV frame data.\n");
+            return -1;
+        }
+        buf = yuv->dst_buf;
     }
-    
+
+
     (void) _tag;
 
     unsigned xstride = (yuv->bitdepth>8)?2:1;
@@ -122,11 +148,11 @@ static int yuv_input_fetch_frame(yuv_input *yuv, FILE *fin,
     _ycbcr[0].width = yuv->width;
     _ycbcr[0].height = yuv->height;
     _ycbcr[0].stride = yuv->width*xstride;
-    _ycbcr[0].data = yuv->dst_buf;
+    _ycbcr[0].data = (uint8_t *) buf;
     _ycbcr[1].width = frame_c_w;
     _ycbcr[1].height = frame_c_h;
     _ycbcr[1].stride = c_w*xstride;
-    _ycbcr[1].data = yuv->dst_buf + pic_sz;
+    _ycbcr[1].data = (uint8_t *) buf + pic_sz;
     _ycbcr[2].width = frame_c_w;
     _ycbcr[2].height = frame_c_h;
     _ycbcr[2].stride = c_w*xstride;
@@ -135,7 +161,20 @@ static int yuv_input_fetch_frame(yuv_input *yuv, FILE *fin,
     return 1;
 }
 
+static int yuv_input_seek(yuv_input *yuv, FILE *fin, uint64_t frame_index)
+{
+    // frames have a fixed size, no index needed
+    const uint64_t offset = yuv->data_start + frame_index * yuv->dst_buf_sz;
+    if (yuv->map.data) {
+        if (offset > yuv->map.size) return -1;
+        yuv->map.pos = offset;
+        return 0;
+    }
+    return video_input_fseek(fin, offset, SEEK_SET);
+}
+
 static void yuv_input_close(yuv_input *_yuv){
+  input_mmap_close(&_yuv->map);
   free(_yuv->dst_buf);
 }
 
@@ -143,5 +182,6 @@ OC_EXTERN const raw_input_vtbl YUV_INPUT_VTBL={
   (raw_input_open_func)yuv_input_open,
   (video_input_get_info_func)yuv_input_get_info,
   (video_input_fetch_frame_func)yuv_input_fetch_frame,
-  (video_input_close_func)yuv_input_close
+  (video_input_close_func)yuv_input_close,
+  (video_input_seek_func)yuv_input_seek
 };
@@ -2,6 +2,7 @@ __copyright__ = "Copyright 2016-2018, Netflix, Inc."
 __license__ = "Apache, Version 2.0"
 
 import os
+import struct
 
 import numpy as np
 
@@ -151,3 +152,78 @@ class YuvReader(object):
 
         else:
             assert False
+
+
+class FeatureLogReader(object):
+    """
+    Reader for the columnar binary feature log written by
+    `vmafossexec --log-fmt bin` and `vmaf_rc --bin`. The per-frame scores of
+    every feature are one contiguous little-endian float64 array, exposed as
+    a read-only numpy.memmap without copying or parsing:
+
+    with FeatureLogReader(log_path) as log:
+        vmaf_scores = log['vmaf']
+        frame_nums = log.frame_nums
+    """
+
+    MAGIC = b'VMAFCOL\0'
+    VERSION = 1
+    NAME_SIZE = 64
+    HEADER = struct.Struct('<8sIIQQ')
+
+    def __init__(self, filepath):
+        self.filepath = filepath
+
+        with open(self.filepath, 'rb') as f:
+            header = f.read(self.HEADER.size)
+            assert len(header) == self.HEADER.size, \
+                'Truncated feature log: {}'.format(self.filepath)
+            magic, version, num_features, num_frms, data_offset = self.HEADER.unpack(header)
+            assert magic == self.MAGIC, \
+                'Not a feature log: {}'.format(self.filepath)
+            assert version == self.VERSION, \
+                'Unsupported feature log version: {}'.format(version)
+            names = f.read(num_features * self.NAME_SIZE)
+            assert len(names) == num_features * self.NAME_SIZE, \
+                'Truncated feature log: {}'.format(self.filepath)
+
+        self.feature_names = [
+            names[i * self.NAME_SIZE:(i + 1) * self.NAME_SIZE].split(b'\0', 1)[0].decode('ascii')
+            for i in range(num_features)]
+        self.num_frms = num_frms
+
+        expected_size = data_offset + 8 * num_frms * (num_features + 1)
+        assert os.path.getsize(self.filepath) >= expected_size, \
+            'Truncated feature log: {}'.format(self.filepath)
+
+        if num_frms > 0:
+            self.frame_nums = np.memmap(self.filepath, dtype='<u8', mode='r',
+                                        offset=data_offset, shape=(num_frms,))
+            self._scores = np.memmap(self.filepath, dtype='<f8', mode='r',
+                                     offset=data_offset + 8 * num_frms,
+                                     shape=(num_features, num_frms))
+        else:
+            self.frame_nums = np.zeros((0,), dtype='<u8')
+            self._scores = np.zeros((num_features, 0), dtype='<f8')
+
+        self._index = {name: i for i, name in enumerate(self.feature_names)}
+
+    def close(self):
+        # dropping the references unmaps the file once the caller's views go
+        self.frame_nums = None
+        self._scores = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def __contains__(self, feature_name):
+        return feature_name in self._index
+
+    def __getitem__(self, feature_name):
+        return self._scores[self._index[feature_name]]
+
+    def keys(self):
+        return list(self.feature_names)
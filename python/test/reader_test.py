@@ -1,12 +1,15 @@
 __copyright__ = "Copyright 2016-2019, Netflix, Inc."
 __license__ = "Apache, Version 2.0"
 
+import os
+import struct
+import tempfile
 import unittest
 
 import numpy as np
 
 from vmaf.config import VmafConfig
-from vmaf.tools.reader import YuvReader
+from vmaf.tools.reader import YuvReader, FeatureLogReader
 
 
 class YuvReaderTest(unittest.TestCase):
@@ -172,5 +175,47 @@ class YuvReaderTest10le(unittest.TestCase):
         self.assertAlmostEqual(np.mean(y_2ndmoments), 4798.659574041666, places=4)
 
 
+class FeatureLogReaderTest(unittest.TestCase):
+
+    def setUp(self):
+        fd, self.filepath = tempfile.mkstemp(suffix='.bin')
+        os.close(fd)
+        names = ['adm2', 'vmaf']
+        frame_nums = np.array([0, 2, 4], dtype='<u8')
+        scores = np.array([[0.9, 0.95, np.nan],
+                           [80.5, 90.25, 99.0]], dtype='<f8')
+        data_offset = 192  # 32-byte header + 2 names, aligned to 64 bytes
+        with open(self.filepath, 'wb') as f:
+            f.write(struct.pack('<8sIIQQ', b'VMAFCOL\0', 1, len(names),
+                                len(frame_nums), data_offset))
+            for name in names:
+                f.write(name.encode('ascii').ljust(64, b'\0'))
+            f.write(b'\0' * (data_offset - f.tell()))
+            f.write(frame_nums.tobytes())
+            f.write(scores.tobytes())
+
+    def tearDown(self):
+        os.remove(self.filepath)
+
+    def test_feature_log_reader(self):
+        with FeatureLogReader(self.filepath) as log:
+            self.assertEqual(log.keys(), ['adm2', 'vmaf'])
+            self.assertEqual(log.num_frms, 3)
+            self.assertTrue('vmaf' in log)
+            self.assertFalse('psnr' in log)
+            self.assertEqual(list(log.frame_nums), [0, 2, 4])
+            self.assertTrue(isinstance(log['vmaf'], np.memmap))
+            self.assertEqual(list(log['vmaf']), [80.5, 90.25, 99.0])
+            self.assertAlmostEqual(log['adm2'][1], 0.95, places=15)
+            self.assertTrue(np.isnan(log['adm2'][2]))
+            self.assertAlmostEqual(float(np.nanmean(log['adm2'])), 0.925, places=15)
+
+    def test_feature_log_reader_bad_magic(self):
+        with open(self.filepath, 'r+b') as f:
+            f.write(b'VMAFXML\0')
+        with self.assertRaises(AssertionError):
+            FeatureLogReader(self.filepath)
+
+
 if __name__ == '__main__':
     unittest.main(verbosity=2)